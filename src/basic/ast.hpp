@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include "basic/symbol.hpp"
 #include "type.hpp"
 using mmmfloat = double;
 
@@ -124,7 +125,7 @@ struct Number : public Base {
   mmmfloat value{};
 };
 struct Symbol : public Base {
-  std::string value{};
+  SymbolId value{};
 };
 struct String : public Symbol {};
 
@@ -0,0 +1,19 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+#pragma once
+
+namespace mimium {
+// optimization level passed to execution engines and ahead-of-time compilation. Os optimizes for
+// code size.
+enum class OptimizeLevel { O0 = 0, O1, O2, O3, Os };
+// how a jit engine compiles the code.
+struct JitCompileOption {
+  // compile only the functions reachable from the requested symbol, on the first lookup of it.
+  bool lazy = false;
+  // threads of the pool where lazy jit compiles the functions. 0 compiles on the thread calling
+  // them. the eager jit always compiles on the thread looking up.
+  unsigned int num_threads = 0;
+};
+}  // namespace mimium
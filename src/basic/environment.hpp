@@ -3,40 +3,135 @@
  * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
 
 #pragma once
-#include <future>
-#include <memory>
-#include <unordered_map>
+#include <cassert>
+#include <cstdint>
+#include <limits>
+#include <optional>
 #include <utility>
+#include <vector>
 
 #include "basic/helper_functions.hpp"
+#include "basic/symbol.hpp"
 #include "basic/variant_visitor_helper.hpp"
 namespace mimium {
-struct RenameEnvironment : public std::enable_shared_from_this<RenameEnvironment> {
-  std::unordered_map<std::string, std::string> rename_map{};
-  std::shared_ptr<RenameEnvironment> parent_env = nullptr;
 
-  std::shared_ptr<RenameEnvironment> expand() {
-    auto newenv = std::make_shared<RenameEnvironment>();
-    newenv->parent_env = shared_from_this();
-    return newenv;
-  }
-  void addToMap(std::string const& namel, std::string const& namer) {
-    rename_map.emplace(namel, namer);
-  }
-  template <typename T>
-  std::optional<T> metaSearch(std::optional<std::string> const& name, std::future<T>&& ret_local,
-                              std::future<std::optional<T>>&& ret_freevar) {
-    if (name && rename_map.count(name.value()) > 0) { return ret_local.get(); }
-    if (name && parent_env != nullptr) { return ret_freevar.get(); }
-    return std::nullopt;
-  }
-#define THUNK(VAL) std::async(std::launch::deferred, [&]() { return VAL; })  // NOLINT
+// Scoped table of renamed symbols. Bindings of all the open scopes are kept in one vector in the
+// order of declaration, and an open addressing index maps a symbol to its innermost binding. Each
+// binding remembers the one it shadows, so that leaving a scope pops its bindings and restores
+// the outer ones without copying any table.
+class RenameEnvironment {
+ public:
+  RenameEnvironment() : slots(initial_capacity) {}
 
-  std::optional<std::string> search(std::optional<std::string> const& name) {
-    return metaSearch(name, THUNK(rename_map.at(name.value())), THUNK(parent_env->search(name)));
+  void enterScope() { scope_begins.emplace_back(bindings.size()); }
+  void exitScope() {
+    assert(!scope_begins.empty());
+    const auto begin = scope_begins.back();
+    scope_begins.pop_back();
+    while (bindings.size() > begin) {
+      auto& b = bindings.back();
+      if (b.shadowed != npos) {
+        findSlot(b.name)->binding = b.shadowed;
+      } else {
+        eraseSlot(b.name);
+      }
+      bindings.pop_back();
+    }
   }
-  std::optional<bool> isFreeVar(std::string const& name) {
-    return metaSearch(name, THUNK(false), THUNK(std::optional(true)));
+  // does nothing if the name is already bound in the current scope.
+  void addToMap(SymbolId namel, SymbolId namer) {
+    auto* slot = findSlot(namel);
+    if (slot != nullptr && slot->binding >= currentScopeBegin()) { return; }
+    const auto newbinding = static_cast<uint32_t>(bindings.size());
+    if (slot != nullptr) {
+      bindings.emplace_back(Binding{namel, namer, slot->binding});
+      slot->binding = newbinding;
+      return;
+    }
+    bindings.emplace_back(Binding{namel, namer, npos});
+    insertSlot(namel, newbinding);
+  }
+  [[nodiscard]] std::optional<SymbolId> search(SymbolId name) const {
+    const auto* slot = findSlot(name);
+    if (slot == nullptr) { return std::nullopt; }
+    return bindings[slot->binding].renamed;
+  }
+  // nullopt if the name is not bound, true if it is bound only in outer scopes.
+  [[nodiscard]] std::optional<bool> isFreeVar(SymbolId name) const {
+    const auto* slot = findSlot(name);
+    if (slot == nullptr) { return std::nullopt; }
+    return slot->binding < currentScopeBegin();
+  }
+
+ private:
+  static constexpr uint32_t npos = std::numeric_limits<uint32_t>::max();
+  static constexpr size_t initial_capacity = 64;  // must be a power of two
+  struct Binding {
+    SymbolId name;
+    SymbolId renamed;
+    uint32_t shadowed;  // index of the binding shadowed by this, or npos
+  };
+  struct Slot {
+    uint32_t key = 0;         // id of the symbol
+    uint32_t binding = npos;  // index of the innermost binding, or npos for an empty slot
+  };
+  std::vector<Binding> bindings;
+  std::vector<size_t> scope_begins;
+  std::vector<Slot> slots;
+  size_t num_used_slots = 0;
+
+  [[nodiscard]] size_t currentScopeBegin() const {
+    return scope_begins.empty() ? 0 : scope_begins.back();
+  }
+  [[nodiscard]] size_t home(uint32_t key) const {
+    // fibonacci hashing, spreads sequential ids of interned symbols.
+    return (static_cast<uint64_t>(key) * 0x9E3779B97F4A7C15ULL >> 32U) & (slots.size() - 1);
+  }
+  [[nodiscard]] size_t next(size_t i) const { return (i + 1) & (slots.size() - 1); }
+
+  Slot* findSlot(SymbolId name) {
+    return const_cast<Slot*>(std::as_const(*this).findSlot(name));  // NOLINT
+  }
+  [[nodiscard]] const Slot* findSlot(SymbolId name) const {
+    const auto key = name.getId();
+    for (auto i = home(key); slots[i].binding != npos; i = next(i)) {
+      if (slots[i].key == key) { return &slots[i]; }
+    }
+    return nullptr;
+  }
+  void insertSlot(SymbolId name, uint32_t binding) {
+    if ((num_used_slots + 1) * 2 > slots.size()) { grow(); }
+    auto i = home(name.getId());
+    while (slots[i].binding != npos) { i = next(i); }
+    slots[i] = Slot{name.getId(), binding};
+    num_used_slots++;
+  }
+  // backward shift deletion, which keeps probe sequences valid without tombstones.
+  void eraseSlot(SymbolId name) {
+    auto i = static_cast<size_t>(findSlot(name) - slots.data());
+    for (auto j = next(i); slots[j].binding != npos; j = next(j)) {
+      const auto h = home(slots[j].key);
+      // move slots[j] to the hole if its home is not in the cyclic range (i, j].
+      const bool in_range = (i <= j) ? (i < h && h <= j) : (i < h || h <= j);
+      if (!in_range) {
+        slots[i] = slots[j];
+        i = j;
+      }
+    }
+    slots[i] = Slot{};
+    num_used_slots--;
+  }
+  void grow() {
+    auto old = std::move(slots);
+    slots = std::vector<Slot>(old.size() * 2);
+    num_used_slots = 0;
+    for (auto& s : old) {
+      if (s.binding == npos) { continue; }
+      auto i = home(s.key);
+      while (slots[i].binding != npos) { i = next(i); }
+      slots[i] = s;
+      num_used_slots++;
+    }
   }
 };
-}  // namespace mimium
\ No newline at end of file
+}  // namespace mimium
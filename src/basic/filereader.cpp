@@ -14,6 +14,9 @@ const std::unordered_map<std::string_view, mimium::FileType> str_to_filetype = {
     {mimium::mmm_ext, mimium::FileType::MimiumSource},
     {mimium::ll_ext, mimium::FileType::LLVMIR},
     {mimium::bc_ext, mimium::FileType::LLVMIR},
+    {mimium::so_ext, mimium::FileType::SharedObject},
+    {mimium::dylib_ext, mimium::FileType::SharedObject},
+    {mimium::dll_ext, mimium::FileType::SharedObject},
 };
 };
 
@@ -25,7 +28,7 @@ std::pair<fs::path, FileType> getFilePath(std::string_view val) {
   fs::path res(val);
   auto type = getFileTypeByExt(res.extension().string());
   if (type == FileType::Invalid) {
-    throw std::runtime_error("Unknown file type. Expected either of .mmm, .ll or .bc");
+    throw std::runtime_error("Unknown file type. Expected either of .mmm, .ll, .bc or shared library");
   }
   return std::pair(res, type);
 }
@@ -43,6 +46,8 @@ Source FileReader::loadFile(std::string const& path) {
   }
 
   if (res.filetype == FileType::Invalid) { throw UnknownExtension(res.filepath.string()); }
+  // binary is loaded directly by the execution engine.
+  if (res.filetype == FileType::SharedObject) { return res; }
 
   auto ifs = std::make_unique<std::ifstream>();
   ifs->open(res.filepath.string());
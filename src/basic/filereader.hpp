@@ -11,12 +11,16 @@ namespace mimium {
 constexpr std::string_view mmm_ext = ".mmm";
 constexpr std::string_view ll_ext = ".ll";
 constexpr std::string_view bc_ext = ".bc";
+constexpr std::string_view so_ext = ".so";
+constexpr std::string_view dylib_ext = ".dylib";
+constexpr std::string_view dll_ext = ".dll";
 
 enum class FileType {
   Invalid = -1,
   MimiumSource = 0,
   MimiumMir,  // currently not used
   LLVMIR,
+  SharedObject,  // compiled ahead-of-time with --emit-so
 };
 struct MIMIUM_DLL_PUBLIC Source {
   fs::path filepath;
@@ -3,8 +3,10 @@
  * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
 
 #pragma once
+#include <cstdint>
 #include <list>
 #include <utility>
+#include <vector>
 
 #include "basic/ast.hpp"
 
@@ -17,7 +19,8 @@ static std::map<FCALLTYPE, std::string> fcalltype_str = {
 namespace mir {
 
 class block;
-using blockptr = std::shared_ptr<block>;
+// blocks and values are owned by ValuePool.
+using blockptr = block*;
 
 namespace instruction {
 
@@ -49,10 +52,30 @@ struct ExternalSymbol {
 struct Self;
 using Constants = std::variant<int, double, std::string>;
 
-using Value = std::variant<instruction::Instructions, Constants, ExternalSymbol,
-                           std::shared_ptr<Argument>, Self>;
+using Value = std::variant<instruction::Instructions, Constants, ExternalSymbol, Argument, Self>;
 
-using valueptr = std::shared_ptr<Value>;
+// reference to a value in ValuePool. it is as cheap to copy as a raw pointer, and the id given in
+// the order of creation can be used as a dense key or a deterministic order of values.
+class ValueRef {
+ public:
+  ValueRef() = default;
+  ValueRef(std::nullptr_t /*null*/) {}  // NOLINT
+  Value& operator*() const { return *ptr; }
+  Value* operator->() const { return ptr; }
+  [[nodiscard]] Value* get() const { return ptr; }
+  [[nodiscard]] uint32_t getId() const { return id; }
+  explicit operator bool() const { return ptr != nullptr; }
+  bool operator==(ValueRef const& rhs) const { return ptr == rhs.ptr; }
+  bool operator!=(ValueRef const& rhs) const { return ptr != rhs.ptr; }
+  bool operator<(ValueRef const& rhs) const { return id < rhs.id; }
+
+ private:
+  friend class ValuePool;
+  ValueRef(Value* ptr, uint32_t id) : ptr(ptr), id(id) {}
+  Value* ptr = nullptr;
+  uint32_t id = 0;
+};
+using valueptr = ValueRef;
 struct Self {
   valueptr fn;
   types::Value type;
@@ -65,9 +88,10 @@ struct Argument {
 
 std::string toString(Argument const& i);
 
+// arguments are values holding Argument.
 struct FnArgs {
-  std::optional<std::shared_ptr<Argument>> ret_ptr;
-  std::list<std::shared_ptr<Argument>> args;
+  std::optional<valueptr> ret_ptr;
+  std::vector<valueptr> args;
 };
 
 namespace instruction {
@@ -131,7 +155,7 @@ std::string toString(Function const& i);
 
 struct Fcall : public Base {
   valueptr fname;
-  std::list<valueptr> args;
+  std::vector<valueptr> args;
   FCALLTYPE ftype;
   std::optional<valueptr> time;
 };
@@ -187,7 +211,7 @@ inline std::string toString(Constants const& inst) {
 MIMIUM_DLL_PUBLIC inline std::string toString(Value const& inst) {
   return std::visit(overloaded{[](Instructions const& i) { return toString(i); },
                                [](Constants const& i) { return toString(i); },
-                               [](std::shared_ptr<Argument> i) { return toString(*i); },
+                               [](Argument const& i) { return toString(i); },
                                [](Self const& /*i*/) -> std::string { return "self"; },
                                [](auto const& i) { return i.name; }},
                     inst);
@@ -201,7 +225,7 @@ inline std::string getName(Argument const& i) { return toString(i); }
 inline std::string getName(Value const& val) {
   return std::visit(overloaded{[](Instructions const& i) { return getName(i); },
                                [](Constants const& i) { return toString(i); },
-                               [](std::shared_ptr<Argument> const& i) { return getName(*i); },
+                               [](Argument const& i) { return getName(i); },
                                [](Self const& /*i*/) -> std::string { return "self"; },
                                [](auto const& i) { return i.name; }},
                     val);
@@ -210,8 +234,7 @@ inline std::string getName(Value const& val) {
 template <typename T>
 inline std::string join(T const& vec, std::string const& delim) {
   using elemtype = std::decay_t<decltype(*vec.begin())>;
-  static_assert(std::is_same_v<elemtype, valueptr> ||
-                std::is_same_v<elemtype, std::shared_ptr<Argument>>);
+  static_assert(std::is_same_v<elemtype, valueptr>);
   std::string res;
   if (!vec.empty()) {
     res = std::accumulate(
@@ -221,29 +244,77 @@ inline std::string join(T const& vec, std::string const& delim) {
   return res;
 }
 
-class block : public std::enable_shared_from_this<block> {
+class block {
  public:
   std::optional<valueptr> parent = std::nullopt;
   std::string label;
-  std::list<valueptr> instructions;  // sequence of instructions
-  int indent_level = 0;              // shared between instances
+  std::vector<valueptr> instructions;  // sequence of instructions
+  int indent_level = 0;                // shared between instances
 };
 
-inline blockptr makeBlock(std::string const& label, int indent = 0) {
-  auto b = std::make_shared<block>();
-  b->label = label;
-  b->indent_level = indent;
-  return b;
-}
-
 MIMIUM_DLL_PUBLIC std::string toString(blockptr block);
 
-inline std::shared_ptr<mir::Value> addInstToBlock(Instructions&& inst, blockptr block) {
-  auto ptr = std::make_shared<Value>(std::move(inst));
-  std::visit([&](auto& i) mutable { i.parent = block; }, std::get<Instructions>(*ptr));
-  block->instructions.emplace_back(ptr);
-  return ptr;
-}
+// Owns all the values and blocks of mir for a compilation. They are constructed contiguously in
+// fixed size chunks and never move, so references to them are valid until the pool is destroyed.
+class ValuePool {
+ public:
+  valueptr make(Value&& v) {
+    auto id = static_cast<uint32_t>(num_values++);
+    return valueptr(&emplaceToChunk(values, std::move(v)), id);
+  }
+  blockptr makeBlock(std::string const& label, int indent = 0) {
+    auto& b = emplaceToChunk(blocks, block{});
+    b.label = label;
+    b.indent_level = indent;
+    return &b;
+  }
+  valueptr addInstToBlock(Instructions&& inst, blockptr block) {
+    auto ptr = make(std::move(inst));
+    std::visit([&](auto& i) mutable { i.parent = block; }, std::get<Instructions>(*ptr));
+    block->instructions.emplace_back(ptr);
+    return ptr;
+  }
+  // number of values created, which is also the next id.
+  [[nodiscard]] size_t size() const { return num_values; }
+
+ private:
+  static constexpr size_t chunk_size = 256;
+  std::vector<std::vector<Value>> values;
+  std::vector<std::vector<block>> blocks;
+  size_t num_values = 0;
+  template <class T>
+  static T& emplaceToChunk(std::vector<std::vector<T>>& chunks, T&& v) {
+    if (chunks.empty() || chunks.back().size() == chunk_size) {
+      chunks.emplace_back().reserve(chunk_size);
+    }
+    return chunks.back().emplace_back(std::move(v));
+  }
+};
+
+// map from values to T, stored in a vector indexed by the id of value. values not registered are
+// mapped to T{}.
+template <class T>
+class ValueMap {
+ public:
+  T& operator[](valueptr v) {
+    if (v.getId() >= data.size()) { data.resize(v.getId() + 1); }
+    return data[v.getId()];
+  }
+  // does nothing if the value is already registered, same as std::unordered_map.
+  bool emplace(valueptr v, T val) {
+    auto& slot = (*this)[v];
+    if (slot != T{}) { return false; }
+    slot = std::move(val);
+    return true;
+  }
+  [[nodiscard]] T lookup(valueptr v) const {
+    return v.getId() < data.size() ? data[v.getId()] : T{};
+  }
+  void clear() { data.clear(); }
+
+ private:
+  std::vector<T> data;
+};
 
 inline void addIndentToBlock(blockptr block, int level = 0) { block->indent_level += level; }
 
@@ -265,7 +336,6 @@ inline types::Value getType(Instructions const& v) {
 inline types::Value getType(Value const& v) {
   return std::visit(overloaded{[](Instructions const& i) { return getType(i); },
                                [](Constants const& i) { return getType(i); },
-                               [](std::shared_ptr<Argument> i) { return i->type; },
                                [](auto const& i) { return i.type; }},
                     v);
 }
@@ -284,4 +354,13 @@ bool isInstA(valueptr ptr) {
 }
 
 }  // namespace mir
-}  // namespace mimium
\ No newline at end of file
+}  // namespace mimium
+
+namespace std {
+template <>
+struct hash<mimium::mir::ValueRef> {
+  size_t operator()(mimium::mir::ValueRef const& v) const noexcept {
+    return hash<uint32_t>()(v.getId());
+  }
+};
+}  // namespace std
\ No newline at end of file
@@ -0,0 +1,152 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+#include "basic/pass_timer.hpp"
+#include <algorithm>
+#include <iomanip>
+#include <ostream>
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+namespace mimium {
+
+namespace {
+std::string escapeJson(std::string_view str) {
+  std::string res;
+  for (char c : str) {
+    switch (c) {
+      case '"': res += "\\\""; break;
+      case '\\': res += "\\\\"; break;
+      case '\n': res += "\\n"; break;
+      case '\t': res += "\\t"; break;
+      default:
+        if (static_cast<unsigned char>(c) < 0x20) { continue; }
+        res += c;
+    }
+  }
+  return res;
+}
+}  // namespace
+
+PassTimer::Scope::Scope(PassTimer* timer, std::string_view group, std::string_view name)
+    : timer(timer), group(group), name(name) {
+  if (timer == nullptr) { return; }
+  heap_start = getHeapUsage();
+  start = std::chrono::steady_clock::now();
+}
+
+PassTimer::Scope::~Scope() {
+  if (timer == nullptr) { return; }
+  std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+  timer->add(group, name, elapsed.count(), getHeapUsage() - heap_start, getPeakRss());
+}
+
+void PassTimer::add(std::string_view group, std::string_view name, double wall_ms,
+                    int64_t heap_bytes, uint64_t peak_rss_bytes) {
+  std::lock_guard<std::mutex> lock(mtx);
+  auto iter = std::find_if(entries.begin(), entries.end(), [&](Entry const& e) {
+    return e.group == group && e.name == name;
+  });
+  if (iter == entries.end()) {
+    iter = entries.insert(entries.end(), Entry{std::string(group), std::string(name)});
+  }
+  iter->wall_ms += wall_ms;
+  iter->heap_bytes += heap_bytes;
+  iter->peak_rss_bytes = std::max(iter->peak_rss_bytes, peak_rss_bytes);
+  iter->count++;
+}
+
+std::vector<PassTimer::Entry> PassTimer::getEntries() const {
+  std::lock_guard<std::mutex> lock(mtx);
+  return entries;
+}
+
+void PassTimer::print(std::ostream& out) const {
+  auto sorted = getEntries();
+  // keep the order of groups, sort entries in a group by time.
+  std::vector<std::string> groups;
+  for (auto& e : sorted) {
+    if (std::find(groups.cbegin(), groups.cend(), e.group) == groups.cend()) {
+      groups.push_back(e.group);
+    }
+  }
+  std::stable_sort(sorted.begin(), sorted.end(), [&](Entry const& a, Entry const& b) {
+    auto ga = std::find(groups.cbegin(), groups.cend(), a.group);
+    auto gb = std::find(groups.cbegin(), groups.cend(), b.group);
+    return ga != gb ? ga < gb : a.wall_ms > b.wall_ms;
+  });
+  const auto flags = out.flags();
+  const auto precision = out.precision();
+  out << "===== time passes =====\n";
+  out << std::fixed << std::setprecision(3);
+  std::string_view cur_group;
+  double total = 0;
+  for (auto& e : sorted) {
+    if (e.group != cur_group) {
+      if (!cur_group.empty()) { out << "  " << std::setw(10) << total << "  total\n"; }
+      cur_group = e.group;
+      total = 0;
+      out << cur_group << ":\n"
+          << "  " << std::setw(10) << "wall(ms)" << std::setw(12) << "heap(KB)" << std::setw(14)
+          << "peak rss(KB)" << std::setw(7) << "count"
+          << "  name\n";
+    }
+    total += e.wall_ms;
+    out << "  " << std::setw(10) << e.wall_ms;
+    if (e.peak_rss_bytes == 0) {  // memory is not measured
+      out << std::setw(12) << "-" << std::setw(14) << "-";
+    } else {
+      out << std::setw(12) << e.heap_bytes / 1024 << std::setw(14) << e.peak_rss_bytes / 1024;
+    }
+    out << std::setw(7) << e.count << "  " << e.name << "\n";
+  }
+  if (!cur_group.empty()) { out << "  " << std::setw(10) << total << "  total\n"; }
+  out.flags(flags);
+  out.precision(precision);
+  out.flush();
+}
+
+void PassTimer::printJson(std::ostream& out) const {
+  auto list = getEntries();
+  out << "{\"passes\":[";
+  for (size_t i = 0; i < list.size(); i++) {
+    auto& e = list[i];
+    out << (i == 0 ? "" : ",") << "\n  {\"group\":\"" << escapeJson(e.group) << "\",\"name\":\""
+        << escapeJson(e.name) << "\",\"wall_ms\":" << e.wall_ms
+        << ",\"heap_bytes\":" << e.heap_bytes << ",\"peak_rss_bytes\":" << e.peak_rss_bytes
+        << ",\"count\":" << e.count << "}";
+  }
+  out << "\n]}\n";
+  out.flush();
+}
+
+int64_t PassTimer::getHeapUsage() {
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || __GLIBC_MINOR__ >= 33)
+  // large blocks are allocated with mmap and not included in uordblks.
+  auto info = mallinfo2();
+  return static_cast<int64_t>(info.uordblks + info.hblkhd);
+#else
+  return 0;
+#endif
+}
+
+uint64_t PassTimer::getPeakRss() {
+#if defined(__unix__) || defined(__APPLE__)
+  rusage usage{};
+  if (getrusage(RUSAGE_SELF, &usage) != 0) { return 0; }
+#if defined(__APPLE__)
+  return static_cast<uint64_t>(usage.ru_maxrss);  // bytes on macOS
+#else
+  return static_cast<uint64_t>(usage.ru_maxrss) * 1024;  // KB on Linux
+#endif
+#else
+  return 0;
+#endif
+}
+
+}  // namespace mimium
@@ -0,0 +1,64 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <iosfwd>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "export.hpp"
+
+namespace mimium {
+
+// Collects wall time and memory usage of compiler stages and llvm passes for --time-passes.
+// Records with the same group and name(e.g. a llvm pass run for each function) are summed up.
+class MIMIUM_DLL_PUBLIC PassTimer {
+ public:
+  struct Entry {
+    std::string group;
+    std::string name;
+    double wall_ms = 0;
+    // growth of live heap memory by the pass. 0 where malloc statistics are not available.
+    int64_t heap_bytes = 0;
+    // peak resident set size of the process at the end of the pass. 0 if not measured.
+    uint64_t peak_rss_bytes = 0;
+    uint64_t count = 0;
+  };
+  // measures the lifetime of the scope. does nothing if timer is null.
+  class MIMIUM_DLL_PUBLIC Scope {
+   public:
+    Scope(PassTimer* timer, std::string_view group, std::string_view name);
+    ~Scope();
+    Scope(Scope const&) = delete;
+    Scope& operator=(Scope const&) = delete;
+
+   private:
+    PassTimer* timer;
+    std::string_view group;
+    std::string_view name;
+    std::chrono::steady_clock::time_point start;
+    int64_t heap_start = 0;
+  };
+  void add(std::string_view group, std::string_view name, double wall_ms, int64_t heap_bytes = 0,
+           uint64_t peak_rss_bytes = 0);
+  // entries in the order of first appearance.
+  [[nodiscard]] std::vector<Entry> getEntries() const;
+  // table for human, groups are printed in order and entries with longer time first.
+  void print(std::ostream& out) const;
+  // {"passes":[{"group":..., "name":..., "wall_ms":..., ...}, ...]}
+  void printJson(std::ostream& out) const;
+
+  // bytes of heap memory in use. 0 if not available on the platform.
+  static int64_t getHeapUsage();
+  static uint64_t getPeakRss();
+
+ private:
+  mutable std::mutex mtx;
+  std::vector<Entry> entries;
+};
+
+}  // namespace mimium
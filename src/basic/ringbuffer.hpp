@@ -0,0 +1,75 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+namespace mimium {
+
+// Bounded lock-free queue which accepts pushes from multiple threads and pops from one thread.
+// All the memory is allocated in constructor, so push/pop never allocate nor block.
+// (based on Dmitry Vyukov's bounded MPMC queue.)
+template <typename T>
+class MpscRingBuffer {
+ public:
+  explicit MpscRingBuffer(size_t capacity)
+      : cells(std::make_unique<Cell[]>(roundUpToPow2(capacity))),  // NOLINT
+        mask(roundUpToPow2(capacity) - 1) {
+    for (size_t i = 0; i <= mask; i++) { cells[i].seq.store(i, std::memory_order_relaxed); }
+  }
+  // returns false if the buffer is full.
+  bool tryPush(T const& v) {
+    auto pos = head.load(std::memory_order_relaxed);
+    Cell* cell = nullptr;
+    while (true) {
+      cell = &cells[pos & mask];
+      auto seq = cell->seq.load(std::memory_order_acquire);
+      auto diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos);
+      if (diff == 0) {
+        if (head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) { break; }
+      } else if (diff < 0) {
+        return false;
+      } else {
+        pos = head.load(std::memory_order_relaxed);
+      }
+    }
+    cell->data = v;
+    cell->seq.store(pos + 1, std::memory_order_release);
+    return true;
+  }
+  // must be called only from a single consumer thread. returns false if the buffer is empty.
+  bool tryPop(T& v) {
+    auto pos = tail.load(std::memory_order_relaxed);
+    Cell& cell = cells[pos & mask];
+    auto seq = cell.seq.load(std::memory_order_acquire);
+    if (static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos + 1) < 0) {
+      return false;
+    }
+    v = cell.data;
+    cell.seq.store(pos + mask + 1, std::memory_order_release);
+    tail.store(pos + 1, std::memory_order_relaxed);
+    return true;
+  }
+  [[nodiscard]] size_t capacity() const { return mask + 1; }
+
+ private:
+  struct Cell {
+    std::atomic<size_t> seq;
+    T data;
+  };
+  static size_t roundUpToPow2(size_t n) {
+    size_t res = 1;
+    while (res < n) { res <<= 1; }
+    return res;
+  }
+  static constexpr size_t cacheline = 64;
+  std::unique_ptr<Cell[]> cells;  // NOLINT
+  const size_t mask;
+  alignas(cacheline) std::atomic<size_t> head = 0;
+  alignas(cacheline) std::atomic<size_t> tail = 0;
+};
+
+}  // namespace mimium
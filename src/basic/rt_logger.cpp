@@ -0,0 +1,93 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+#include "basic/rt_logger.hpp"
+#include <iostream>
+#include <string>
+
+namespace mimium {
+
+namespace {
+thread_local bool is_realtime_thread = false;  // NOLINT
+thread_local RtLogger* thread_stdout = nullptr;  // NOLINT
+}  // namespace
+
+RtLogger::RtLogger(std::ostream& out, size_t capacity, std::chrono::milliseconds interval)
+    : out(out), records(capacity), interval(interval) {
+  thread = std::thread([this]() { loop(); });
+}
+
+RtLogger::~RtLogger() {
+  {
+    std::lock_guard<std::mutex> lock(mtx);
+    quit = true;
+  }
+  cv.notify_all();
+  thread.join();
+}
+
+bool RtLogger::push(Record const& r) {
+  if (records.tryPush(r)) { return true; }
+  if (is_realtime_thread) {
+    dropped.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+  while (!records.tryPush(r)) { std::this_thread::yield(); }
+  return true;
+}
+
+bool RtLogger::write(std::string_view str) {
+  bool res = true;
+  Record r;
+  while (!str.empty()) {
+    r.length = static_cast<uint32_t>(str.copy(r.text.data(), record_size));
+    str.remove_prefix(r.length);
+    res &= push(r);
+  }
+  return res;
+}
+
+void RtLogger::flush() {
+  std::lock_guard<std::mutex> lock(mtx);
+  drain();
+}
+
+void RtLogger::drain() {
+  Record r;
+  while (records.tryPop(r)) { out << std::string_view(r.text.data(), r.length); }
+  out.flush();
+  const auto cur_dropped = getDropped();
+  if (cur_dropped != reported_dropped) {
+    Logger::debug_log(std::to_string(cur_dropped - reported_dropped) +
+                          " log messages from the audio thread were dropped.",
+                      Logger::WARNING);
+    reported_dropped = cur_dropped;
+  }
+}
+
+void RtLogger::loop() {
+  std::unique_lock<std::mutex> lock(mtx);
+  while (true) {
+    drain();
+    if (quit) { return; }
+    cv.wait_for(lock, interval, [this]() { return quit; });
+  }
+}
+
+void RtLogger::setRealtimeThread(bool realtime) { is_realtime_thread = realtime; }
+bool RtLogger::isRealtimeThread() { return is_realtime_thread; }
+
+void RtLogger::setThreadStdout(RtLogger* logger) { thread_stdout = logger; }
+
+RtLogger& RtLogger::getStdout() {
+  if (thread_stdout != nullptr) { return *thread_stdout; }
+  return getDefaultStdout();
+}
+void RtLogger::initStdout() { getDefaultStdout(); }
+RtLogger& RtLogger::getDefaultStdout() {
+  static RtLogger instance(std::cout);
+  return instance;
+}
+
+}  // namespace mimium
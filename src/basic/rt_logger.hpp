@@ -0,0 +1,85 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+#pragma once
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <iosfwd>
+#include <mutex>
+#include <string_view>
+#include <thread>
+#include "basic/helper_functions.hpp"
+#include "basic/ringbuffer.hpp"
+#include "export.hpp"
+
+namespace mimium {
+
+// Logger which can be used from the audio thread. Messages are copied into fixed-size records
+// in a lock-free ring buffer and written to the stream by a background thread, so that logging
+// never allocates nor blocks on the real-time threads.
+// If the buffer is full, real-time threads drop the message(counted and reported later) while
+// other threads wait for the space to keep all the output.
+class MIMIUM_DLL_PUBLIC RtLogger {
+ public:
+  static constexpr size_t record_size = 120;  // bytes of text in a record
+  explicit RtLogger(std::ostream& out, size_t capacity = 4096,
+                    std::chrono::milliseconds interval = std::chrono::milliseconds(10));
+  // writes remaining records before returning.
+  ~RtLogger();
+  RtLogger(RtLogger const&) = delete;
+  RtLogger& operator=(RtLogger const&) = delete;
+
+  // write text as it is. text longer than record_size is split into multiple records.
+  bool write(std::string_view str);
+  // printf-style formatting on the stack. result longer than record_size is truncated.
+  template <typename... Args>
+  bool print(const char* fmt, Args... args) {
+    std::array<char, record_size + 1> buf{};
+    const int len = std::snprintf(buf.data(), buf.size(), fmt, args...);
+    if (len < 0) { return false; }
+    return write(std::string_view(buf.data(), std::min<size_t>(len, record_size)));
+  }
+  // write all the records pushed so far to the stream. must not be called from real-time threads.
+  void flush();
+  [[nodiscard]] uint64_t getDropped() const { return dropped.load(std::memory_order_relaxed); }
+
+  // threads marked as real-time never wait for the space of the buffer.
+  static void setRealtimeThread(bool realtime);
+  static bool isRealtimeThread();
+  // shared instance writing to std::cout, used by builtin functions like println().
+  static RtLogger& getStdout();
+  // constructs the shared instance ahead, so that the first print from the audio thread neither
+  // allocates nor starts the thread. called when a runtime is created.
+  static void initStdout();
+  // replaces getStdout() on the calling thread, null to restore. used to capture the output of
+  // sources run in parallel(e.g. regression tests).
+  static void setThreadStdout(RtLogger* logger);
+
+ private:
+  struct Record {
+    uint32_t length = 0;
+    std::array<char, record_size> text{};
+  };
+  std::ostream& out;
+  MpscRingBuffer<Record> records;
+  std::chrono::milliseconds interval;
+  std::atomic<uint64_t> dropped{0};
+  uint64_t reported_dropped = 0;
+  // held by the consumer side(background thread or flush()) to keep the ring buffer single
+  // consumer. producers never touch it.
+  std::mutex mtx;
+  std::condition_variable cv;
+  bool quit = false;
+  std::thread thread;
+  bool push(Record const& r);
+  void drain();
+  void loop();
+  static RtLogger& getDefaultStdout();
+};
+
+}  // namespace mimium
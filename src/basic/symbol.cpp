@@ -0,0 +1,50 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+#include "basic/symbol.hpp"
+#include <deque>
+#include <mutex>
+#include <unordered_map>
+
+namespace mimium {
+namespace {
+const std::string empty_str;
+
+struct SymbolTable {
+  std::mutex mtx;
+  // deque never moves its elements, so the keys of ids can view them.
+  std::deque<std::string> strings;
+  std::unordered_map<std::string_view, uint32_t> ids{{empty_str, 0}};
+};
+SymbolTable& getTable() {
+  static SymbolTable table;
+  return table;
+}
+}  // namespace
+
+SymbolId::SymbolId() : ptr(&empty_str), id(0) {}
+
+SymbolId::SymbolId(std::string_view str) : SymbolId() {
+  if (str.empty()) { return; }
+  auto& table = getTable();
+  std::lock_guard<std::mutex> lock(table.mtx);
+  auto iter = table.ids.find(str);
+  if (iter != table.ids.end()) {
+    id = iter->second;
+    ptr = &table.strings[id - 1];
+    return;
+  }
+  auto& newstr = table.strings.emplace_back(str);
+  id = static_cast<uint32_t>(table.strings.size());
+  ptr = &newstr;
+  table.ids.emplace(newstr, id);
+}
+
+size_t SymbolId::getTableSize() {
+  auto& table = getTable();
+  std::lock_guard<std::mutex> lock(table.mtx);
+  return table.strings.size() + 1;
+}
+
+}  // namespace mimium
@@ -0,0 +1,58 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include "export.hpp"
+
+namespace mimium {
+
+// Handle of a string interned in the global symbol table. Equal strings are interned to the same
+// handle, so comparison and hashing only look at the 32-bit id, and copying never allocates.
+// Interning locks the table and can be done from any thread. Interned strings are never freed.
+class MIMIUM_DLL_PUBLIC SymbolId {
+ public:
+  // empty string, which does not touch the table.
+  SymbolId();
+  SymbolId(std::string_view str);                                       // NOLINT
+  SymbolId(std::string const& str) : SymbolId(std::string_view(str)) {}  // NOLINT
+  SymbolId(const char* str) : SymbolId(std::string_view(str)) {}         // NOLINT
+
+  [[nodiscard]] std::string const& str() const { return *ptr; }
+  // lets interned names be passed where the rest of compiler still takes std::string.
+  operator std::string const&() const { return *ptr; }  // NOLINT
+  [[nodiscard]] uint32_t getId() const { return id; }
+  [[nodiscard]] bool empty() const { return ptr->empty(); }
+
+  friend bool operator==(SymbolId const& lhs, SymbolId const& rhs) { return lhs.id == rhs.id; }
+  friend bool operator!=(SymbolId const& lhs, SymbolId const& rhs) { return lhs.id != rhs.id; }
+  // order of interning, not lexicographical.
+  friend bool operator<(SymbolId const& lhs, SymbolId const& rhs) { return lhs.id < rhs.id; }
+  friend std::string operator+(std::string const& lhs, SymbolId const& rhs) { return lhs + *rhs.ptr; }
+  friend std::string operator+(SymbolId const& lhs, std::string const& rhs) { return *lhs.ptr + rhs; }
+  friend std::ostream& operator<<(std::ostream& os, SymbolId const& s) { return os << *s.ptr; }
+
+  // number of strings interned so far.
+  static size_t getTableSize();
+
+ private:
+  SymbolId(std::string const* ptr, uint32_t id) : ptr(ptr), id(id) {}
+  std::string const* ptr;
+  uint32_t id;
+};
+
+}  // namespace mimium
+
+namespace std {
+template <>
+struct hash<mimium::SymbolId> {
+  size_t operator()(mimium::SymbolId const& s) const noexcept {
+    return hash<uint32_t>()(s.getId());
+  }
+};
+}  // namespace std
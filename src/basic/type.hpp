@@ -16,6 +16,7 @@
 #include <variant>
 #include <vector>
 #include "basic/helper_functions.hpp"
+#include "basic/symbol.hpp"
 
 namespace mimium {
 
@@ -208,10 +209,24 @@ bool operator!=(T t1, T t2) {
   return !(t1 == t2);
 }
 
-constexpr size_t fixed_delaysize = 44100;
-inline auto getDelayStruct() {
-  return types::Alias{"MmmRingBuf", types::Tuple{{types::Float{}, types::Float{},
-                                                  types::Array{types::Float{}, fixed_delaysize}}}};
+// ring buffer size of delay used when the maximum delay time is unknown at compile time, which
+// allows delay time up to 32766 samples. longer delay needs delayn with the maximum time.
+// must be power of two because the ring buffer index wraps with bit mask, and kept below the
+// size of older versions(44100) not to increase the memory of such delays.
+constexpr size_t fixed_delaysize = 32768;
+static_assert((fixed_delaysize & (fixed_delaysize - 1)) == 0);
+// smallest power of two which can hold linear interpolation of the maximum delay time.
+inline size_t getDelaySize(double maxtime) {
+  size_t size = 2;
+  const auto required = static_cast<size_t>(std::max(maxtime, 0.0)) + 2;
+  while (size < required) { size <<= 1U; }
+  return size;
+}
+// the alias name contains size because aliases with the same name are identical.
+inline auto getDelayStruct(size_t size = fixed_delaysize) {
+  return types::Alias{"MmmRingBuf" + std::to_string(size),
+                      types::Tuple{{types::Float{}, types::Float{},
+                                    types::Array{types::Float{}, static_cast<int>(size)}}}};
 }
 
 struct ToStringVisitor {
@@ -322,13 +337,38 @@ class TypeEnvProto {
   std::unordered_map<keytype, types::Value> env;
   std::unordered_map<keytype, types::Value> alias_map;
   std::unordered_map<std::string, types::Value> builtin_map;
+  // type variables are grouped by union-find over their indices. tv_container of the root of a
+  // group holds the type bound to the group, or the TypeVar of the root itself if unbound.
   std::deque<types::Value> tv_container;
+  std::vector<int> tv_parent;
+  std::vector<int> tv_rank;
   std::shared_ptr<types::TypeVar> createNewTypeVar() {
     auto res = std::make_shared<types::TypeVar>(typeid_count++);
     tv_container.emplace_back(*res);
+    tv_parent.emplace_back(res->index);
+    tv_rank.emplace_back(0);
     return res;
   }
-  types::Value& findTypeVar(int tindex) { return tv_container[tindex]; }
+  // with path halving.
+  int findRoot(int tindex) {
+    while (tv_parent[tindex] != tindex) {
+      tv_parent[tindex] = tv_parent[tv_parent[tindex]];
+      tindex = tv_parent[tindex];
+    }
+    return tindex;
+  }
+  // merges the groups by rank and returns the new root. tv_container of the new root is not
+  // updated.
+  int uniteTypeVars(int i1, int i2) {
+    auto r1 = findRoot(i1);
+    auto r2 = findRoot(i2);
+    if (r1 == r2) { return r1; }
+    if (tv_rank[r1] < tv_rank[r2]) { std::swap(r1, r2); }
+    tv_parent[r2] = r1;
+    if (tv_rank[r1] == tv_rank[r2]) { tv_rank[r1]++; }
+    return r1;
+  }
+  types::Value& findTypeVar(int tindex) { return tv_container[findRoot(tindex)]; }
   [[nodiscard]] bool exist(keytype const& key) const { return (env.count(key) > 0); }
   auto begin() { return env.begin(); }
   auto end() { return env.end(); }
@@ -382,5 +422,5 @@ class TypeEnvProto {
 #endif
 };
 
-using TypeEnv = TypeEnvProto<std::string>;
+using TypeEnv = TypeEnvProto<SymbolId>;
 }  // namespace mimium
\ No newline at end of file
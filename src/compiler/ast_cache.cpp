@@ -0,0 +1,127 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+#include "compiler/ast_cache.hpp"
+#include <cctype>
+#include "basic/helper_functions.hpp"
+
+namespace mimium {
+namespace {
+bool isFunctionDefinition(std::string_view line) {
+  return line.size() > 2 && line.substr(0, 2) == "fn" &&
+         std::isblank(static_cast<unsigned char>(line[2])) != 0;
+}
+// lexical state at the end of a line, to find the lines at the top level of the source.
+struct ScanState {
+  bool in_comment = false;
+  // nesting of braces, 0 at the top level.
+  int depth = 0;
+};
+// strings can not contain newlines.
+void scanLine(std::string_view line, ScanState& state) {
+  for (size_t i = 0; i < line.size(); i++) {
+    auto rest = line.substr(i);
+    if (state.in_comment) {
+      if (rest.substr(0, 2) == "*/") {
+        state.in_comment = false;
+        i++;
+      }
+    } else if (rest.front() == '"') {
+      auto end = line.find('"', i + 1);
+      if (end == std::string_view::npos) { return; }
+      i = end;
+    } else if (rest.substr(0, 2) == "//") {
+      return;
+    } else if (rest.substr(0, 2) == "/*") {
+      state.in_comment = true;
+      i++;
+    } else if (rest.front() == '{') {
+      state.depth++;
+    } else if (rest.front() == '}') {
+      state.depth--;
+    }
+  }
+}
+}  // namespace
+
+std::vector<AstCache::Chunk> AstCache::splitTopLevel(std::string_view source) {
+  std::vector<Chunk> res;
+  size_t chunk_begin = 0;
+  int chunk_line = 1;
+  bool has_function = false;
+  ScanState state;
+  size_t pos = 0;
+  for (int line_num = 1; pos < source.size(); line_num++) {
+    auto end = source.find('\n', pos);
+    if (end == std::string_view::npos) { end = source.size(); }
+    auto line = source.substr(pos, end - pos);
+    // statements before the first function are put together with it.
+    if (!state.in_comment && state.depth == 0 && isFunctionDefinition(line)) {
+      if (has_function) {
+        res.emplace_back(Chunk{source.substr(chunk_begin, pos - chunk_begin), chunk_line});
+        chunk_begin = pos;
+        chunk_line = line_num;
+      }
+      has_function = true;
+    }
+    scanLine(line, state);
+    pos = end + 1;
+  }
+  if (chunk_begin < source.size()) {
+    res.emplace_back(Chunk{source.substr(chunk_begin), chunk_line});
+  }
+  return res;
+}
+
+AstPtr AstCache::parse(Driver& driver, std::string const& source) {
+  std::lock_guard<std::mutex> lock(mtx);
+  generation++;
+  last_stats = Stats{};
+  auto res = std::make_shared<ast::Statements>();
+  driver.setReportErrors(false);
+  try {
+    for (auto const& chunk : splitTopLevel(source)) {
+      auto ast = parseChunk(driver, chunk);
+      res->insert(res->end(), ast->cbegin(), ast->cend());
+    }
+  } catch (std::runtime_error& /*e*/) {
+    // the source is split inside of a definition, or has a syntax error reported by parsing
+    // the whole source.
+    driver.setReportErrors(true);
+    entries.clear();
+    last_stats = Stats{0, 0, true};
+    Logger::debug_log("Parsing the whole source as it can not be split into definitions.",
+                      Logger::INFO);
+    return driver.parseString(source);
+  }
+  driver.setReportErrors(true);
+  for (auto iter = entries.begin(); iter != entries.end();) {
+    iter = iter->second.generation == generation ? std::next(iter) : entries.erase(iter);
+  }
+  Logger::debug_log("Parsed " + std::to_string(last_stats.parsed) + " and reused " +
+                        std::to_string(last_stats.reused) + " top-level definitions.",
+                    Logger::INFO);
+  return res;
+}
+
+AstPtr AstCache::parseChunk(Driver& driver, Chunk const& chunk) {
+  auto key = std::hash<std::string_view>{}(chunk.text);
+  auto iter = entries.find(key);
+  if (iter != entries.end() && iter->second.text == chunk.text) {
+    iter->second.generation = generation;
+    last_stats.reused++;
+    return iter->second.ast;
+  }
+  auto ast = driver.parseString(std::string(chunk.text), chunk.first_line);
+  entries.insert_or_assign(key, Entry{std::string(chunk.text), ast, generation});
+  last_stats.parsed++;
+  return ast;
+}
+
+AstCache::Stats AstCache::getLastStats() const {
+  std::lock_guard<std::mutex> lock(mtx);
+  return last_stats;
+}
+
+}  // namespace mimium
@@ -0,0 +1,53 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+#pragma once
+#include <mutex>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "compiler/ast_loader.hpp"
+#include "export.hpp"
+
+namespace mimium {
+
+// Cache of parsed top-level definitions shared by successive compilations of a program, such as
+// the versions of a source compiled by live reload. The preprocessed source is split before each
+// line beginning a function definition at the top level, and a chunk is parsed again only if its
+// text was not in the last compilation, so that editing a function reparses only that function
+// while the definitions of included libraries are reused. If a chunk can not be parsed, the whole
+// source is parsed instead. Only parsing is cached: the whole ast is compiled every time.
+// Source locations in the ast of a reused chunk are the ones at the time it was parsed.
+class MIMIUM_DLL_PUBLIC AstCache {
+ public:
+  struct Chunk {
+    std::string_view text;
+    int first_line;
+  };
+  struct Stats {
+    size_t reused = 0;
+    size_t parsed = 0;
+    // true if the source was parsed as a whole without the cache.
+    bool whole = false;
+  };
+  AstPtr parse(Driver& driver, std::string const& source);
+  [[nodiscard]] Stats getLastStats() const;
+  static std::vector<Chunk> splitTopLevel(std::string_view source);
+
+ private:
+  struct Entry {
+    std::string text;
+    AstPtr ast;
+    uint64_t generation;
+  };
+  AstPtr parseChunk(Driver& driver, Chunk const& chunk);
+  mutable std::mutex mtx;
+  // hash of the text -> entry
+  std::unordered_map<size_t, Entry> entries;
+  // incremented for each compilation. entries not used in the last one are removed.
+  uint64_t generation = 0;
+  Stats last_stats;
+};
+
+}  // namespace mimium
@@ -9,7 +9,8 @@
 
 namespace mimium {
 Driver::Driver() : parser(nullptr), scanner(nullptr) {}
-AstPtr Driver::parse(std::istream& is) {
+AstPtr Driver::parse(std::istream& is, int first_line) {
+  this->first_line = first_line;
   scanner = std::make_unique<MimiumScanner>(is);
   parser = std::make_unique<MimiumParser>(*scanner, *this);
   parser->set_debug_level(DEBUG_LEVEL);  // debug
@@ -24,10 +25,10 @@ AstPtr Driver::parse(std::istream& is) {
   return ast_top;
 }
 
-AstPtr Driver::parseString(const std::string& source) {
+AstPtr Driver::parseString(const std::string& source, int first_line) {
   std::stringbuf buf(source);
   std::istream is(&buf);
-  return std::move(parse(is));
+  return std::move(parse(is, first_line));
 }
 AstPtr Driver::parseFile(const std::string& filename) {
   FileReader reader(fs::current_path());
@@ -25,15 +25,22 @@ using AstPtr = std::shared_ptr<ast::Statements>;
 class Driver {
  public:
  Driver ();
-  AstPtr parse(std::istream& is);
-  AstPtr parseString(const std::string& source);
+  // first_line is the line number of the beginning of the source, for a part of a file.
+  AstPtr parse(std::istream& is, int first_line = 1);
+  AstPtr parseString(const std::string& source, int first_line = 1);
   AstPtr parseFile(const std::string& filename);
   void setTopAst(AstPtr top);
+  [[nodiscard]] int getFirstLine() const { return first_line; }
+  // syntax errors are not logged while disabled, for a trial parse whose failure is handled.
+  void setReportErrors(bool report) { report_errors = report; }
+  [[nodiscard]] bool isReportingErrors() const { return report_errors; }
 
  private:
   AstPtr ast_top;
   std::unique_ptr<MimiumParser> parser;
   std::unique_ptr<MimiumScanner> scanner;
+  int first_line = 1;
+  bool report_errors = true;
 };
 
 }  // namespace mimium
\ No newline at end of file
@@ -5,8 +5,8 @@
 #include "compiler/closure_convert.hpp"
 
 namespace mimium {
-ClosureConverter::ClosureConverter(TypeEnv& typeenv)
-    : typeenv(typeenv), capturecount(0), closurecount(0) {}
+ClosureConverter::ClosureConverter(TypeEnv& typeenv, mir::ValuePool& pool)
+    : typeenv(typeenv), pool(pool), capturecount(0), closurecount(0) {}
 
 void ClosureConverter::reset() { capturecount = 0; }
 ClosureConverter::~ClosureConverter() = default;
@@ -15,42 +15,39 @@ bool ClosureConverter::isKnownFunction(mir::valueptr fn) {
   return known_functions.find(fn) != known_functions.end();
 }
 
-void ClosureConverter::moveFunToTop(mir::blockptr mir) {
-  auto& tinsts = toplevel->instructions;
-  std::list<decltype(mir->instructions)::iterator> inst_tobe_removed;
-  for (auto &&it = mir->instructions.begin(), end = mir->instructions.end(); it != end; ++it) {
-    mir::valueptr cinst = *it;
+void ClosureConverter::moveFunToTop(mir::blockptr mir, std::vector<mir::valueptr>& moved) {
+  auto& insts = mir->instructions;
+  for (auto& cinst : insts) {
     if (auto* f = std::get_if<minst::Function>(&std::get<mir::Instructions>(*cinst))) {
-      moveFunToTop(f->body);  // recursive call
-      if (this->toplevel != mir) {
-        tinsts.insert(tinsts.begin(), cinst);  // move on toplevel
-        inst_tobe_removed.emplace_back(it);
-      }
+      moveFunToTop(f->body, moved);  // recursive call
+      if (this->toplevel != mir) { moved.emplace_back(cinst); }
     }
   }
-  for (auto& it : inst_tobe_removed) { mir->instructions.erase(it); }
+  if (this->toplevel != mir) {
+    insts.erase(std::remove_if(insts.begin(), insts.end(),
+                               [](auto& i) { return mir::isInstA<minst::Function>(i); }),
+                insts.end());
+  }
 }
 
 mir::blockptr ClosureConverter::convert(mir::blockptr toplevel) {
   // convert top level
   this->toplevel = toplevel;
   auto& inss = toplevel->instructions;
-  auto pos = inss.begin();
-  std::vector<std::string> fvset;
-  std::vector<std::string> localvlist;
-  std::vector<std::string> funlist;
-
-  auto ccvis = CCVisitor(*this, pos);
+  auto ccvis = CCVisitor(*this);
 
   ccvis.block_ctx = toplevel;
-  for (auto it = inss.begin(), end = inss.end(); it != end; ++it) {
-    auto& cinst = *it;
-    ccvis.position = it;
+  // closures are inserted during the loop.
+  for (size_t i = 0; i < inss.size(); i++) {
+    mir::valueptr cinst = inss[i];
+    ccvis.position = i;
     ccvis.instance_holder = cinst;
     ccvis.visit(*cinst);
   }
-
-  moveFunToTop(this->toplevel);
+  // nested functions are put on the top in reverse order.
+  std::vector<mir::valueptr> moved;
+  moveFunToTop(this->toplevel, moved);
+  inss.insert(inss.begin(), moved.rbegin(), moved.rend());
   if (!(clstypeenv.count("dsp") > 0)) {
     types::Value dummycapture = types::Alias{makeCaptureName(), types::Tuple{{}}};
     clstypeenv.emplace("dsp", dummycapture);
@@ -72,14 +69,16 @@ void ClosureConverter::CCVisitor::checkFreeVar(const mir::valueptr val) {
   }
 }
 void ClosureConverter::CCVisitor::checkFreeVarArg(const mir::valueptr val) {
-  if (auto* iptr = std::get_if<std::shared_ptr<mir::Argument>>(val.get())) {
+  if (auto* iptr = std::get_if<mir::Argument>(val.get())) {
     mir::valueptr ctx = this->block_ctx->parent.value();
-    if ((*iptr)->parentfn != ctx) { fvset.emplace(val); }
+    if (iptr->parentfn != ctx) { fvset.emplace(val); }
   }
 }
 void ClosureConverter::CCVisitor::checkFreeVar(const mir::blockptr block) {
-  // mostly for visiting for if statement block
-  for (auto& inst : block->instructions) {
+  // mostly for visiting for if statement block. closures may be inserted during the loop.
+  auto& insts = block->instructions;
+  for (size_t idx = 0; idx < insts.size(); idx++) {
+    mir::valueptr inst = insts[idx];
     this->instance_holder = inst;
     std::visit(*this, std::get<mir::Instructions>(*inst));
   }
@@ -94,23 +93,22 @@ void ClosureConverter::CCVisitor::checkVariable(mir::valueptr& val, bool ismemor
   }
 }
 void ClosureConverter::CCVisitor::tryReplaceFntoCls(mir::valueptr& val) {
-  auto iter = cc.fn_to_cls.find(val);
-  if (iter != cc.fn_to_cls.end()) { val = cc.fn_to_cls[val]; }
+  if (auto cls = cc.fn_to_cls.lookup(val)) { val = cls; }
 }
 
 void ClosureConverter::CCVisitor::visitinsts(minst::Function& i, CCVisitor& ccvis) {
-  for (auto it = i.body->instructions.begin(), end = i.body->instructions.end(); it != end; ++it) {
-    ccvis.position = it;
-    mir::valueptr instance = *it;
+  auto& insts = i.body->instructions;
+  for (size_t idx = 0; idx < insts.size(); idx++) {
+    ccvis.position = idx;
+    mir::valueptr instance = insts[idx];
     ccvis.instance_holder = instance;
-    if (auto* i = std::get_if<mir::Instructions>(it->get())) { std::visit(ccvis, *i); }
+    if (auto* i = std::get_if<mir::Instructions>(instance.get())) { std::visit(ccvis, *i); }
     // std::visit(cc.typereplacer, child);
   }
 }
 
 void ClosureConverter::CCVisitor::operator()(minst::Function& i) {
-  auto pos = std::begin(i.body->instructions);
-  auto ccvis = CCVisitor(cc, pos);
+  auto ccvis = CCVisitor(cc);
   auto know_function_tmp = cc.known_functions;  // copy
   auto fn_ptr = getValPtr(&i);
   auto stored_fn_iter = cc.known_functions.insert(cc.known_functions.end(), fn_ptr);
@@ -147,9 +145,11 @@ void ClosureConverter::CCVisitor::operator()(minst::Function& i) {
 
   types::Function ftype = rv::get<types::Function>(i.type);
 
-  auto makecls = std::make_shared<mir::Value>(createClosureInst(fn_ptr, fvsetvec, fvtype, i.name));
+  auto makecls = cc.pool.make(createClosureInst(fn_ptr, fvsetvec, fvtype, i.name));
   cc.fn_to_cls.emplace(fn_ptr, makecls);
-  i.parent->instructions.insert(std::next(position), makecls);
+  auto& parentinsts = i.parent->instructions;
+  parentinsts.insert(std::next(parentinsts.begin(), static_cast<std::ptrdiff_t>(position) + 1),
+                     makecls);
 }
 minst::MakeClosure ClosureConverter::CCVisitor::createClosureInst(
     mir::valueptr fnptr, std::vector<mir::valueptr> const& fvs, types::Alias fvtype,
@@ -178,7 +178,7 @@ void ClosureConverter::CCVisitor::operator()(minst::Fcall& i) {
   if (i.time.has_value()) { checkVariable(i.time.value()); }
   for (auto& a : i.args) { checkVariable(a); }
   // currently higher order function is limited to direct call - no closure or memobj
-  const bool is_hof = std::holds_alternative<std::shared_ptr<mir::Argument>>(*i.fname);
+  const bool is_hof = std::holds_alternative<mir::Argument>(*i.fname);
   if (cc.isKnownFunction(i.fname) || is_hof) {
     i.ftype = DIRECT;
   } else {
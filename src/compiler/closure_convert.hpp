@@ -15,39 +15,41 @@ namespace minst = mir::instruction;
 
 class ClosureConverter {
  public:
-  explicit ClosureConverter(TypeEnv& typeenv);
+  ClosureConverter(TypeEnv& typeenv, mir::ValuePool& pool);
   ~ClosureConverter();
   mir::blockptr convert(mir::blockptr toplevel);
   void reset();
-  bool hasCapture(const std::string& fname) { return fvinfo.count(fname) > 0; }
+  bool hasCapture(SymbolId fname) { return fvinfo.count(fname) > 0; }
 
-  auto& getCaptureNames(const std::string& fname) { return fvinfo[fname]; }
-  auto& getCaptureType(const std::string& fname) { return clstypeenv[fname]; }
+  auto& getCaptureNames(SymbolId fname) { return fvinfo[fname]; }
+  auto& getCaptureType(SymbolId fname) { return clstypeenv[fname]; }
  private:
   TypeEnv& typeenv;
+  mir::ValuePool& pool;
   mir::blockptr toplevel;
   int capturecount;
   int closurecount;
   std::set<mir::valueptr> known_functions;
-  std::unordered_map<std::string, std::vector<std::string>> fvinfo;
+  std::unordered_map<SymbolId, std::vector<SymbolId>> fvinfo;
   // fname: types::Tuple(...)
-  std::unordered_map<std::string, types::Value> clstypeenv;
-  std::unordered_map<mir::valueptr, mir::valueptr> fn_to_cls;
+  std::unordered_map<SymbolId, types::Value> clstypeenv;
+  mir::ValueMap<mir::valueptr> fn_to_cls;
 
-  void moveFunToTop(mir::blockptr mir);
+  // collects functions nested in the block into moved, in the order to be put on the toplevel.
+  void moveFunToTop(mir::blockptr mir, std::vector<mir::valueptr>& moved);
   bool isKnownFunction(mir::valueptr fn);
   std::string makeCaptureName() { return "Capture." + std::to_string(capturecount++); }
   std::string makeClosureTypeName() { return "Closure." + std::to_string(closurecount++); }
 
   struct CCVisitor {
-    explicit CCVisitor(ClosureConverter& cc, std::list<mir::valueptr>::iterator& position)
-        : cc(cc) {}
+    explicit CCVisitor(ClosureConverter& cc) : cc(cc) {}
 
     ClosureConverter& cc;
     std::set<mir::valueptr> fvset;
     mir::blockptr block_ctx;
 
-    std::list<mir::valueptr>::iterator position;
+    // index of the visiting instruction in the block.
+    size_t position = 0;
 
     void checkFreeVar(mir::valueptr val);
     void checkFreeVar(mir::blockptr block);
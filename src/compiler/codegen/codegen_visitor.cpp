@@ -34,7 +34,7 @@ llvm::Value* CodeGenVisitor::visit(mir::valueptr val) {
       overloaded{
           [&](mir::Instructions& inst) { return std::visit(*this, inst); },
           [](mir::Constants& c) -> llvm::Value* { return nullptr; },                 // TODO
-          [](std::shared_ptr<mir::Argument> a) -> llvm::Value* { return nullptr; },  // TODO
+          [](mir::Argument& a) -> llvm::Value* { return nullptr; },                  // TODO
           [](mir::ExternalSymbol& a) -> llvm::Value* { return nullptr; },            // TODO
           [](mir::Self& a) -> llvm::Value* { return nullptr; },                      // TODO
 
@@ -45,16 +45,13 @@ llvm::Value* CodeGenVisitor::visit(mir::valueptr val) {
 void CodeGenVisitor::registerLlvmVal(mir::valueptr mirval, llvm::Value* llvmval) {
   mir_to_llvm.emplace(mirval, llvmval);
 }
-void CodeGenVisitor::registerLlvmVal(std::shared_ptr<mir::Argument> mirval, llvm::Value* llvmval) {
-  mirarg_to_llvm.emplace(mirval, llvmval);
-}
 void CodeGenVisitor::registerLlvmValforFreeVar(mir::valueptr mirval, llvm::Value* llvmval) {
   mirfv_to_llvm.emplace(mirval, llvmval);
 }
 llvm::Value* CodeGenVisitor::getConstant(const mir::Constants& val) {
   return std::visit(overloaded{
                         [&](int v) { return (llvm::Value*)G.getConstInt(v); },
-                        [&](double v) { return (llvm::Value*)G.getConstDouble(v); },
+                        [&](double v) { return (llvm::Value*)G.getConstFloat(v); },
                         // todo
                         [](const std::string& v) { return (llvm::Value*)nullptr; },
                     },
@@ -68,23 +65,21 @@ llvm::Value* CodeGenVisitor::getLlvmVal(mir::valueptr mirval) {
                    assert(false && "currently should be unreachable");
                    return (llvm::Value*)nullptr;
                  },
-                 [&](std::shared_ptr<mir::Argument> v) {
-                   auto iter = mirarg_to_llvm.find(v);
-                   if (iter != mirarg_to_llvm.end()) { return iter->second; }
+                 [&](mir::Argument& v) {
+                   if (auto* res = mir_to_llvm.lookup(mirval)) { return res; }
                    auto iterfv = mirfv_to_llvm.find(mirval);
                    if (iterfv != mirfv_to_llvm.cend()) { return iterfv->second; }
                    return (llvm::Value*)nullptr;
                  },
                  [&](mir::Instructions& v) {
-                   auto iter = mir_to_llvm.find(mirval);
-                   if (iter != mir_to_llvm.end()) {
-                     const bool isconst = llvm::isa<llvm::Constant>(iter->second);
-                     const bool isinst = llvm::isa<llvm::Instruction>(iter->second);
+                   if (auto* res = mir_to_llvm.lookup(mirval)) {
+                     const bool isconst = llvm::isa<llvm::Constant>(res);
+                     const bool isinst = llvm::isa<llvm::Instruction>(res);
                      const llvm::Instruction* inst = nullptr;
-                     if (isinst) { inst = llvm::cast<llvm::Instruction>(iter->second); }
+                     if (isinst) { inst = llvm::cast<llvm::Instruction>(res); }
                      auto* parentfn = G.builder->GetInsertBlock()->getParent();
                      bool is_on_samefunc = isinst && inst->getParent()->getParent() == parentfn;
-                     if (is_on_samefunc || isconst) { return iter->second; }
+                     if (is_on_samefunc || isconst) { return res; }
                    }
                    auto iterfv = mirfv_to_llvm.find(mirval);
                    if (iterfv != mirfv_to_llvm.end()) { return iterfv->second; }
@@ -120,7 +115,7 @@ llvm::Value* CodeGenVisitor::getLlvmValForFcallArgs(mir::valueptr mirval) {
 }
 
 std::vector<llvm::Value*> CodeGenVisitor::makeFcallArgs(llvm::Type* ft,
-                                                        std::list<mir::valueptr> const& args) {
+                                                        std::vector<mir::valueptr> const& args) {
   auto* functiontype = llvm::cast<llvm::FunctionType>(
       ft->isPointerTy() ? llvm::cast<llvm::PointerType>(ft)->getElementType() : ft);
   std::vector<llvm::Value*> res;
@@ -163,7 +158,7 @@ llvm::Value* CodeGenVisitor::createAllocation(bool isglobal, llvm::Type* type,
 }
 
 llvm::Value* CodeGenVisitor::operator()(minst::Number& i) {
-  return llvm::ConstantFP::get(G.ctx, llvm::APFloat(i.val));
+  return llvm::ConstantFP::get(G.getFloatTy(), i.val);
 }
 llvm::Value* CodeGenVisitor::operator()(minst::String& i) {
   auto* cstr = llvm::ConstantDataArray::getString(G.ctx, i.val);
@@ -310,12 +305,12 @@ void CodeGenVisitor::addArgstoMap(llvm::Function* f, minst::Function& i, bool ha
   // arguments are [actual arguments], capture , memobjs
   auto* arg = std::begin(f->args());
   if (auto a = i.args.ret_ptr) {
-    arg->setName(a.value()->name);
+    arg->setName(mir::getName(*a.value()));
     registerLlvmVal(a.value(), arg);
     std::advance(arg, 1);
   }
   for (auto& a : i.args.args) {
-    arg->setName(a->name);
+    arg->setName(mir::getName(*a));
     registerLlvmVal(a, arg);
     std::advance(arg, 1);
   }
@@ -384,6 +379,13 @@ llvm::Value* CodeGenVisitor::operator()(minst::Fcall& i) {
   }
   auto fobjtree_iter = funobj_map->find(mmmfn);
   const bool hasmemobj = fobjtree_iter != funobj_map->end();
+  if (i.ftype == EXTERNAL && !i.time.has_value()) {
+    const auto& extname = std::get<mir::ExternalSymbol>(*i.fname).name;
+    if (extname == "delay" || extname == "delayn") {
+      return createDelayPrim(i, popMemobjInContext());
+    }
+    if (extname == "mem") { return createMemPrim(i, popMemobjInContext()); }
+  }
 
   auto* fun = isrecursive ? G.curfunc : getFunForFcall(i);
   // prepare arguments
@@ -393,7 +395,7 @@ llvm::Value* CodeGenVisitor::operator()(minst::Fcall& i) {
     auto* timeval = getLlvmVal(i.time.value());
     llvm::Value* ptrtofn = G.builder->CreateBitCast(fun, G.geti8PtrTy(), fun->getName() + "_i8");
     args = {G.getRuntimeInstance(), timeval, ptrtofn};
-    if (i.args.empty()) { args.emplace_back(llvm::ConstantFP::get(G.ctx, llvm::APFloat(0.0))); }
+    if (i.args.empty()) { args.emplace_back(G.getConstFloat(0.0)); }
     if (i.args.size() > 1) {
       throw std::runtime_error(
           "currently function call with @ operator can accept only one argument with float type");
@@ -426,11 +428,23 @@ llvm::Value* CodeGenVisitor::operator()(minst::Fcall& i) {
   }
   assert(funtype_raw->isFunctionTy());
   auto* ft = llvm::cast<llvm::FunctionType>(funtype_raw);
+  // external functions and runtime take double even in single precision mode. The value of now
+  // and the time of @ are float in the source, so they are accurate only up to 2^24 samples.
+  for (unsigned int idx = 0; idx < ft->getNumParams() && idx < args.size(); idx++) {
+    auto* paramty = ft->getParamType(idx);
+    if (paramty->isFloatingPointTy() && args[idx]->getType() != paramty) {
+      args[idx] = G.builder->CreateFPCast(args[idx], paramty);
+    }
+  }
   // if return type is void, llvm cannot have return value and name
   if (ft->getReturnType()->isVoidTy()) {
     G.builder->CreateCall(ft, fun, args);
     return nullptr;
   }
+  if (ft->getReturnType()->isFloatingPointTy() && ft->getReturnType() != G.getFloatTy()) {
+    auto* res = G.builder->CreateCall(ft, fun, args, i.name + ".raw");
+    return G.builder->CreateFPCast(res, G.getFloatTy(), i.name);
+  }
   return G.builder->CreateCall(ft, fun, args, i.name);
 }
 llvm::Value* CodeGenVisitor::getFunForFcall(minst::Fcall const& i) {
@@ -451,7 +465,7 @@ llvm::Value* CodeGenVisitor::getClsFun(minst::Fcall const& i) {
                                  auto& realf = cls.fname;
                                  return getLlvmVal(realf);
                                },
-                               [&](std::shared_ptr<mir::Argument> f) -> llvm::Value* {
+                               [&](mir::Argument& f) -> llvm::Value* {
                                  return getLlvmVal(i.fname);
                                },
                                [](auto& /*v*/) {
@@ -474,6 +488,61 @@ llvm::Value* CodeGenVisitor::popMemobjInContext() {
   return res;
 }
 
+// Same as mimium_delayprim in ffi.cpp. The ring buffer size is power of two so that the index
+// wraps with bit mask. The indices in header are integers of the same width as float on memory
+// (int64 or int32 in single precision mode) though typed as float.
+llvm::Value* CodeGenVisitor::createDelayPrim(minst::Fcall& i, llvm::Value* rbuf) {
+  assert(i.args.size() == 2 || i.args.size() == 3);
+  auto& b = *G.builder;
+  auto* input = getLlvmVal(*std::prev(i.args.end(), 2));
+  auto* time = getLlvmVal(i.args.back());
+  auto* floatty = G.getFloatTy();
+  auto* indexty = b.getIntNTy(floatty->getPrimitiveSizeInBits());
+  auto* rbuftype = rbuf->getType()->getPointerElementType();
+  // buffer size is decided for each delay by MemoryObjsCollector.
+  auto size = llvm::cast<llvm::ArrayType>(llvm::cast<llvm::StructType>(rbuftype)->getElementType(2))
+                  ->getNumElements();
+  auto* mask = llvm::ConstantInt::get(indexty, size - 1);
+
+  auto* writeiptr = b.CreateBitCast(b.CreateStructGEP(rbuftype, rbuf, 1), indexty->getPointerTo(),
+                                    i.name + ".writei_ptr");
+  auto* one = llvm::ConstantInt::get(indexty, 1);
+  auto* writei =
+      b.CreateAnd(b.CreateAdd(b.CreateLoad(indexty, writeiptr), one), mask, i.name + ".writei");
+  b.CreateStore(writei, writeiptr);
+  auto* buf = b.CreateBitCast(b.CreateStructGEP(rbuftype, rbuf, 2), floatty->getPointerTo(),
+                              i.name + ".buf");
+  b.CreateStore(input, b.CreateInBoundsGEP(floatty, buf, writei));
+  auto readsample = [&](llvm::Value* delaysamples) {
+    auto* readi = b.CreateAnd(b.CreateSub(writei, delaysamples), mask);
+    return b.CreateLoad(floatty, b.CreateInBoundsGEP(floatty, buf, readi));
+  };
+  // integer constant delay time does not need interpolation.
+  if (auto* c = llvm::dyn_cast<llvm::ConstantFP>(time);
+      c != nullptr && c->getValueAPF().isInteger()) {
+    llvm::APSInt delaysamples(indexty->getIntegerBitWidth(), false);
+    bool isexact = false;
+    c->getValueAPF().convertToInteger(delaysamples, llvm::APFloat::rmTowardZero, &isexact);
+    auto* res = readsample(b.getInt(delaysamples));
+    res->setName(i.name);
+    return res;
+  }
+  auto* timei = b.CreateFPToSI(time, indexty, i.name + ".timei");
+  auto* fract = b.CreateFSub(time, b.CreateSIToFP(timei, floatty), i.name + ".fract");
+  auto* s0 = readsample(timei);
+  auto* s1 = readsample(b.CreateAdd(timei, one));
+  // linear interpolation without branch. equals to s0 when the time is integer.
+  return b.CreateFAdd(s0, b.CreateFMul(b.CreateFSub(s1, s0), fract), i.name);
+}
+
+llvm::Value* CodeGenVisitor::createMemPrim(minst::Fcall& i, llvm::Value* valptr) {
+  assert(i.args.size() == 1);
+  auto* input = getLlvmVal(i.args.front());
+  auto* res = G.builder->CreateLoad(G.getFloatTy(), valptr, i.name);
+  G.builder->CreateStore(input, valptr);
+  return res;
+}
+
 // store the capture address to memory
 llvm::Value* CodeGenVisitor::operator()(minst::MakeClosure& i) {
   // auto& capturenames = G.cc.getCaptureNames(i.fname);
@@ -517,7 +586,8 @@ llvm::Value* CodeGenVisitor::operator()(minst::ArrayAccess& i) {
   auto* target = getLlvmVal(i.target);
   // llvm::Value* target = G.builder->CreateLoad(targetp);
   auto* index = getLlvmVal(i.index);
-  auto* arraccessfun = G.module->getFunction("access_array_lin_interp");
+  auto* arraccessfun =
+      G.module->getFunction(G.isF32() ? "access_array_lin_interp_f32" : "access_array_lin_interp");
   auto* dptrty = arraccessfun->getArg(0)->getType();
   if (target->getType() != dptrty) { target = G.builder->CreateBitCast(target, dptrty); }
   return G.builder->CreateCall(arraccessfun, {target, index}, "arrayaccess");
@@ -556,7 +626,7 @@ llvm::Value* CodeGenVisitor::createIfBody(mir::blockptr& block) {
 llvm::Value* CodeGenVisitor::operator()(minst::If& i) {
   auto* thisbb = G.builder->GetInsertBlock();
   auto* cond = getLlvmVal(i.cond);
-  auto* cmp = G.builder->CreateFCmpOGT(cond, llvm::ConstantFP::get(G.ctx, llvm::APFloat(0.0)));
+  auto* cmp = G.builder->CreateFCmpOGT(cond, llvm::ConstantFP::get(cond->getType(), 0.0));
   auto* endbb = llvm::BasicBlock::Create(G.ctx, i.name + "_end", G.curfunc);
 
   auto* thenbb = llvm::BasicBlock::Create(G.ctx, i.name + "_then", G.curfunc, endbb);
@@ -38,13 +38,12 @@ struct CodeGenVisitor {
   void registerLlvmVal(mir::valueptr mirval, llvm::Value* llvmval);
   void registerLlvmValforFreeVar(mir::valueptr mirval, llvm::Value* llvmval);
 
-  void registerLlvmVal(std::shared_ptr<mir::Argument> mirval, llvm::Value* llvmval);
-
   llvm::Value* getLlvmVal(mir::valueptr mirval);
   llvm::Value* getLlvmValForFcallArgs(mir::valueptr mirval);
-  std::vector<llvm::Value*> makeFcallArgs(llvm::Type* ft,std::list<mir::valueptr>const& args);
+  std::vector<llvm::Value*> makeFcallArgs(llvm::Type* ft,std::vector<mir::valueptr>const& args);
 
-  std::unordered_map<mir::valueptr, llvm::Value*> mir_to_llvm;
+  // instructions and arguments
+  mir::ValueMap<llvm::Value*> mir_to_llvm;
 
   std::unordered_map<mir::valueptr, llvm::Value*> mirfv_to_llvm;
   std::unordered_map<mir::valueptr, llvm::Value*> memobj_to_llvm;
@@ -52,8 +51,6 @@ struct CodeGenVisitor {
   std::unordered_map<mir::valueptr, llvm::Value*> fun_to_selfval;
   std::unordered_map<mir::valueptr, llvm::Value*> fun_to_selfptr;
 
-  std::unordered_map<std::shared_ptr<mir::Argument>, llvm::Value*> mirarg_to_llvm;
-
   LLVMGenerator& G;//NOLINT
   const funobjmap* funobj_map;
   bool isglobal;
@@ -64,6 +61,9 @@ struct CodeGenVisitor {
   llvm::Value* getClsFun(minst::Fcall const& i);
   llvm::Value* getExtFun(minst::Fcall const& i);
   llvm::Value* popMemobjInContext();
+  // delay and mem are emitted as inline IR instead of calling ffi functions.
+  llvm::Value* createDelayPrim(minst::Fcall& i, llvm::Value* rbuf);
+  llvm::Value* createMemPrim(minst::Fcall& i, llvm::Value* valptr);
   llvm::FunctionType* createFunctionType(minst::Function& i);
   llvm::FunctionType* createDspFnType(minst::Function& i,bool hascapture,bool hasmemobj);
 
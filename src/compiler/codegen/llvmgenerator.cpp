@@ -8,6 +8,7 @@
 #include "compiler/codegen/llvm_header.hpp"
 #include "compiler/codegen/typeconverter.hpp"
 #include "compiler/ffi.hpp"
+#include "llvm/Support/xxhash.h"
 
 namespace mimium {
 
@@ -24,6 +25,11 @@ LLVMGenerator::LLVMGenerator(llvm::LLVMContext& ctx)
            {"access_array_lin_interp",
             llvm::FunctionType::get(
                 getDoubleTy(), {llvm::PointerType::get(getDoubleTy(), 0), getDoubleTy()}, false)},
+           {"access_array_lin_interp_f32",
+            llvm::FunctionType::get(builder->getFloatTy(),
+                                    {llvm::PointerType::get(builder->getFloatTy(), 0),
+                                     builder->getFloatTy()},
+                                    false)},
            {"mimium_malloc",
             llvm::FunctionType::get(geti8PtrTy(), {geti8PtrTy(), geti64Ty()}, false)}}) {}
 
@@ -38,6 +44,11 @@ void LLVMGenerator::init(std::string filename) {
 
 void LLVMGenerator::setDataLayout(const llvm::DataLayout& dl) { module->setDataLayout(dl); }
 
+void LLVMGenerator::setFloatPrecision(FloatPrecision p) {
+  precision = p;
+  typeconverter->precision = p;
+}
+
 void LLVMGenerator::reset(std::string filename) {
   dropAllReferences();
   init(filename);
@@ -59,13 +70,22 @@ llvm::ArrayType* LLVMGenerator::getArrayType(types::Value const& type) {
 }
 
 llvm::Type* LLVMGenerator::getDoubleTy() { return llvm::Type::getDoubleTy(ctx); }
+llvm::Type* LLVMGenerator::getFloatTy() {
+  return isF32() ? llvm::Type::getFloatTy(ctx) : llvm::Type::getDoubleTy(ctx);
+}
+llvm::FunctionType* LLVMGenerator::toDoubleFunType(llvm::FunctionType* ftype) {
+  auto conv = [&](llvm::Type* t) { return t->isFloatTy() ? getDoubleTy() : t; };
+  std::vector<llvm::Type*> params;
+  for (auto* p : ftype->params()) { params.emplace_back(conv(p)); }
+  return llvm::FunctionType::get(conv(ftype->getReturnType()), params, ftype->isVarArg());
+}
 llvm::PointerType* LLVMGenerator::geti8PtrTy() { return builder->getInt8PtrTy(); }
 llvm::Type* LLVMGenerator::geti64Ty() { return builder->getInt64Ty(); }
 llvm::Value* LLVMGenerator::getConstInt(int v, const int bitsize) {
   return llvm::ConstantInt::get(llvm::IntegerType::get(ctx, bitsize), llvm::APInt(bitsize, v));
 }
-llvm::Value* LLVMGenerator::getConstDouble(double v) {
-  return llvm::ConstantFP::get(builder->getDoubleTy(), v);
+llvm::Value* LLVMGenerator::getConstFloat(double v) {
+  return llvm::ConstantFP::get(getFloatTy(), v);
 }
 
 llvm::Value* LLVMGenerator::getZero(const int bitsize) { return getConstInt(0, bitsize); }
@@ -85,7 +105,7 @@ void LLVMGenerator::switchToMainFun() {
   curfunc = mainentry->getParent();
 }
 llvm::Function* LLVMGenerator::getForeignFunction(const std::string& name) {
-  const auto& [type, targetname] = LLVMBuiltin::ftable.find(name)->second;
+  const auto& [type, targetname, targetname_f32] = LLVMBuiltin::ftable.find(name)->second;
   auto ftype = rv::get<types::Function>(type);
   if (name == "delay") { ftype.arg_types.emplace_back(types::Ref{types::getDelayStruct()}); }
   if (name == "mem") { ftype.arg_types.emplace_back(types::Ref{types::Float{}}); }
@@ -93,7 +113,13 @@ llvm::Function* LLVMGenerator::getForeignFunction(const std::string& name) {
     // for loadwavfile
     ftype.ret_type = types::Ref{ftype.ret_type};
   }
-  return getFunction(targetname, getType(ftype));
+  auto* fntype = llvm::cast<llvm::FunctionType>(getType(ftype));
+  if (isF32()) {
+    if (!targetname_f32.empty()) { return getFunction(targetname_f32, fntype); }
+    // no single precision version. arguments and result are converted at the call site.
+    return getFunction(targetname, toDoubleFunType(fntype));
+  }
+  return getFunction(targetname, fntype);
 }
 llvm::Function* LLVMGenerator::getRuntimeFunction(const std::string& name) {
   const auto& type = runtime_fun_names.at(name);
@@ -201,7 +227,7 @@ void LLVMGenerator::checkDspFunctionType(minst::Function const& i) {
   std::optional<int> inchs = std::nullopt;
 
   if (i.args.ret_ptr) {
-    auto retptrty = i.args.ret_ptr.value()->type;
+    auto retptrty = mir::getType(*i.args.ret_ptr.value());
     outchs = getDspFnChannelNumForType(retptrty);
   } else {
     outchs = getDspFnChannelNumForType(rettype);
@@ -225,7 +251,7 @@ void LLVMGenerator::checkDspFunctionType(minst::Function const& i) {
   runtime_dspfninfo.out_numchs = outchs.value();
 }
 
-void LLVMGenerator::createRuntimeSetDspFn(llvm::Type* memobjtype) {
+void LLVMGenerator::createRuntimeSetDspFn(llvm::Type* memobjtype, uint64_t memobj_layout) {
   auto* voidptrtype = builder->getInt8PtrTy();
   auto* int32ty = builder->getInt32Ty();
   auto* constantnull = llvm::ConstantPointerNull::get(voidptrtype);
@@ -259,6 +285,181 @@ void LLVMGenerator::createRuntimeSetDspFn(llvm::Type* memobjtype) {
 
   builder->CreateCall(setdsp, {getRuntimeInstance(), dspfnaddress, dspclsaddress, dspmemobjaddress,
                                inchs_const, outchs_const});
+  if (memobjtype != nullptr) {
+    // used by the runtime to allocate memory objects for polyphonic voices.
+    auto setmemsize = module->getOrInsertFunction(
+        "setDspMemobjSize",
+        llvm::FunctionType::get(builder->getVoidTy(), {voidptrtype, builder->getInt64Ty()}, false));
+    auto size = module->getDataLayout().getTypeAllocSize(memobjtype);
+    builder->CreateCall(setmemsize, {getRuntimeInstance(), getConstInt(static_cast<int>(size))});
+    // used on live reload to decide whether the state can be carried over to the new dsp.
+    auto setmemlayout = module->getOrInsertFunction(
+        "setDspMemobjLayout",
+        llvm::FunctionType::get(builder->getVoidTy(), {voidptrtype, builder->getInt64Ty()}, false));
+    builder->CreateCall(setmemlayout, {getRuntimeInstance(), builder->getInt64(memobj_layout)});
+  }
+  if (dspfn != nullptr) {
+    auto* dspblockfn = createDspBlockFun(dspfn);
+    auto setdspblock = module->getOrInsertFunction(
+        "setDspBlockFn",
+        llvm::FunctionType::get(builder->getVoidTy(), {voidptrtype, voidptrtype}, false));
+    builder->CreateCall(setdspblock, {getRuntimeInstance(),
+                                      builder->CreateBitCast(dspblockfn, voidptrtype)});
+    auto* dspplanarfn = createDspPlanarBlockFun(dspfn);
+    auto setdspplanar = module->getOrInsertFunction(
+        "setDspPlanarBlockFn",
+        llvm::FunctionType::get(builder->getVoidTy(), {voidptrtype, voidptrtype}, false));
+    builder->CreateCall(setdspplanar, {getRuntimeInstance(),
+                                       builder->CreateBitCast(dspplanarfn, voidptrtype)});
+  }
+}
+
+// Create dsp_block(out, in, nframes, cls, memobj) that calls dsp() for each interleaved frame, so
+// that the audio driver can call JIT-ed code once per block and llvm can optimize across samples.
+llvm::Function* LLVMGenerator::createDspBlockFun(llvm::Function* dspfn) {
+  auto* dptrty = llvm::PointerType::get(getFloatTy(), 0);
+  auto* voidptrtype = builder->getInt8PtrTy();
+  auto* i64 = builder->getInt64Ty();
+  auto* fntype = llvm::FunctionType::get(builder->getVoidTy(),
+                                         {dptrty, dptrty, i64, voidptrtype, voidptrtype}, false);
+  auto* blockfn =
+      llvm::Function::Create(fntype, llvm::Function::ExternalLinkage, "dsp_block", *module);
+  blockfn->setCallingConv(llvm::CallingConv::C);
+  auto* arg = blockfn->arg_begin();
+  for (const auto* name : {"output", "input", "nframes", "cls", "memobj"}) { (arg++)->setName(name); }
+  auto* nframes = blockfn->getArg(2);
+
+  auto* insertpoint = builder->GetInsertBlock();
+  auto* entry = llvm::BasicBlock::Create(ctx, "entry", blockfn);
+  auto* loopcond = llvm::BasicBlock::Create(ctx, "loop.cond", blockfn);
+  auto* loopbody = llvm::BasicBlock::Create(ctx, "loop.body", blockfn);
+  auto* loopend = llvm::BasicBlock::Create(ctx, "loop.end", blockfn);
+  builder->SetInsertPoint(entry);
+  builder->CreateBr(loopcond);
+
+  builder->SetInsertPoint(loopcond);
+  auto* count = builder->CreatePHI(i64, 2, "count");
+  count->addIncoming(getZero(), entry);
+  builder->CreateCondBr(builder->CreateICmpSLT(count, nframes), loopbody, loopend);
+
+  builder->SetInsertPoint(loopbody);
+  auto* outoffset = builder->CreateMul(count, getConstInt(runtime_dspfninfo.out_numchs));
+  auto* inoffset = builder->CreateMul(count, getConstInt(runtime_dspfninfo.in_numchs));
+  // output, input, cls, memobj
+  std::vector<llvm::Value*> dspargs = {
+      builder->CreateInBoundsGEP(getFloatTy(), blockfn->getArg(0), outoffset, "out_i"),
+      builder->CreateInBoundsGEP(getFloatTy(), blockfn->getArg(1), inoffset, "in_i"),
+      blockfn->getArg(3), blockfn->getArg(4)};
+  // dsp function is called with the same arguments as DspFnPtr in runtime.
+  std::vector<llvm::Value*> args;
+  for (auto& param : dspfn->args()) {
+    auto* a = dspargs.at(param.getArgNo());
+    args.emplace_back(builder->CreatePointerCast(a, param.getType()));
+  }
+  createSetFrameOffset(count);
+  builder->CreateCall(dspfn->getFunctionType(), dspfn, args);
+  auto* nextcount = builder->CreateAdd(count, getConstInt(1), "nextcount");
+  count->addIncoming(nextcount, loopbody);
+  builder->CreateBr(loopcond);
+
+  builder->SetInsertPoint(loopend);
+  createSetFrameOffset(getZero());
+  builder->CreateRetVoid();
+
+  builder->SetInsertPoint(insertpoint);
+  return blockfn;
+}
+
+// Tell the runtime the offset of the frame processed by dsp_block, so that now advances for each
+// frame of a span. Emitted only when the source refers now.
+void LLVMGenerator::createSetFrameOffset(llvm::Value* offset) {
+  auto* getnow = module->getFunction("mimium_getnow");
+  if (getnow == nullptr || getnow->use_empty()) { return; }
+  auto setoffset = module->getOrInsertFunction(
+      "mimium_setframeoffset",
+      llvm::FunctionType::get(builder->getVoidTy(), {builder->getInt64Ty()}, false));
+  builder->CreateCall(setoffset, {offset});
+}
+
+// Create dsp_block_planar(outputs, inputs, nframes, cls, memobj) which takes arrays of channel
+// pointers, so that the driver can pass non-interleaved buffers of the host without copying.
+// Samples of each frame go through local tuples, which are promoted to registers by optimization.
+llvm::Function* LLVMGenerator::createDspPlanarBlockFun(llvm::Function* dspfn) {
+  auto* fty = getFloatTy();
+  auto* chptrty = llvm::PointerType::get(fty, 0);
+  auto* chptrarrty = llvm::PointerType::get(chptrty, 0);
+  auto* voidptrtype = builder->getInt8PtrTy();
+  auto* i64 = builder->getInt64Ty();
+  auto* fntype = llvm::FunctionType::get(
+      builder->getVoidTy(), {chptrarrty, chptrarrty, i64, voidptrtype, voidptrtype}, false);
+  auto* blockfn =
+      llvm::Function::Create(fntype, llvm::Function::ExternalLinkage, "dsp_block_planar", *module);
+  blockfn->setCallingConv(llvm::CallingConv::C);
+  auto* arg = blockfn->arg_begin();
+  for (const auto* name : {"outputs", "inputs", "nframes", "cls", "memobj"}) {
+    (arg++)->setName(name);
+  }
+  auto* nframes = blockfn->getArg(2);
+  const int inchs = runtime_dspfninfo.in_numchs;
+  const int outchs = runtime_dspfninfo.out_numchs;
+
+  auto* insertpoint = builder->GetInsertBlock();
+  auto* entry = llvm::BasicBlock::Create(ctx, "entry", blockfn);
+  auto* loopcond = llvm::BasicBlock::Create(ctx, "loop.cond", blockfn);
+  auto* loopbody = llvm::BasicBlock::Create(ctx, "loop.body", blockfn);
+  auto* loopend = llvm::BasicBlock::Create(ctx, "loop.end", blockfn);
+  builder->SetInsertPoint(entry);
+  auto* inframety = llvm::ArrayType::get(fty, std::max(inchs, 1));
+  auto* outframety = llvm::ArrayType::get(fty, std::max(outchs, 1));
+  auto* inframe = builder->CreateAlloca(inframety, nullptr, "in_frame");
+  auto* outframe = builder->CreateAlloca(outframety, nullptr, "out_frame");
+  // channel pointers do not change during the block.
+  auto loadchannels = [&](llvm::Value* chptrs, int numchs, const std::string& name) {
+    std::vector<llvm::Value*> res;
+    for (int ch = 0; ch < numchs; ch++) {
+      auto* chptr = builder->CreateConstInBoundsGEP1_64(chptrty, chptrs, ch);
+      res.emplace_back(builder->CreateLoad(chptrty, chptr, name + std::to_string(ch)));
+    }
+    return res;
+  };
+  auto inchptrs = loadchannels(blockfn->getArg(1), inchs, "in_ch");
+  auto outchptrs = loadchannels(blockfn->getArg(0), outchs, "out_ch");
+  builder->CreateBr(loopcond);
+
+  builder->SetInsertPoint(loopcond);
+  auto* count = builder->CreatePHI(i64, 2, "count");
+  count->addIncoming(getZero(), entry);
+  builder->CreateCondBr(builder->CreateICmpSLT(count, nframes), loopbody, loopend);
+
+  builder->SetInsertPoint(loopbody);
+  for (int ch = 0; ch < inchs; ch++) {
+    auto* sample = builder->CreateLoad(fty, builder->CreateInBoundsGEP(fty, inchptrs[ch], count));
+    builder->CreateStore(sample, builder->CreateConstInBoundsGEP2_64(inframety, inframe, 0, ch));
+  }
+  // output, input, cls, memobj
+  std::vector<llvm::Value*> dspargs = {outframe, inframe, blockfn->getArg(3), blockfn->getArg(4)};
+  std::vector<llvm::Value*> args;
+  for (auto& param : dspfn->args()) {
+    auto* a = dspargs.at(param.getArgNo());
+    args.emplace_back(builder->CreatePointerCast(a, param.getType()));
+  }
+  createSetFrameOffset(count);
+  builder->CreateCall(dspfn->getFunctionType(), dspfn, args);
+  for (int ch = 0; ch < outchs; ch++) {
+    auto* sample =
+        builder->CreateLoad(fty, builder->CreateConstInBoundsGEP2_64(outframety, outframe, 0, ch));
+    builder->CreateStore(sample, builder->CreateInBoundsGEP(fty, outchptrs[ch], count));
+  }
+  auto* nextcount = builder->CreateAdd(count, getConstInt(1), "nextcount");
+  count->addIncoming(nextcount, loopbody);
+  builder->CreateBr(loopcond);
+
+  builder->SetInsertPoint(loopend);
+  createSetFrameOffset(getZero());
+  builder->CreateRetVoid();
+
+  builder->SetInsertPoint(insertpoint);
+  return blockfn;
 }
 
 llvm::Value* LLVMGenerator::getRuntimeInstance() {
@@ -275,6 +476,13 @@ void LLVMGenerator::preprocess() {
   setBB(mainentry);
   builder->CreateStore(mainentry->getParent()->args().begin(),
                        module->getNamedGlobal("global_runtime"), false);
+  // tell the runtime how to call tasks and dsp before anything is registered.
+  auto setprecision = module->getOrInsertFunction(
+      "setFloatPrecision", llvm::FunctionType::get(builder->getVoidTy(),
+                                                   {geti8PtrTy(), builder->getInt32Ty()}, false));
+  constexpr int bitsize = 32;
+  builder->CreateCall(setprecision,
+                      {getRuntimeInstance(), getConstInt(static_cast<int>(precision), bitsize)});
 }
 void LLVMGenerator::visitInstructions(mir::valueptr inst, bool isglobal) {
   codegenvisitor->isglobal = isglobal;
@@ -289,15 +497,19 @@ void LLVMGenerator::generateCode(mir::blockptr mir, const funobjmap* funobjs) {
   codegenvisitor = std::make_shared<CodeGenVisitor>(*this, funobjs);
   preprocess();
   llvm::Type* memobjtype = nullptr;
+  uint64_t memobj_layout = 0;
   for (auto& inst : mir->instructions) {
     visitInstructions(inst, true);
     if (mir::getName(*inst) == "dsp") {
       auto&& iter = funobjs->find(inst);
-      if (iter != funobjs->end()) { memobjtype = getType(iter->second->objtype); }
+      if (iter != funobjs->end()) {
+        memobjtype = getType(iter->second->objtype);
+        memobj_layout = llvm::xxHash64(types::toString(iter->second->objtype));
+      }
     }
   }
   // create a call for setDspParams regardless dsp fn is present
-  createRuntimeSetDspFn(memobjtype);
+  createRuntimeSetDspFn(memobjtype, memobj_layout);
   // main always return null for now;
   builder->CreateRet(llvm::ConstantPointerNull::get(builder->getInt8PtrTy()));
 }
@@ -5,6 +5,7 @@
 #pragma once
 
 #include "basic/mir.hpp"
+#include "runtime/runtime_defs.hpp"
 namespace llvm {
 class LLVMContext;
 class Module;
@@ -16,6 +17,7 @@ class PointerType;
 class BasicBlock;
 class ArrayType;
 class Function;
+class FunctionType;
 class ConstantInt;
 
 class IRBuilderBase;
@@ -44,6 +46,9 @@ class MIMIUM_DLL_PUBLIC LLVMGenerator {
   void init(std::string filename);
   void setDataLayout(const llvm::DataLayout& dl);
   void reset(std::string filename);
+  // must be set before generateCode(). F32 lowers types::Float to llvm float.
+  void setFloatPrecision(FloatPrecision p);
+  [[nodiscard]] FloatPrecision getFloatPrecision() const { return precision; }
 
   void outputToStream(llvm::raw_ostream& ostream);
   static void dumpvar(llvm::Value* v);
@@ -58,6 +63,7 @@ class MIMIUM_DLL_PUBLIC LLVMGenerator {
   llvm::BasicBlock* currentblock;
   std::unique_ptr<TypeConverter> typeconverter;
   std::shared_ptr<CodeGenVisitor> codegenvisitor;
+  FloatPrecision precision = FloatPrecision::F64;
 
   llvm::Type* getType(types::Value const& type);
   // Used for getting Arraytype which is not pointer of elementtype
@@ -81,7 +87,11 @@ class MIMIUM_DLL_PUBLIC LLVMGenerator {
   llvm::Function* getFunction(const std::string& name, llvm::Type* type);
 
   void createMiscDeclarations();
-  void createRuntimeSetDspFn(llvm::Type* memobjtype);
+  // memobj_layout is a hash of the type of dsp's memory object, 0 if unknown.
+  void createRuntimeSetDspFn(llvm::Type* memobjtype, uint64_t memobj_layout = 0);
+  llvm::Function* createDspBlockFun(llvm::Function* dspfn);
+  void createSetFrameOffset(llvm::Value* offset);
+  llvm::Function* createDspPlanarBlockFun(llvm::Function* dspfn);
   void checkDspFunctionType(minst::Function const& i);
   static std::optional<int> getDspFnChannelNumForType(types::Value const& t);
   void createMainFun();
@@ -94,10 +104,15 @@ class MIMIUM_DLL_PUBLIC LLVMGenerator {
   llvm::Value* getRuntimeInstance();
 
   llvm::Type* getDoubleTy();
+  // llvm type for types::Float, depending on the precision.
+  llvm::Type* getFloatTy();
+  [[nodiscard]] bool isF32() const { return precision == FloatPrecision::F32; }
+  // external C functions take double. converts float arguments and return value of the type.
+  llvm::FunctionType* toDoubleFunType(llvm::FunctionType* ftype);
   llvm::PointerType* geti8PtrTy();
   llvm::Type* geti64Ty();
   llvm::Value* getConstInt(int v, int bitsize = 64);
-  llvm::Value* getConstDouble(double v);
+  llvm::Value* getConstFloat(double v);
   llvm::Value* getZero(int bitsize = 64);
 };
 
@@ -0,0 +1,110 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+#include "compiler/codegen/object_emitter.hpp"
+#include <stdexcept>
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Config/llvm-config.h"
+#include "llvm/IR/LegacyPassManager.h"
+#include "llvm/IR/Module.h"
+#include "llvm/MC/SubtargetFeature.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/FileUtilities.h"
+#include "llvm/Support/Host.h"
+#include "llvm/Support/Program.h"
+#include "llvm/Support/TargetSelect.h"
+#include "llvm/Support/raw_ostream.h"
+#if LLVM_VERSION_MAJOR >= 14
+#include "llvm/MC/TargetRegistry.h"
+#else
+#include "llvm/Support/TargetRegistry.h"
+#endif
+#include "llvm/Target/TargetMachine.h"
+#include "llvm/Target/TargetOptions.h"
+
+#include "basic/helper_functions.hpp"
+#include "basic/pass_timer.hpp"
+#include "compiler/codegen/pass_pipeline.hpp"
+
+namespace {
+
+std::unique_ptr<llvm::TargetMachine> createHostTargetMachine(mimium::OptimizeLevel level) {
+  llvm::InitializeNativeTarget();
+  llvm::InitializeNativeTargetAsmPrinter();
+  auto triple = llvm::sys::getProcessTriple();
+  std::string err;
+  const auto* target = llvm::TargetRegistry::lookupTarget(triple, err);
+  if (target == nullptr) {
+    throw std::runtime_error("Failed to find target for " + triple + ": " + err);
+  }
+  llvm::SubtargetFeatures features;
+  llvm::StringMap<bool> hostfeatures;
+  if (llvm::sys::getHostCPUFeatures(hostfeatures)) {
+    for (auto& f : hostfeatures) { features.AddFeature(f.first(), f.second); }
+  }
+  auto cglevel = level == mimium::OptimizeLevel::O0   ? llvm::CodeGenOpt::None
+                 : level == mimium::OptimizeLevel::O3 ? llvm::CodeGenOpt::Aggressive
+                                                      : llvm::CodeGenOpt::Default;
+  // always position independent so that the object can also be linked into shared library.
+  auto* tm = target->createTargetMachine(triple, llvm::sys::getHostCPUName(),
+                                         features.getString(), llvm::TargetOptions(),
+                                         llvm::Reloc::PIC_, llvm::None, cglevel);
+  if (tm == nullptr) { throw std::runtime_error("Failed to create target machine for " + triple); }
+  return std::unique_ptr<llvm::TargetMachine>(tm);
+}
+
+}  // namespace
+
+namespace mimium {
+
+void emitObjectFile(llvm::Module& module, fs::path const& path, OptimizeLevel level,
+                    PassTimer* timer) {
+  auto tm = createHostTargetMachine(level);
+  module.setTargetTriple(tm->getTargetTriple().str());
+  module.setDataLayout(tm->createDataLayout());
+  {
+    PassTimer::Scope t(timer, "compiler", "optimize");
+    runPassPipeline(module, tm.get(), level, timer);
+  }
+  PassTimer::Scope t(timer, "compiler", "emit object");
+
+  std::error_code ec;
+  llvm::raw_fd_ostream out(path.string(), ec, llvm::sys::fs::OF_None);
+  if (ec) { throw std::runtime_error("Failed to open " + path.string() + ": " + ec.message()); }
+  llvm::legacy::PassManager pm;
+  if (tm->addPassesToEmitFile(pm, out, nullptr, llvm::CGFT_ObjectFile)) {
+    throw std::runtime_error("Target machine cannot emit object file.");
+  }
+  pm.run(module);
+  out.flush();
+  Logger::debug_log("Object file emitted to " + path.string(), Logger::INFO);
+}
+
+void emitSharedObject(llvm::Module& module, fs::path const& path, OptimizeLevel level,
+                      PassTimer* timer) {
+  llvm::SmallString<128> objpath;
+  if (auto ec = llvm::sys::fs::createTemporaryFile("mimium", "o", objpath)) {
+    throw std::runtime_error("Failed to create temporary object file: " + ec.message());
+  }
+  llvm::FileRemover remover(objpath);
+  emitObjectFile(module, fs::path(objpath.str().str()), level, timer);
+  PassTimer::Scope t(timer, "compiler", "link");
+
+  auto linker = llvm::sys::findProgramByName("cc");
+  if (!linker) { throw std::runtime_error("Failed to find system linker(cc) in PATH."); }
+  auto outpath = path.string();
+  std::vector<llvm::StringRef> args = {*linker, "-shared", "-o", outpath, objpath};
+#ifdef __APPLE__
+  // symbols of runtime are resolved from host application on dlopen.
+  args.insert(args.end(), {"-undefined", "dynamic_lookup"});
+#endif
+  std::string errmsg;
+  int res = llvm::sys::ExecuteAndWait(*linker, args, llvm::None, {}, 0, 0, &errmsg);
+  if (res != 0) {
+    throw std::runtime_error("Failed to link shared object " + outpath + ": " + errmsg);
+  }
+  Logger::debug_log("Shared object emitted to " + outpath, Logger::INFO);
+}
+
+}  // namespace mimium
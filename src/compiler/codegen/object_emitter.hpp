@@ -0,0 +1,30 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+#pragma once
+#include "basic/codegen_option.hpp"
+#include "export.hpp"
+#include "utils/include_filesystem.hpp"
+
+namespace llvm {
+class Module;
+}
+
+namespace mimium {
+class PassTimer;
+
+// Ahead-of-time compilation of the generated module for the host machine.
+// The emitted code refers runtime functions(setDspParams, addTask, builtin functions...) as
+// undefined symbols, which are resolved from the host application at load time.
+
+// compile module into a native relocatable object file.
+MIMIUM_DLL_PUBLIC void emitObjectFile(llvm::Module& module, fs::path const& path,
+                                      OptimizeLevel level = OptimizeLevel::O2,
+                                      PassTimer* timer = nullptr);
+// compile module into a temporary object and link it into a shared library with system linker.
+MIMIUM_DLL_PUBLIC void emitSharedObject(llvm::Module& module, fs::path const& path,
+                                        OptimizeLevel level = OptimizeLevel::O2,
+                                        PassTimer* timer = nullptr);
+
+}  // namespace mimium
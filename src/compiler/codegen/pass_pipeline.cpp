@@ -0,0 +1,102 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+#include "compiler/codegen/pass_pipeline.hpp"
+#include <chrono>
+#include <optional>
+#include <vector>
+#include "basic/pass_timer.hpp"
+#include "llvm/Config/llvm-config.h"
+#include "llvm/IR/PassInstrumentation.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Passes/PassBuilder.h"
+#include "llvm/Target/TargetMachine.h"
+
+namespace {
+#if LLVM_VERSION_MAJOR >= 14
+using LLVMOptLevel = llvm::OptimizationLevel;
+#else
+using LLVMOptLevel = llvm::PassBuilder::OptimizationLevel;
+#endif
+
+LLVMOptLevel toLLVMOptLevel(mimium::OptimizeLevel level) {
+  switch (level) {
+    case mimium::OptimizeLevel::O1: return LLVMOptLevel::O1;
+    case mimium::OptimizeLevel::O2: return LLVMOptLevel::O2;
+    case mimium::OptimizeLevel::O3: return LLVMOptLevel::O3;
+    case mimium::OptimizeLevel::Os: return LLVMOptLevel::Os;
+    default: return LLVMOptLevel::O0;
+  }
+}
+
+// pass managers and adaptors run other passes inside. they are not counted not to add the time
+// of the nested passes twice.
+bool isWrapperPass(llvm::StringRef id) {
+  return id.contains("PassManager") || id.contains("PassAdaptor") ||
+         id.contains("RepeatedPass") || id.contains("InlinerWrapperPass");
+}
+
+// passes are nested, so start times are kept in a stack.
+class PassTimingCallbacks {
+ public:
+  PassTimingCallbacks(mimium::PassTimer& timer, llvm::PassInstrumentationCallbacks& pic)
+      : timer(timer) {
+#if LLVM_VERSION_MAJOR >= 12
+    pic.registerBeforeNonSkippedPassCallback(
+        [this](llvm::StringRef /*id*/, llvm::Any /*ir*/) { starts.push_back(Clock::now()); });
+#else
+    pic.registerBeforePassCallback([this](llvm::StringRef /*id*/, llvm::Any /*ir*/) {
+      starts.push_back(Clock::now());
+      return true;
+    });
+#endif
+    // arguments after the pass name differ between llvm versions.
+    pic.registerAfterPassCallback([this](llvm::StringRef id, auto&&... /*args*/) { end(id); });
+    pic.registerAfterPassInvalidatedCallback(
+        [this](llvm::StringRef id, auto&&... /*args*/) { end(id); });
+  }
+
+ private:
+  using Clock = std::chrono::steady_clock;
+  mimium::PassTimer& timer;
+  std::vector<Clock::time_point> starts;
+  void end(llvm::StringRef id) {
+    std::chrono::duration<double, std::milli> elapsed = Clock::now() - starts.back();
+    starts.pop_back();
+    if (!isWrapperPass(id)) { timer.add("llvm passes", id.str(), elapsed.count()); }
+  }
+};
+}  // namespace
+
+namespace mimium {
+
+void runPassPipeline(llvm::Module& module, llvm::TargetMachine* tm, OptimizeLevel level,
+                     PassTimer* timer) {
+  if (level == OptimizeLevel::O0) { return; }
+  llvm::PassInstrumentationCallbacks pic;
+  std::optional<PassTimingCallbacks> timing;
+  if (timer != nullptr) { timing.emplace(*timer, pic); }
+  llvm::PipelineTuningOptions pto;
+  // vectorizers are disabled by default unless frontend enables them, same as clang -O2.
+  pto.LoopVectorization = level != OptimizeLevel::O1;
+  pto.SLPVectorization = level != OptimizeLevel::O1;
+#if LLVM_VERSION_MAJOR == 12
+  llvm::PassBuilder pb(false, tm, pto, llvm::None, &pic);
+#else
+  llvm::PassBuilder pb(tm, pto, llvm::None, &pic);
+#endif
+  llvm::LoopAnalysisManager lam;
+  llvm::FunctionAnalysisManager fam;
+  llvm::CGSCCAnalysisManager cgam;
+  llvm::ModuleAnalysisManager mam;
+  pb.registerModuleAnalyses(mam);
+  pb.registerCGSCCAnalyses(cgam);
+  pb.registerFunctionAnalyses(fam);
+  pb.registerLoopAnalyses(lam);
+  pb.crossRegisterProxies(lam, fam, cgam, mam);
+  auto mpm = pb.buildPerModuleDefaultPipeline(toLLVMOptLevel(level));
+  mpm.run(module, mam);
+}
+
+}  // namespace mimium
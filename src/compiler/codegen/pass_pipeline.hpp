@@ -0,0 +1,24 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+#pragma once
+#include "basic/codegen_option.hpp"
+#include "export.hpp"
+
+namespace llvm {
+class Module;
+class TargetMachine;
+}  // namespace llvm
+
+namespace mimium {
+class PassTimer;
+
+// Runs the default module pipeline of the new PassBuilder (inlining, loop & SLP vectorization,
+// ...) on the module. Target machine is used for the cost models of vectorizers and should be
+// created for the CPU the code runs on. O0 runs nothing.
+// If timer is given, time of each pass is added to it in "llvm passes" group.
+MIMIUM_DLL_PUBLIC void runPassPipeline(llvm::Module& module, llvm::TargetMachine* tm,
+                                       OptimizeLevel level, PassTimer* timer = nullptr);
+
+}  // namespace mimium
@@ -16,7 +16,9 @@ llvm::Type* TypeConverter::operator()(types::TypeVar const& /*i*/) {
   return nullptr;
 }
 llvm::Type* TypeConverter::operator()(types::Void const& /*i*/) { return builder.getVoidTy(); }
-llvm::Type* TypeConverter::operator()(types::Float const& /*i*/) { return builder.getDoubleTy(); }
+llvm::Type* TypeConverter::operator()(types::Float const& /*i*/) {
+  return precision == FloatPrecision::F32 ? builder.getFloatTy() : builder.getDoubleTy();
+}
 llvm::Type* TypeConverter::operator()(types::String const& /*i*/) { return builder.getInt8PtrTy(); }
 llvm::Type* TypeConverter::operator()(types::Ref const& i) {
   auto* elemty = std::visit(*this, i.val);
@@ -4,6 +4,7 @@
 
 #pragma once
 #include "basic/type.hpp"
+#include "runtime/runtime_defs.hpp"
 namespace llvm{
   class Type;
   class Module;
@@ -17,6 +18,7 @@ struct TypeConverter {
   llvm::IRBuilderBase& builder;
   llvm::Module& module;
   std::string tmpname;
+  FloatPrecision precision = FloatPrecision::F64;
   std::unordered_map<std::string, llvm::Type*> aliasmap;
   static void error() { throw std::runtime_error("Invalid Type"); }
 
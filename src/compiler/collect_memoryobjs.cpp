@@ -3,6 +3,7 @@
  * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
 
 #include "collect_memoryobjs.hpp"
+#include "basic/helper_functions.hpp"
 namespace mimium {
 
 std::unordered_set<mir::valueptr> MemoryObjsCollector::collectToplevelFuns(mir::blockptr toplevel) {
@@ -48,27 +49,64 @@ std::shared_ptr<FunObjTree> MemoryObjsCollector::traverseFunTree(mir::valueptr f
 funobjmap MemoryObjsCollector::process(mir::blockptr toplevel) {
   auto& insts = toplevel->instructions;
   std::shared_ptr<FunObjTree> res;
-  std::unordered_set<mir::valueptr> alloca_container;
+  std::vector<mir::valueptr> alloca_container;
+  footprint = 0;
   for (auto&& inst : insts) {
     if (mir::isInstA<minst::Function>(inst)) {
       if (!std::holds_alternative<mir::ExternalSymbol>(*inst)) {
         res = traverseFunTree(inst);
         auto memtype = res->objtype;
         if (!res->memobjs.empty() || res->hasself) {
-          alloca_container.emplace(std::make_shared<mir::Value>(
+          alloca_container.emplace_back(pool.make(
               minst::Allocate{{mir::getName(*inst) + ".mem", types::Pointer{memtype}}}));
+          auto size = getSizeInBytes(memtype);
+          footprint += size;
+          Logger::debug_log("memory object of " + mir::getName(*inst) + ": " +
+                                std::to_string(size) + " bytes",
+                            Logger::INFO);
         }
       }
     }
   }
+  Logger::debug_log("total memory objects: " + std::to_string(footprint) + " bytes",
+                    Logger::INFO);
 
 #ifdef MIMIUM_DEBUG_BUILD
   if (res) { dump_res = *res; }
 #endif
-  for (auto&& ainst : alloca_container) { insts.insert(std::begin(insts), ainst); }
+  insts.insert(std::begin(insts), alloca_container.begin(), alloca_container.end());
   return result_map;
 }
 
+size_t MemoryObjsCollector::getSizeInBytes(types::Value const& type) const {
+  return getLayout(type).size;
+}
+// members are aligned as llvm struct without packing. the indices of delay have the same width
+// as float, and others are pointers.
+MemoryObjsCollector::Layout MemoryObjsCollector::getLayout(types::Value const& type) const {
+  const size_t floatsize = precision == FloatPrecision::F32 ? sizeof(float) : sizeof(double);
+  auto align_to = [](size_t size, size_t align) { return (size + align - 1) / align * align; };
+  return std::visit(
+      overloaded{[&](types::Float const& /*t*/) { return Layout{floatsize, floatsize}; },
+                 [&](types::rAlias const& t) { return getLayout(t.getraw().target); },
+                 [&](types::rTuple const& t) {
+                   Layout res{0, 1};
+                   for (const auto& a : t.getraw().arg_types) {
+                     auto member = getLayout(a);
+                     res.size = align_to(res.size, member.align) + member.size;
+                     res.align = std::max(res.align, member.align);
+                   }
+                   res.size = align_to(res.size, res.align);
+                   return res;
+                 },
+                 [&](types::rArray const& t) {
+                   auto elem = getLayout(t.getraw().elem_type);
+                   return Layout{elem.size * static_cast<size_t>(t.getraw().size), elem.align};
+                 },
+                 [](auto const& /*t*/) { return Layout{sizeof(void*), alignof(void*)}; }},
+      type);
+}
+
 std::string MemoryObjsCollector::indentHelper(int indent) {
   std::string indent_s;
   for (int i = 0; i < indent; i++) { indent_s += " "; }
@@ -169,9 +207,9 @@ ResultT MemoryObjsCollector::CollectMemVisitor::operator()(minst::Fcall& i) {
                               return std::nullopt;
                             },
                             [&](const mir::ExternalSymbol& e) -> opt_objtreeptr {
-                              if (e.name == "delay") {
-                                auto res = std::make_shared<FunObjTree>(
-                                    FunObjTree{i.fname, false, {}, types::getDelayStruct()});
+                              if (e.name == "delay" || e.name == "delayn") {
+                                auto res = std::make_shared<FunObjTree>(FunObjTree{
+                                    i.fname, false, {}, types::getDelayStruct(getDelaySize(i))});
                                 M.result_map.emplace(i.fname, res);
                                 return res;
                               }
@@ -183,7 +221,7 @@ ResultT MemoryObjsCollector::CollectMemVisitor::operator()(minst::Fcall& i) {
                               }
                               return std::nullopt;
                             },
-                            [&](std::shared_ptr<mir::Argument> e) -> opt_objtreeptr {
+                            [&](const mir::Argument& e) -> opt_objtreeptr {
                               // TODO:cannot pass function with memobj like higher order function
                               // currently.
                               return std::nullopt;
@@ -204,6 +242,18 @@ ResultT MemoryObjsCollector::CollectMemVisitor::operator()(minst::Fcall& i) {
   }
   return res;
 }
+// buffer size of delay is decided from the maximum delay time if it is a number literal.
+size_t MemoryObjsCollector::CollectMemVisitor::getDelaySize(minst::Fcall const& i) {
+  const bool isdelayn = std::get<mir::ExternalSymbol>(*i.fname).name == "delayn";
+  const auto& maxtime = isdelayn ? i.args.front() : i.args.back();
+  if (mir::isInstA<minst::Number>(maxtime)) {
+    return types::getDelaySize(mir::getInstRef<minst::Number>(maxtime).val);
+  }
+  if (isdelayn) {
+    throw std::runtime_error("the maximum delay time of delayn must be a number literal");
+  }
+  return types::fixed_delaysize;
+}
 ResultT MemoryObjsCollector::CollectMemVisitor::operator()(minst::MakeClosure& i) {
   return makeResfromHasSelf(false);
 }
@@ -5,6 +5,7 @@
 #pragma once
 #include <unordered_set>
 #include "basic/mir.hpp"
+#include "runtime/runtime_defs.hpp"
 namespace mimium {
 namespace minst = mir::instruction;
 struct FunObjTree {
@@ -18,8 +19,13 @@ using funobjmap = std::unordered_map<mir::valueptr, std::shared_ptr<FunObjTree>>
 
 class MemoryObjsCollector {
  public:
-  MemoryObjsCollector() = default;
+  explicit MemoryObjsCollector(mir::ValuePool& pool) : pool(pool) {}
   funobjmap process(mir::blockptr toplevel);
+  // total bytes of memory objects allocated for toplevel functions in the last process.
+  [[nodiscard]] size_t getFootprint() const { return footprint; }
+  // size of the type lowered by codegen, with the float type of the precision.
+  [[nodiscard]] size_t getSizeInBytes(types::Value const& type) const;
+  void setFloatPrecision(FloatPrecision p) { precision = p; }
 
 #ifdef MIMIUM_DEBUG_BUILD
   void dump() const;
@@ -28,12 +34,20 @@ class MemoryObjsCollector {
 #endif
  private:
   std::shared_ptr<FunObjTree> traverseFunTree(mir::valueptr fun);
+  struct Layout {
+    size_t size;
+    size_t align;
+  };
+  [[nodiscard]] Layout getLayout(types::Value const& type) const;
   static std::string indentHelper(int indent);
   static std::unordered_set<mir::valueptr> collectToplevelFuns(mir::blockptr toplevel);
   static std::optional<mir::valueptr> tryFindFunByName(std::unordered_set<mir::valueptr> fnset,
                                                        std::string const& name);
 
+  mir::ValuePool& pool;
   funobjmap result_map;
+  size_t footprint = 0;
+  FloatPrecision precision = FloatPrecision::F64;
 
  public:
   struct CollectMemVisitor {
@@ -83,8 +97,9 @@ class MemoryObjsCollector {
    private:
     static bool isSelf(mir::valueptr val) { return std::holds_alternative<mir::Self>(*val); };
     static bool isExternalFunMemobj(const mir::ExternalSymbol& s) {
-      return s.name == "delay" || s.name == "mem";
+      return s.name == "delay" || s.name == "delayn" || s.name == "mem";
     }
+    static size_t getDelaySize(minst::Fcall const& i);
     static ResultT makeResfromHasSelf(bool hasself);
     static void mergeResultTs(ResultT& dest, ResultT& src);
   };
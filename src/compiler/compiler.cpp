@@ -4,26 +4,25 @@
 
 #include "compiler/compiler.hpp"
 #include "codegen/llvm_header.hpp"
+#include "llvm/Support/xxhash.h"
 #include "compiler/scanner.hpp"
 
 namespace mimium {
 Compiler::Compiler()
     : llvmctx(std::make_unique<llvm::LLVMContext>()),
       driver(),
-      symbolrenamer(std::make_shared<RenameEnvironment>()),
       typeinferer(),
-      mirgenerator(typeinferer.getTypeEnv()),
-      closureconverter(std::make_shared<ClosureConverter>(typeinferer.getTypeEnv())),
-      memobjcollector(),
+      mirgenerator(typeinferer.getTypeEnv(), mirpool),
+      closureconverter(std::make_shared<ClosureConverter>(typeinferer.getTypeEnv(), mirpool)),
+      memobjcollector(mirpool),
       llvmgenerator(*llvmctx) {}
 Compiler::Compiler(std::unique_ptr<llvm::LLVMContext> ctx)
     : llvmctx(std::move(ctx)),
       driver(),
-      symbolrenamer(std::make_shared<RenameEnvironment>()),
       typeinferer(),
-      mirgenerator(typeinferer.getTypeEnv()),
-      closureconverter(std::make_shared<ClosureConverter>(typeinferer.getTypeEnv())),
-      memobjcollector(),
+      mirgenerator(typeinferer.getTypeEnv(), mirpool),
+      closureconverter(std::make_shared<ClosureConverter>(typeinferer.getTypeEnv(), mirpool)),
+      memobjcollector(mirpool),
       llvmgenerator(*ctx) {}
 Compiler::~Compiler() = default;
 void Compiler::setFilePath(std::string path) {
@@ -32,25 +31,54 @@ void Compiler::setFilePath(std::string path) {
 }
 void Compiler::setDataLayout(const llvm::DataLayout& dl) { llvmgenerator.setDataLayout(dl); }
 
-AstPtr Compiler::loadSource(std::istream& source) { return driver.parse(source); }
+std::optional<uint64_t> Compiler::getSourceHash() const {
+  if (!source_hash || llvmgenerator.getFloatPrecision() == FloatPrecision::F64) {
+    return source_hash;
+  }
+  return llvm::xxHash64(std::to_string(source_hash.value()) + "-f32");
+}
+
+AstPtr Compiler::loadSource(std::istream& source) {
+  PassTimer::Scope t(passtimer, "compiler", "parse");
+  return driver.parse(source);
+}
 
 AstPtr Compiler::loadSource(const std::string& source) {
-  AstPtr ast = driver.parseString(source);
+  PassTimer::Scope t(passtimer, "compiler", "parse");
+  source_hash = llvm::xxHash64(source);
+  AstPtr ast = astcache != nullptr ? astcache->parse(driver, source) : driver.parseString(source);
   return ast;
 }
 AstPtr Compiler::loadSourceFile(const std::string& filename) {
+  PassTimer::Scope t(passtimer, "compiler", "parse");
   AstPtr ast = driver.parseFile(filename);
   return ast;
 }
-AstPtr Compiler::renameSymbols(AstPtr ast) { return symbolrenamer.rename(*ast); }
-TypeEnv& Compiler::typeInfer(AstPtr ast) { return typeinferer.infer(*ast); }
+AstPtr Compiler::renameSymbols(AstPtr ast) {
+  PassTimer::Scope t(passtimer, "compiler", "rename symbols");
+  return symbolrenamer.rename(*ast);
+}
+TypeEnv& Compiler::typeInfer(AstPtr ast) {
+  PassTimer::Scope t(passtimer, "compiler", "type inference");
+  return typeinferer.infer(*ast);
+}
 
-mir::blockptr Compiler::generateMir(AstPtr ast) { return mirgenerator.generate(*ast); }
-mir::blockptr Compiler::closureConvert(mir::blockptr mir) { return closureconverter->convert(mir); }
+mir::blockptr Compiler::generateMir(AstPtr ast) {
+  PassTimer::Scope t(passtimer, "compiler", "mir generation");
+  return mirgenerator.generate(*ast);
+}
+mir::blockptr Compiler::closureConvert(mir::blockptr mir) {
+  PassTimer::Scope t(passtimer, "compiler", "closure conversion");
+  return closureconverter->convert(mir);
+}
 
-funobjmap Compiler::collectMemoryObjs(mir::blockptr mir) { return memobjcollector.process(mir); }
+funobjmap Compiler::collectMemoryObjs(mir::blockptr mir) {
+  PassTimer::Scope t(passtimer, "compiler", "collect memory objects");
+  return memobjcollector.process(mir);
+}
 
 llvm::Module& Compiler::generateLLVMIr(mir::blockptr mir, funobjmap const& funobjs) {
+  PassTimer::Scope t(passtimer, "compiler", "llvm ir generation");
   llvmgenerator.generateCode(mir, &funobjs);
   return llvmgenerator.getModule();
 }
@@ -63,5 +91,11 @@ void Compiler::dumpLLVMModule(std::ostream& out) {
   llvmgenerator.getModule().print(tmpout, nullptr);
   out << str;
 }
+void Compiler::emitObjectFile(fs::path const& path, OptimizeLevel level) {
+  mimium::emitObjectFile(llvmgenerator.getModule(), path, level, passtimer);
+}
+void Compiler::emitSharedObject(fs::path const& path, OptimizeLevel level) {
+  mimium::emitSharedObject(llvmgenerator.getModule(), path, level, passtimer);
+}
 
 }  // namespace mimium
\ No newline at end of file
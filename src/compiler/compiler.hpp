@@ -5,15 +5,19 @@
 #pragma once
 
 #include "export.hpp"
+#include "utils/include_filesystem.hpp"
 
 #include "basic/ast.hpp"
 #include "basic/helper_functions.hpp"
 #include "basic/mir.hpp"
+#include "basic/pass_timer.hpp"
 #include "basic/type.hpp"
 
+#include "compiler/ast_cache.hpp"
 #include "compiler/ast_loader.hpp"
 #include "compiler/closure_convert.hpp"
 #include "compiler/codegen/llvmgenerator.hpp"
+#include "compiler/codegen/object_emitter.hpp"
 #include "compiler/collect_memoryobjs.hpp"
 #include "compiler/mirgenerator.hpp"
 #include "compiler/symbolrenamer.hpp"
@@ -30,9 +34,22 @@ class MIMIUM_DLL_PUBLIC Compiler {
   AstPtr loadSource(std::istream& source);
   AstPtr loadSource(const std::string& source);
   AstPtr loadSourceFile(const std::string& filename);
+  // hash of the source loaded last time through loadSource(string), used as a key of jit cache.
+  // float precision is mixed in since it changes the generated code.
+  [[nodiscard]] std::optional<uint64_t> getSourceHash() const;
   void setFilePath(std::string path);
+  void setFloatPrecision(FloatPrecision p) {
+    memobjcollector.setFloatPrecision(p);
+    llvmgenerator.setFloatPrecision(p);
+  }
   void setDataLayout(const llvm::DataLayout& dl);
   void setDataLayout();
+  // measure each stage for --time-passes. null disables it.
+  void setPassTimer(PassTimer* timer) { passtimer = timer; }
+  [[nodiscard]] PassTimer* getPassTimer() const { return passtimer; }
+  // reuse top-level definitions parsed by previous compilers in loadSource(string). null disables
+  // it.
+  void setAstCache(AstCache* cache) { astcache = cache; }
 
   AstPtr renameSymbols(AstPtr ast);
   TypeEnv& typeInfer(AstPtr ast);
@@ -42,6 +59,9 @@ class MIMIUM_DLL_PUBLIC Compiler {
 
   llvm::Module& generateLLVMIr(mir::blockptr mir, funobjmap const& funobjs);
   void dumpLLVMModule(std::ostream& out);
+  // ahead-of-time compilation of the generated module for host machine.
+  void emitObjectFile(fs::path const& path, OptimizeLevel level = OptimizeLevel::O2);
+  void emitSharedObject(fs::path const& path, OptimizeLevel level = OptimizeLevel::O2);
   std::unique_ptr<llvm::LLVMContext> moveLLVMCtx();
   std::unique_ptr<llvm::Module> moveLLVMModule() ;
 
@@ -50,11 +70,16 @@ class MIMIUM_DLL_PUBLIC Compiler {
   Driver driver;
   SymbolRenamer symbolrenamer;
   TypeInferer typeinferer;
+  // owns mir until the compiler is destroyed.
+  mir::ValuePool mirpool;
   MirGenerator mirgenerator;
   std::shared_ptr<ClosureConverter> closureconverter;
   MemoryObjsCollector memobjcollector;
   LLVMGenerator llvmgenerator;
   std::string path;
+  std::optional<uint64_t> source_hash = std::nullopt;
+  PassTimer* passtimer = nullptr;
+  AstCache* astcache = nullptr;
 };
 
 }  // namespace mimium
\ No newline at end of file
@@ -4,15 +4,23 @@
 
 #include "compiler/ffi.hpp"
 #include <cmath>
+#include <type_traits>
+#include "basic/rt_logger.hpp"
 #include "sndfile.h"
 
 extern "C"{
 MIMIUM_DLL_PUBLIC void dumpaddress(void* a) { std::cerr << a << "\n"; }
 
-MIMIUM_DLL_PUBLIC void printdouble(double d) { std::cout << d; }
-MIMIUM_DLL_PUBLIC void printlndouble(double d) { std::cout << d << "\n"; }
+// print functions may be called from dsp, so the output is written through the real-time safe
+// logger. "%g" formats in the same way as std::ostream.
+MIMIUM_DLL_PUBLIC void printdouble(double d) { mimium::RtLogger::getStdout().print("%g", d); }
+MIMIUM_DLL_PUBLIC void printlndouble(double d) { mimium::RtLogger::getStdout().print("%g\n", d); }
 
-MIMIUM_DLL_PUBLIC void printlnstr(char* str) { std::cout << str << "\n"; }
+MIMIUM_DLL_PUBLIC void printlnstr(char* str) {
+  auto& out = mimium::RtLogger::getStdout();
+  out.write(str);
+  out.write("\n");
+}
 
 MIMIUM_DLL_PUBLIC double mimiumrand() { return ((double)rand() / RAND_MAX) * 2 - 1; }
 
@@ -45,25 +53,72 @@ MIMIUM_DLL_PUBLIC double access_array_lin_interp(double* array, double index_d)
   if (fract == 0) { return array[index]; }
   return array[index] * (1 - fract) + array[index + 1] * fract;
 }
+MIMIUM_DLL_PUBLIC float access_array_lin_interp_f32(float* array, float index_f) {
+  float fract = fmodf(index_f, 1.000F);
+  size_t index = floorf(index_f);
+  if (fract == 0) { return array[index]; }
+  return array[index] * (1 - fract) + array[index + 1] * fract;
+}
+}
+
+namespace {
+// indices share the width of float type, as the header fields are typed as float.
+// Only the buffer of fixed_delaysize can be passed. codegen emits delay inline with the buffer
+// sized for each call, and a delay with @ operator is a type error(timed call must be void).
+template <typename T, typename IndexT>
 struct MmmRingBuf {
-  // int64_t size=5000;
-  int64_t readi = 0;
-  int64_t writei = 0;
-  double buf[mimium::types::fixed_delaysize]{};
+  IndexT readi = 0;
+  IndexT writei = 0;
+  T buf[mimium::types::fixed_delaysize]{};
 };
-
-MIMIUM_DLL_PUBLIC double mimium_memprim(double in, double* valptr){
-  auto res= *valptr;
+template <typename T>
+T memprim(T in, T* valptr) {
+  auto res = *valptr;
   *valptr = in;
   return res;
 }
-MIMIUM_DLL_PUBLIC double mimium_delayprim(double in, double time, MmmRingBuf* rbuf) {
-  auto size = sizeof(rbuf->buf) / sizeof(double);
-  rbuf->writei = (rbuf->writei + 1) % size;
-  double readi = fmod((size + rbuf->writei - time), size);
-  rbuf->readi = (int64_t)readi;
+template <typename T, typename IndexT>
+T delayprim(T in, T time, MmmRingBuf<T, IndexT>* rbuf) {
+  constexpr IndexT mask = mimium::types::fixed_delaysize - 1;
+  rbuf->writei = (rbuf->writei + 1) & mask;
   rbuf->buf[rbuf->writei] = in;
-  return access_array_lin_interp(rbuf->buf, readi);
+  auto timei = static_cast<IndexT>(time);
+  T fract = time - static_cast<T>(timei);
+  rbuf->readi = (rbuf->writei - timei) & mask;
+  T s0 = rbuf->buf[rbuf->readi];
+  T s1 = rbuf->buf[(rbuf->writei - timei - 1) & mask];
+  return s0 + (s1 - s0) * fract;
+}
+template <typename T>
+T* loadwav(char* filename) {
+  SF_INFO sfinfo;
+  auto* sfile = sf_open(filename, SFM_READ, &sfinfo);
+  if (sfile == nullptr) { std::cerr << sf_strerror(sfile) << "\n"; }
+
+  const int bufsize = sfinfo.frames * sfinfo.channels;
+  T* buffer = new T[bufsize];
+  if constexpr (std::is_same_v<T, float>) {
+    sf_readf_float(sfile, buffer, bufsize);
+  } else {
+    sf_readf_double(sfile, buffer, bufsize);
+  }
+  // sf_close(sfile);
+  // std::cerr<< filename << "(" << size << ") is succecfully loaded";
+  return buffer;
+}
+}  // namespace
+
+extern "C" {
+MIMIUM_DLL_PUBLIC double mimium_memprim(double in, double* valptr) { return memprim(in, valptr); }
+MIMIUM_DLL_PUBLIC float mimium_memprim_f32(float in, float* valptr) { return memprim(in, valptr); }
+// codegen emits the equivalent IR inline(CodeGenVisitor::createDelayPrim). kept for ffi.
+MIMIUM_DLL_PUBLIC double mimium_delayprim(double in, double time,
+                                          MmmRingBuf<double, int64_t>* rbuf) {
+  return delayprim(in, time, rbuf);
+}
+MIMIUM_DLL_PUBLIC float mimium_delayprim_f32(float in, float time,
+                                             MmmRingBuf<float, int32_t>* rbuf) {
+  return delayprim(in, time, rbuf);
 }
 
 MIMIUM_DLL_PUBLIC double libsndfile_loadwavsize(char* filename) {
@@ -75,18 +130,8 @@ MIMIUM_DLL_PUBLIC double libsndfile_loadwavsize(char* filename) {
   return res;
 }
 
-MIMIUM_DLL_PUBLIC double* libsndfile_loadwav(char* filename) {
-  SF_INFO sfinfo;
-  auto* sfile = sf_open(filename, SFM_READ, &sfinfo);
-  if (sfile == nullptr) { std::cerr << sf_strerror(sfile) << "\n"; }
-
-  const int bufsize = sfinfo.frames * sfinfo.channels;
-  double* buffer = new double[bufsize];
-  sf_readf_double(sfile, buffer, bufsize);
-  // sf_close(sfile);
-  // std::cerr<< filename << "(" << size << ") is succecfully loaded";
-  return buffer;
-}
+MIMIUM_DLL_PUBLIC double* libsndfile_loadwav(char* filename) { return loadwav<double>(filename); }
+MIMIUM_DLL_PUBLIC float* libsndfile_loadwav_f32(char* filename) { return loadwav<float>(filename); }
 }
 
 namespace mimium {
@@ -97,38 +142,40 @@ const std::unordered_map<std::string, BuiltinFnInfo> LLVMBuiltin::ftable = {
     {"println", initBI(Function{Void{}, {Float{}}}, "printlndouble")},
     {"printlnstr", initBI(Function{Void{}, {String{}}}, "printlnstr")},
 
-    {"sin", initBI(Function{Float{}, {Float{}}}, "sin")},
-    {"cos", initBI(Function{Float{}, {Float{}}}, "cos")},
-    {"tan", initBI(Function{Float{}, {Float{}}}, "tan")},
+    {"sin", initBI(Function{Float{}, {Float{}}}, "sin", "sinf")},
+    {"cos", initBI(Function{Float{}, {Float{}}}, "cos", "cosf")},
+    {"tan", initBI(Function{Float{}, {Float{}}}, "tan", "tanf")},
 
-    {"asin", initBI(Function{Float{}, {Float{}}}, "asin")},
-    {"acos", initBI(Function{Float{}, {Float{}}}, "acos")},
-    {"atan", initBI(Function{Float{}, {Float{}}}, "atan")},
-    {"atan2", initBI(Function{Float{}, {Float{}, Float{}}}, "atan2")},
+    {"asin", initBI(Function{Float{}, {Float{}}}, "asin", "asinf")},
+    {"acos", initBI(Function{Float{}, {Float{}}}, "acos", "acosf")},
+    {"atan", initBI(Function{Float{}, {Float{}}}, "atan", "atanf")},
+    {"atan2", initBI(Function{Float{}, {Float{}, Float{}}}, "atan2", "atan2f")},
 
-    {"sinh", initBI(Function{Float{}, {Float{}}}, "sinh")},
-    {"cosh", initBI(Function{Float{}, {Float{}}}, "cosh")},
-    {"tanh", initBI(Function{Float{}, {Float{}}}, "tanh")},
-    {"exp", initBI(Function{Float{}, {Float{}}}, "exp")},
-    {"pow", initBI(Function{Float{}, {Float{}, Float{}}}, "pow")},
+    {"sinh", initBI(Function{Float{}, {Float{}}}, "sinh", "sinhf")},
+    {"cosh", initBI(Function{Float{}, {Float{}}}, "cosh", "coshf")},
+    {"tanh", initBI(Function{Float{}, {Float{}}}, "tanh", "tanhf")},
+    {"exp", initBI(Function{Float{}, {Float{}}}, "exp", "expf")},
+    {"pow", initBI(Function{Float{}, {Float{}, Float{}}}, "pow", "powf")},
 
-    {"log", initBI(Function{Float{}, {Float{}}}, "log")},
-    {"log10", initBI(Function{Float{}, {Float{}}}, "log10")},
+    {"log", initBI(Function{Float{}, {Float{}}}, "log", "logf")},
+    {"log10", initBI(Function{Float{}, {Float{}}}, "log10", "log10f")},
     {"random", initBI(Function{Float{}, {}}, "mimiumrand")},
+    // index of the voice rendered by dsp with --voices, 0 otherwise.
+    {"voiceindex", initBI(Function{Float{}, {}}, "mimium_getvoiceindex")},
 
-    {"sqrt", initBI(Function{Float{}, {Float{}}}, "sqrt")},
-    {"abs", initBI(Function{Float{}, {Float{}}}, "fabs")},
+    {"sqrt", initBI(Function{Float{}, {Float{}}}, "sqrt", "sqrtf")},
+    {"abs", initBI(Function{Float{}, {Float{}}}, "fabs", "fabsf")},
 
-    {"ceil", initBI(Function{Float{}, {Float{}}}, "ceil")},
-    {"floor", initBI(Function{Float{}, {Float{}}}, "floor")},
-    {"trunc", initBI(Function{Float{}, {Float{}}}, "trunc")},
-    {"round", initBI(Function{Float{}, {Float{}}}, "round")},
+    {"ceil", initBI(Function{Float{}, {Float{}}}, "ceil", "ceilf")},
+    {"floor", initBI(Function{Float{}, {Float{}}}, "floor", "floorf")},
+    {"trunc", initBI(Function{Float{}, {Float{}}}, "trunc", "truncf")},
+    {"round", initBI(Function{Float{}, {Float{}}}, "round", "roundf")},
 
-    {"fmod", initBI(Function{Float{}, {Float{}, Float{}}}, "fmod")},
-    {"remainder", initBI(Function{Float{}, {Float{}, Float{}}}, "remainder")},
+    {"fmod", initBI(Function{Float{}, {Float{}, Float{}}}, "fmod", "fmodf")},
+    {"remainder", initBI(Function{Float{}, {Float{}, Float{}}}, "remainder", "remainderf")},
 
-    {"min", initBI(Function{Float{}, {Float{}, Float{}}}, "fmin")},
-    {"max", initBI(Function{Float{}, {Float{}, Float{}}}, "fmax")},
+    {"min", initBI(Function{Float{}, {Float{}, Float{}}}, "fmin", "fminf")},
+    {"max", initBI(Function{Float{}, {Float{}, Float{}}}, "fmax", "fmaxf")},
 
     {"ge", initBI(Function{Float{}, {Float{}, Float{}}}, "mimium_ge")},
     {"eq", initBI(Function{Float{}, {Float{}, Float{}}}, "mimium_eq")},
@@ -143,14 +190,20 @@ const std::unordered_map<std::string, BuiltinFnInfo> LLVMBuiltin::ftable = {
     {"lshift", initBI(Function{Float{}, {Float{}, Float{}}}, "mimium_lshift")},
     {"rshift", initBI(Function{Float{}, {Float{}, Float{}}}, "mimium_rshift")},
 
-    {"mem", initBI(Function{Float{}, {Float{}}}, "mimium_memprim")},
-    {"delay", initBI(Function{Float{}, {Float{}, Float{}}}, "mimium_delayprim")},
+    {"mem", initBI(Function{Float{}, {Float{}}}, "mimium_memprim", "mimium_memprim_f32")},
+    {"delay",
+     initBI(Function{Float{}, {Float{}, Float{}}}, "mimium_delayprim", "mimium_delayprim_f32")},
+    // delayn(maxtime,input,time). maxtime must be a number literal. always emitted inline.
+    {"delayn", initBI(Function{Float{}, {Float{}, Float{}, Float{}}}, "mimium_delayprim",
+                      "mimium_delayprim_f32")},
 
     {"loadwavsize", initBI(Function{Float{}, {String{}}}, "libsndfile_loadwavsize")},
-    {"loadwav", initBI(Function{Array{Float{}, 0}, {String{}}}, "libsndfile_loadwav")},
+    {"loadwav", initBI(Function{Array{Float{}, 0}, {String{}}}, "libsndfile_loadwav",
+                       "libsndfile_loadwav_f32")},
 
     {"access_array_lin_interp",
-     initBI(Function{Float{}, {Float{}, Float{}}}, "access_array_lin_interp")}
+     initBI(Function{Float{}, {Float{}, Float{}}}, "access_array_lin_interp",
+            "access_array_lin_interp_f32")}
 
 };
 
@@ -16,10 +16,12 @@ namespace mimium {
 struct BuiltinFnInfo {
   types::Value mmmtype;
   std::string target_fnname;
+  // used in single precision mode if not empty. otherwise target_fnname is called with double.
+  std::string target_fnname_f32;
 };
 
-inline BuiltinFnInfo initBI(types::Function&& f, std::string&& s) {
-  return BuiltinFnInfo{std::move(f), std::move(s)};
+inline BuiltinFnInfo initBI(types::Function&& f, std::string&& s, std::string&& s_f32 = "") {
+  return BuiltinFnInfo{std::move(f), std::move(s), std::move(s_f32)};
 }
 
 struct MIMIUM_DLL_PUBLIC LLVMBuiltin {
@@ -111,7 +111,7 @@ namespace mimium{
 ;
 // %token <double> NOW "now_token"
 %token <mmmfloat> NUM "number_token"
-%token  <std::string> SYMBOL "symbol_token"
+%token  <SymbolId> SYMBOL "symbol_token"
 
 %token  SELF "self_token"
 %token  <std::string> STRING "string_token"
@@ -204,6 +204,9 @@ namespace mimium{
 
 
 %locations
+%initial-action {
+  @$.begin.line = @$.end.line = driver.getFirstLine();
+}
 
 
 %nonassoc COND
@@ -284,7 +287,7 @@ lvar: declvar    { $$ = std::move($1);}
 
 symbol: SYMBOL {
             @$ = @1;
-            $$ = ast::Symbol{{@$,$1} ,$1};}
+            $$ = ast::Symbol{{@$,$1.str()} ,$1};}
 
 self: SELF {
             @$ = @1;
@@ -310,7 +313,7 @@ structtype: LBRACE strutypeargs RBRACE { $$ = types::Struct{std::move($2)}; }
 
 strutypeargs : strutypeargs ',' strutypearg { $1.emplace_back(std::move($3));$$ = std::move($1); }
             | strutypearg {$$ = std::vector<types::Struct::Keytype>{$1}; }
-strutypearg : SYMBOL TYPE_DELIM types { $$ = types::Struct::Keytype{std::move($1),std::move($3)}; }
+strutypearg : SYMBOL TYPE_DELIM types { $$ = types::Struct::Keytype{$1.str(),std::move($3)}; }
 
 types: 
         primtypes  { $$=std::move($1);}
@@ -318,11 +321,11 @@ types:
       | fntype     { $$=std::move($1);}
       | tupletype  { $$=std::move($1);}
       | structtype { $$=std::move($1);}
-      | SYMBOL     { $$=types::Alias{std::move($1),types::None{}};}
+      | SYMBOL     { $$=types::Alias{$1.str(),types::None{}};}
 
 // Type Declaration
 
-typedecl: TYPEIDENT SYMBOL ASSIGN types {$$ = ast::TypeAssign{{@$,"typeassign"},std::move($2),std::move($4)}; }
+typedecl: TYPEIDENT SYMBOL ASSIGN types {$$ = ast::TypeAssign{{@$,"typeassign"},$2.str(),std::move($4)}; }
 
 // Expression Section
 // temporarily debug symbol for aggregate ast is disabled
@@ -384,9 +387,9 @@ array_access: expr '[' expr ']' {
       // @$ = {@1.first_line,@1.first_col,@4.last_line,@4.last_col};
       $$ = ast::ArrayAccess{{@$,"arrayaccess"},std::move($1),std::move($3)};}
 
-structconstruct: SYMBOL LBRACE tupleargs RBRACE {$$ =ast::Struct{{@$,"struct"},std::move($1),std::move($3)};}
-            |SYMBOL LBRACE expr RBRACE  {$$ =ast::Struct{{@$,"struct"},std::move($1),std::deque<ast::ExprPtr>{std::move($3)}};}
-structaccess: expr '.' SYMBOL {$$ = ast::StructAccess{{@$,"structaccess"},std::move($1),std::move($3)};}
+structconstruct: SYMBOL LBRACE tupleargs RBRACE {$$ =ast::Struct{{@$,"struct"},$1.str(),std::move($3)};}
+            |SYMBOL LBRACE expr RBRACE  {$$ =ast::Struct{{@$,"struct"},$1.str(),std::deque<ast::ExprPtr>{std::move($3)}};}
+structaccess: expr '.' SYMBOL {$$ = ast::StructAccess{{@$,"structaccess"},std::move($1),$3.str()};}
 
 tupleargs: expr ',' expr {$$ = std::deque<ast::ExprPtr>{std::move($1),std::move($3)};}
       |     tupleargs ',' expr {$1.emplace_back(std::move($3));
@@ -524,6 +527,7 @@ forloop: FOR '(' declvar IN expr ')' block {$$ = ast::For{{@$,"for"},std::move($
 void 
 MimiumParser::error( const location_type &l, const std::string &err_message )
 {
+      if (!driver.isReportingErrors()) { return; }
        std::stringstream ss;
       ss  << err_message << " at " << l.begin.line <<  ":" << l.begin.col << " to " << l.end.line <<  ":" << l.end.col << "\n";
       mimium::Logger::debug_log(ss.str(),mimium::Logger::ERROR_);
@@ -16,26 +16,29 @@ mir::blockptr MirGenerator::generate(ast::Statements& topast) {
 
 std::string MirGenerator::makeNewName() { return "k" + std::to_string(varcounter++); }
 
-mir::valueptr MirGenerator::getOrGenExternalSymbol(std::string const& name,
-                                                   types::Value const& type) {
-  auto [iter, res] = external_symbols.try_emplace(
-      name, std::make_shared<mir::Value>(mir::ExternalSymbol{name, type}));
-  return iter->second;
+mir::valueptr MirGenerator::getOrGenExternalSymbol(SymbolId name, types::Value const& type) {
+  auto iter = external_symbols.find(name);
+  if (iter != external_symbols.end()) { return iter->second; }
+  return external_symbols.emplace(name, pool.make(mir::ExternalSymbol{name, type})).first->second;
 }
 
 mir::valueptr MirGenerator::require(optvalptr const& v) {
   if (auto res = v.value_or(nullptr)) { return res; }
   throw std::runtime_error("mir generation error: reference to value does not exist");
 }
-optvalptr MirGenerator::tryGetInternalSymbol(std::string const& name) {
+optvalptr MirGenerator::tryGetInternalSymbol(SymbolId name) {
   auto iter = symbol_table.find(name);
   return (iter != symbol_table.cend()) ? std::optional(iter->second) : std::nullopt;
 }
-mir::valueptr MirGenerator::getFunctionSymbol(std::string const& name, types::Value const& type) {
+optvalptr MirGenerator::tryGetVariablePtr(SymbolId name) {
+  auto iter = variable_ptrs.find(name);
+  return (iter != variable_ptrs.cend()) ? std::optional(iter->second) : std::nullopt;
+}
+mir::valueptr MirGenerator::getFunctionSymbol(SymbolId name, types::Value const& type) {
   auto res = tryGetInternalSymbol(name);
   return res.value_or(getOrGenExternalSymbol(name, type));
 }
-mir::valueptr MirGenerator::getInternalSymbol(std::string const& name) {
+mir::valueptr MirGenerator::getInternalSymbol(SymbolId name) {
   auto res = tryGetInternalSymbol(name);
   if (!res.has_value()) {
     throw std::runtime_error(" mir generation error: failed to resolve symbol name " + name);
@@ -51,7 +54,7 @@ namespace minst = mir::instruction;
 std::pair<optvalptr, mir::blockptr> MirGenerator::generateBlock(ast::Block& block,
                                                                 std::string label,
                                                                 optvalptr const& fnctx) {
-  auto blockctx = mir::makeBlock(label, indent_counter++);
+  auto blockctx = pool.makeBlock(label, indent_counter++);
   blockctx->parent = fnctx;
   ExprKnormVisitor exprvisitor(*this, blockctx, fnctx);
   auto retptr = exprvisitor(block);
@@ -66,7 +69,7 @@ bool MirGenerator::isPassByValue(types::Value const& type) {
 }
 
 mir::valueptr ExprKnormVisitor::emplace(mir::Instructions&& inst) {
-  return mir::addInstToBlock(std::move(inst), this->block);
+  return mirgen.pool.addInstToBlock(std::move(inst), this->block);
 }
 
 mir::valueptr ExprKnormVisitor::genAllocate(std::string const& name, types::Value const& type) {
@@ -87,7 +90,8 @@ mir::valueptr ExprKnormVisitor::operator()(ast::String& ast) {
   return emplace(minst::String{{mirgen.makeNewName(), types::String{}}, ast.value});
 }
 mir::valueptr ExprKnormVisitor::operator()(ast::Symbol& ast) {
-  if (ast.value == "now") {  // todo: handle external symbols other than functions?
+  static const SymbolId now_sym = "now";
+  if (ast.value == now_sym) {  // todo: handle external symbols other than functions?
     return emplace(minst::Fcall{{mirgen.makeNewName(), types::Float{}},
                                 mirgen.getOrGenExternalSymbol("mimium_getnow", types::Float{}),
                                 {},
@@ -95,14 +99,14 @@ mir::valueptr ExprKnormVisitor::operator()(ast::Symbol& ast) {
                                 std::nullopt});
   }
 
-  if (auto ptrtoload = mirgen.tryGetInternalSymbol(ast.value + "_ptr")) {
+  if (auto ptrtoload = mirgen.tryGetVariablePtr(ast.value)) {
     auto type = mir::getType(*ptrtoload.value());
     assert(types::isPointer(type));
     auto vtype = rv::get<types::Pointer>(type).val;
     return emplace(minst::Load{{mirgen.makeNewName(), vtype}, ptrtoload.value()});
   }
   if (auto arg = mirgen.tryGetInternalSymbol(ast.value)) {
-    bool is_argument = std::holds_alternative<std::shared_ptr<mir::Argument>>(*arg.value());
+    bool is_argument = std::holds_alternative<mir::Argument>(*arg.value());
     bool is_function = mir::isInstA<minst::Function>(arg.value());
     MMMASSERT(is_argument || is_function,
               "failed to find symbol. Internal symbols should be a pointer for value, argument or "
@@ -119,24 +123,25 @@ mir::valueptr ExprKnormVisitor::operator()(ast::Self& /*ast*/) {
   // todo: create special type for self
   MMMASSERT(fnctx.has_value(), "Self cannot used in global context");
   auto self = mir::Self{fnctx.value(), types::Float{}};
-  return std::make_shared<mir::Value>(std::move(self));
+  return mirgen.pool.make(std::move(self));
 }
 mir::valueptr ExprKnormVisitor::operator()(ast::Lambda& ast) {
   auto label = lvar_holder.has_value() ? lvar_holder.value() : mirgen.makeNewName();
   auto fun = minst::Function{
       {label, types::None{}},
-      mir::FnArgs{std::nullopt, fmap<std::deque, std::list>(ast.args.args, mirgen.make_arguments)}};
+      mir::FnArgs{std::nullopt, fmap<std::deque, std::vector>(ast.args.args, mirgen.make_arguments)}};
   auto resptr = emplace(std::move(fun));
   auto [blockret, body] = mirgen.generateBlock(ast.body, label, resptr);
   auto rettype = blockret ? getType(*blockret.value()) : types::Void{};
   auto& fref = mir::getInstRef<minst::Function>(resptr);
 
   for (auto& a : fref.args.args) {
-    a->type = mir::lowerType(a->type);
-    a->parentfn = resptr;
+    auto& arg = std::get<mir::Argument>(*a);
+    arg.type = mir::lowerType(arg.type);
+    arg.parentfn = resptr;
   }
   auto srctype = types::Function{
-      rettype, fmap<std::list, std::vector>(fref.args.args, [](auto a) { return a->type; })};
+      rettype, fmap(fref.args.args, [](mir::valueptr a) { return mir::getType(*a); })};
   fref.type = mir::lowerType(srctype);
 
   fref.body = body;
@@ -152,16 +157,15 @@ mir::valueptr ExprKnormVisitor::operator()(ast::Lambda& ast) {
   // lifetime management).
   if (!types::isA<types::Void>(rettype) && (!isPassByValue(rettype) || ptrtype != nullptr)) {
     auto& retval = mir::getInstRef<minst::Return>(*retinst_iter).val;
-    auto loadinst = mir::addInstToBlock(minst::Load{{label + "_res", rettype}, retval}, fref.body);
-    // auto loadinst2 = mir::addInstToBlock(minst::Load{{label + "_res", rettype}, loadinst},
-    // fref.body);
-    fref.args.ret_ptr = std::make_shared<mir::Argument>(
-        mir::Argument{label + "_retptr", mir::lowerType(rettype), resptr});
     fref.body->instructions.erase(retinst_iter);
-    mir::addInstToBlock(minst::Store{{"store", types::Void{}},
-                                     std::make_shared<mir::Value>(fref.args.ret_ptr.value()),
-                                     loadinst},
-                        fref.body);
+    auto& pool = mirgen.pool;
+    auto loadinst = pool.addInstToBlock(minst::Load{{label + "_res", rettype}, retval}, fref.body);
+    // auto loadinst2 = pool.addInstToBlock(minst::Load{{label + "_res", rettype}, loadinst},
+    // fref.body);
+    fref.args.ret_ptr =
+        pool.make(mir::Argument{label + "_retptr", mir::lowerType(rettype), resptr});
+    pool.addInstToBlock(
+        minst::Store{{"store", types::Void{}}, fref.args.ret_ptr.value(), loadinst}, fref.body);
   }
   return resptr;
 }
@@ -172,7 +176,7 @@ mir::valueptr ExprKnormVisitor::genFcallInst(ast::Fcall& fcall, optvalptr const&
     auto& name = fnlabel->value;
     if (fnctx.has_value()) {
       auto& cur_fn = mir::getInstRef<minst::Function>(fnctx.value());
-      cur_fn.isrecursive |= name == cur_fn.name;
+      cur_fn.isrecursive |= name.str() == cur_fn.name;
       is_fn_recursive = cur_fn.isrecursive;
     }
     fnptr = is_fn_recursive ? this->fnctx.value()
@@ -184,7 +188,7 @@ mir::valueptr ExprKnormVisitor::genFcallInst(ast::Fcall& fcall, optvalptr const&
   bool is_fn_ext = std::holds_alternative<mir::ExternalSymbol>(*fnptr);
   auto fnkind = is_fn_ext && !is_fn_recursive ? EXTERNAL : CLOSURE;
   auto args =
-      fmap<std::deque, std::list>(fcall.args.args, [&](auto expr) { return genInst(expr); });
+      fmap<std::deque, std::vector>(fcall.args.args, [&](auto expr) { return genInst(expr); });
   types::Value rettype = types::None{};
   if (!is_fn_recursive) {
     std::optional<types::rFunction> ftype_opt;
@@ -199,16 +203,16 @@ mir::valueptr ExprKnormVisitor::genFcallInst(ast::Fcall& fcall, optvalptr const&
     const bool isreturnbypointer = mir::isInstA<minst::Function>(fnptr) &&
                                    mir::getInstRef<minst::Function>(fnptr).args.ret_ptr;
     const bool isreturnbypointer_hof =
-        std::holds_alternative<std::shared_ptr<mir::Argument>>(*fnptr) &&
+        std::holds_alternative<mir::Argument>(*fnptr) &&
         types::isAggregate(rettype);
     if (isreturnbypointer || isreturnbypointer_hof) {
       if (isreturnbypointer) {
-        rettype = mir::getType(mir::getInstRef<minst::Function>(fnptr).args.ret_ptr.value());
+        rettype = mir::getType(*mir::getInstRef<minst::Function>(fnptr).args.ret_ptr.value());
       }
       if (isreturnbypointer_hof) { rettype = types::makePointer(rettype); }
       assert(types::getIf<types::rPointer>(rettype).has_value());
       auto res_ptr = emplace(minst::Allocate{{newname + "_res", rettype}});
-      args.push_front(res_ptr);
+      args.insert(args.begin(), res_ptr);
       emplace(minst::Fcall{{newname, types::Void{}}, fnptr, args, fnkind, when});
       return res_ptr;
     }
@@ -237,7 +241,7 @@ mir::valueptr ExprKnormVisitor::genExprArray(std::deque<ast::ExprPtr> const& arg
   int count = 0;
   for (auto& elem : newelems) {
     auto newlvname = mirgen.makeNewName();
-    auto index = std::make_shared<mir::Value>(mir::Constants{static_cast<double>(count)});
+    auto index = mirgen.pool.make(mir::Constants{static_cast<double>(count)});
     auto ptrtostore = emplace(minst::Field{{newlvname, types[count]}, lvar, std::move(index)});
     emplace(minst::Store{{newlvname, types[count]}, ptrtostore, elem});
     count++;
@@ -257,8 +261,8 @@ mir::valueptr ExprKnormVisitor::operator()(ast::StructAccess& ast) {
   auto& strtype = strtype_opt.value().getraw();
   auto [index, fieldtype] = types::getField(strtype, ast.field);
   auto lowtype = mir::lowerType(fieldtype);
-  auto ptr = emplace(
-      minst::Field{{lvname, lowtype}, target, std::make_shared<mir::Value>(mir::Constants(index))});
+  auto ptr =
+      emplace(minst::Field{{lvname, lowtype}, target, mirgen.pool.make(mir::Constants(index))});
   return emplace(minst::Load{{mirgen.makeNewName(), fieldtype}, ptr});
 }
 mir::valueptr ExprKnormVisitor::operator()(ast::ArrayInit& ast) {
@@ -332,7 +336,7 @@ void StatementKnormVisitor::operator()(ast::Fdef& ast) {
 
 void AssignKnormVisitor::operator()(ast::DeclVar& ast) {
   auto& lvname = ast.value.value;
-  optvalptr lvarptr = mirgen.tryGetInternalSymbol(lvname + "_ptr");
+  optvalptr lvarptr = mirgen.tryGetVariablePtr(lvname);
   types::Value& type = mirgen.typeenv.find(lvname);
   mir::valueptr ptr;
   if (std::holds_alternative<types::rFunction>(type)) {
@@ -348,7 +352,7 @@ void AssignKnormVisitor::operator()(ast::DeclVar& ast) {
   } else {
     ptr = exprvisitor.genAllocate(lvname, type);
   }
-  mirgen.symbol_table.emplace(lvname + "_ptr", ptr);
+  mirgen.variable_ptrs.emplace(lvname, ptr);
   auto rvar = exprvisitor.genInst(expr);
   exprvisitor.emplace(minst::Store{{lvname, types::None{}}, ptr, rvar});
 }
@@ -368,11 +372,11 @@ void AssignKnormVisitor::operator()(ast::TupleLvar& ast) {
     auto& name = arg.value.value;
     auto type = mirgen.typeenv.find(name);
     mir::valueptr lvar = exprvisitor.genAllocate(name + "_ptr", type);
-    mirgen.symbol_table.emplace(name + "_ptr", lvar);
+    mirgen.variable_ptrs.emplace(name, lvar);
 
     mir::Constants index = count++;
-    auto ptrtoval = exprvisitor.emplace(
-        minst::Field{{name, type}, rvar, std::make_shared<mir::Value>(std::move(index))});
+    auto ptrtoval =
+        exprvisitor.emplace(minst::Field{{name, type}, rvar, mirgen.pool.make(std::move(index))});
     auto valtostore = exprvisitor.emplace(minst::Load{{mirgen.makeNewName(), type}, ptrtoval});
     exprvisitor.emplace(minst::Store{{name, type}, lvar, valtostore});
   }
@@ -386,7 +390,7 @@ void AssignKnormVisitor::operator()(ast::StructLvar& ast) {
   auto [idx, fieldty] = types::getField(structty.value(), ast.field.value);
   auto name = mir::getName(*lvar) + "_" + ast.field.value;
   auto address = exprvisitor.emplace(
-      minst::Field{{name, fieldty}, lvar, std::make_shared<mir::Value>(mir::Constants(idx))});
+      minst::Field{{name, fieldty}, lvar, mirgen.pool.make(mir::Constants(idx))});
   exprvisitor.emplace(minst::Store{{name, types::Void{}}, address, rvar});
 }
 
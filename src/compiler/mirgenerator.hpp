@@ -72,7 +72,7 @@ inline types::Value lowerType(types::Value const& t) {
 
 class MirGenerator {
  public:
-  explicit MirGenerator(TypeEnv& typeenv) : typeenv(typeenv) {}
+  MirGenerator(TypeEnv& typeenv, mir::ValuePool& pool) : typeenv(typeenv), pool(pool) {}
   struct ExprKnormVisitor : public VisitorBase<mir::valueptr&> {
     explicit ExprKnormVisitor(MirGenerator& parent, mir::blockptr block,
                               const std::optional<mir::valueptr>& fnctx)
@@ -162,28 +162,32 @@ class MirGenerator {
   int64_t varcounter = 0;
   std::string makeNewName();
   TypeEnv& typeenv;
-  std::unordered_map<std::string, mir::valueptr> symbol_table;
-  std::unordered_map<std::string, mir::valueptr> external_symbols;
+  mir::ValuePool& pool;
+  // functions and arguments
+  std::unordered_map<SymbolId, mir::valueptr> symbol_table;
+  // pointers to the storage of assigned variables
+  std::unordered_map<SymbolId, mir::valueptr> variable_ptrs;
+  std::unordered_map<SymbolId, mir::valueptr> external_symbols;
 
   // static bool isExternalFun(std::string const& str) {
   //   return LLVMBuiltin::ftable.find(str) != LLVMBuiltin::ftable.end();
   // }
-  mir::valueptr getOrGenExternalSymbol(std::string const& name, types::Value const& type);
-  mir::valueptr getInternalSymbol(std::string const& name);
-  optvalptr tryGetInternalSymbol(std::string const& name);
-  mir::valueptr getFunctionSymbol(std::string const& name, types::Value const& type);
+  mir::valueptr getOrGenExternalSymbol(SymbolId name, types::Value const& type);
+  mir::valueptr getInternalSymbol(SymbolId name);
+  optvalptr tryGetInternalSymbol(SymbolId name);
+  optvalptr tryGetVariablePtr(SymbolId name);
+  mir::valueptr getFunctionSymbol(SymbolId name, types::Value const& type);
   // // unpack optional value ptr, and throw error if it does not exist.
   static mir::valueptr require(optvalptr const& v);
 
-  std::function<std::shared_ptr<mir::Argument>(ast::DeclVar)> make_arguments =
-      [&](ast::DeclVar lvar) {
-        auto& name = lvar.value.value;
-        auto type = typeenv.find(name);
-        if (!isPassByValue(type)) { type = types::makePointer(type); }
-        auto res = std::make_shared<mir::Argument>(mir::Argument{name, type});
-        symbol_table.emplace(name, std::make_shared<mir::Value>(res));
-        return res;
-      };
+  std::function<mir::valueptr(ast::DeclVar)> make_arguments = [&](ast::DeclVar lvar) {
+    auto& name = lvar.value.value;
+    auto type = typeenv.find(name);
+    if (!isPassByValue(type)) { type = types::makePointer(type); }
+    auto res = pool.make(mir::Argument{name, type});
+    symbol_table.emplace(name, res);
+    return res;
+  };
 };
 
 }  // namespace mimium
\ No newline at end of file
@@ -6,10 +6,7 @@
 namespace mimium {
 
 // new alphaconverter
-SymbolRenamer::SymbolRenamer() : SymbolRenamer(std::make_shared<RenameEnvironment>()) {}
-SymbolRenamer::SymbolRenamer(std::shared_ptr<RenameEnvironment> env) : env(std::move(env)) {
-  this->env->rename_map.emplace("dsp", "dsp");
-}
+SymbolRenamer::SymbolRenamer() { env.addToMap("dsp", "dsp"); }
 
 AstPtr SymbolRenamer::rename(ast::Statements& ast) {
   auto newast = std::make_shared<ast::Statements>();
@@ -18,16 +15,16 @@ AstPtr SymbolRenamer::rename(ast::Statements& ast) {
   }
   return newast;
 }
-std::string SymbolRenamer::generateNewName(std::string const& name) {
-  return name + std::to_string(namecount++);
+SymbolId SymbolRenamer::generateNewName(SymbolId name) {
+  return name.str() + std::to_string(namecount++);
 }
 
-std::string SymbolRenamer::getNewName(std::string const& name) {
-  auto res = env->search(std::optional(name));
+SymbolId SymbolRenamer::getNewName(SymbolId name) {
+  auto res = env.search(name);
   return res.value_or(generateNewName(name));
 }
-std::string SymbolRenamer::searchFromEnv(std::string const& name) {
-  auto res = env->search(std::optional(name));
+SymbolId SymbolRenamer::searchFromEnv(SymbolId name) {
+  auto res = env.search(name);
   if (res == std::nullopt) {
     // the variable not found, assumed to be external symbol at this stage.
     return name;
@@ -50,10 +47,10 @@ ast::ExprPtr ExprRenameVisitor::operator()(ast::Symbol& ast) {
 }
 ast::ExprPtr ExprRenameVisitor::operator()(ast::Self& ast) { return ast::makeExpr(ast); }
 ast::Block SymbolRenamer::renameBlock(ast::Block& ast) {
-  env = env->expand();
+  env.enterScope();
   auto newstmts = rename(ast.stmts);
   auto newexpr = ast.expr.has_value() ? std::optional(renameExpr(ast.expr.value())) : std::nullopt;
-  env = env->parent_env;
+  env.exitScope();
   return ast::Block{{{ast.debuginfo}}, *std::move(newstmts), std::move(newexpr)};
 }
 
@@ -66,10 +63,10 @@ ast::LambdaArgs ExprRenameVisitor::renameLambdaArgs(ast::LambdaArgs& ast) {
   return ast::LambdaArgs{{{ast.debuginfo}}, std::move(newargs)};
 }
 ast::Lambda ExprRenameVisitor::renameLambda(ast::Lambda& ast) {
-  renamer.env = renamer.env->expand();
+  renamer.env.enterScope();
   auto newargsast = renameLambdaArgs(ast.args);
   auto newbody = renamer.renameBlock(ast.body);
-  renamer.env = renamer.env->parent_env;
+  renamer.env.exitScope();
   return ast::Lambda{{{ast.debuginfo}}, std::move(newargsast), std::move(newbody), ast.ret_type};
 }
 
@@ -128,12 +125,12 @@ ast::ExprPtr ExprRenameVisitor::operator()(ast::If& ast) {
 using LvarRenameVisitor = SymbolRenamer::LvarRenameVisitor;
 ast::DeclVar LvarRenameVisitor::renameDeclVar(ast::DeclVar& ast) {
   auto newname = renamer.getNewName(ast.value.value);
-  renamer.env->addToMap(ast.value.value, newname);
+  renamer.env.addToMap(ast.value.value, newname);
   return ast::DeclVar{{{ast.debuginfo}}, ast::Symbol{{ast.value.debuginfo}, newname}, ast.type};
 }
 ast::DeclVar LvarRenameVisitor::renameLambdaArgVar(ast::DeclVar& ast) {
   auto newname = renamer.generateNewName(ast.value.value);
-  renamer.env->addToMap(ast.value.value, newname);
+  renamer.env.addToMap(ast.value.value, newname);
   return ast::DeclVar{{{ast.debuginfo}}, ast::Symbol{{ast.value.debuginfo}, newname}, ast.type};
 }
 
@@ -185,10 +182,10 @@ StatementPtr StatementRenameVisitor::operator()(ast::If& ast) {
 
 StatementPtr StatementRenameVisitor::operator()(ast::For& ast) {
   auto newiter = renamer.renameExpr(ast.iterator);
-  renamer.env = renamer.env->expand();
+  renamer.env.enterScope();
   auto newindex = renamer.lvar_renamevisitor.renameDeclVar(ast.index);
   auto newstmts = renamer.renameBlock(ast.statements);
-  renamer.env = renamer.env->parent_env;
+  renamer.env.exitScope();
   return ast::makeStatement(
       ast::For{{{ast.debuginfo}}, std::move(newindex), std::move(newiter), std::move(newstmts)});
 }
@@ -18,7 +18,6 @@ using StatementPtr = std::shared_ptr<ast::Statement>;
 class SymbolRenamer {
  public:
   SymbolRenamer();
-  explicit SymbolRenamer(std::shared_ptr<RenameEnvironment> env);
   AstPtr rename(ast::Statements& ast);
 
   struct ExprRenameVisitor : public VisitorBase<ast::ExprPtr> {
@@ -86,11 +85,11 @@ class SymbolRenamer {
   ExprRenameVisitor expr_renamevisitor{*this};
   StatementRenameVisitor statement_renamevisitor{*this};
   LvarRenameVisitor lvar_renamevisitor{*this};
-  std::shared_ptr<RenameEnvironment> env;
+  RenameEnvironment env;
   uint64_t namecount = 0;
-  std::string getNewName(std::string const& name);
-  std::string generateNewName(std::string const& name);
-  std::string searchFromEnv(std::string const& name);
+  SymbolId getNewName(SymbolId name);
+  SymbolId generateNewName(SymbolId name);
+  SymbolId searchFromEnv(SymbolId name);
 };
 
 }  // namespace mimium
\ No newline at end of file
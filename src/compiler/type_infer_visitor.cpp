@@ -208,29 +208,36 @@ types::Value TypeInferer::addDeclVar(ast::DeclVar& lvar) {
 }
 
 types::Value TypeUnifyVisitor::unify(types::rTypeVar t1, types::rTypeVar t2) {
-  types::Value res = t1;
-  auto i1 = t1.getraw().index;
-  auto i2 = t2.getraw().index;
-  auto& t1_point = inferer.typeenv.tv_container[i1];
-  auto& t2_point = inferer.typeenv.tv_container[i2];
-  bool t1contain = !std::holds_alternative<types::rTypeVar>(t1_point);
-  bool t2contain = !std::holds_alternative<types::rTypeVar>(t2_point);
-  if (i1 != i2) {
-    if (!t1contain && !t2contain) {
-      if (i1 > i2) {
-        t1_point = t2_point;
-        res = t2_point;
-      } else if (i1 < i2) {
-        t2_point = t1_point;
-        res = t1_point;
-      }
-    } else {
-      res = inferer.unify(t1_point, t2_point);
-    }
+  auto& env = inferer.typeenv;
+  const auto r1 = env.findRoot(t1.getraw().index);
+  const auto r2 = env.findRoot(t2.getraw().index);
+  if (r1 == r2) { return env.tv_container[r1]; }
+  types::Value b1 = env.tv_container[r1];
+  types::Value b2 = env.tv_container[r2];
+  const bool t1contain = !std::holds_alternative<types::rTypeVar>(b1);
+  const bool t2contain = !std::holds_alternative<types::rTypeVar>(b2);
+  if (!t1contain && !t2contain) { return env.tv_container[env.uniteTypeVars(r1, r2)]; }
+  types::Value res;
+  if (t1contain && t2contain) {
+    // unification of bound types may have merged other groups, including these.
+    res = inferer.unify(std::move(b1), std::move(b2));
+  } else {
+    res = t1contain ? bindTypeVar(r2, std::move(b1)) : bindTypeVar(r1, std::move(b2));
   }
+  env.tv_container[env.uniteTypeVars(r1, r2)] = res;
   return res;
 }
 
+types::Value TypeUnifyVisitor::bindTypeVar(int root, types::Value t) {
+  auto& env = inferer.typeenv;
+  // primitive types can not contain type variables.
+  if (!types::isPrimitive(t) && std::visit(OccurChecker{root, env}, t)) {
+    throw std::runtime_error("type loop detected");
+  }
+  env.tv_container[root] = t;
+  return t;
+}
+
 types::Value TypeUnifyVisitor::unify(types::rPointer p1, types::rPointer p2) {
   auto lhs = p1.getraw().val;
   auto rhs = p2.getraw().val;
@@ -316,6 +323,7 @@ TypeEnv& TypeInferer::infer(ast::Statements& topast) {
   return typeenv;
 }
 void TypeInferer::substituteTypeVars() {
+  typevarmap.clear();
   for (auto&& [key, t] : typeenv.env) {
     typeenv.env.insert_or_assign(key, std::visit(substitutevisitor, t));
   }
@@ -11,16 +11,24 @@
 // variable has unique name regardless its scope)
 
 namespace mimium {
+// checks if a type contains a type variable of the group of root, following the types bound to
+// the other type variables.
 struct OccurChecker {
-  types::TypeVar& tv;
-  explicit OccurChecker(types::TypeVar& target) : tv(target) {}
+  int root;
+  TypeEnv& env;
+  OccurChecker(int root, TypeEnv& env) : root(root), env(env) {}
   bool operator()(const types::Function& t) const {
     return std::visit(*this, t.ret_type) || checkArgs(t.arg_types);
   }
   bool operator()(const types::Array& t) const { return std::visit(*this, t.elem_type); }
   bool operator()(const types::Struct& t) const { return checkArgs(t.arg_types); }
   bool operator()(const types::Tuple& t) const { return checkArgs(t.arg_types); };
-  bool operator()(const types::TypeVar& t) const { return (t.index == tv.index); }
+  bool operator()(const types::TypeVar& t) const {
+    const auto r = env.findRoot(t.index);
+    if (r == root) { return true; }
+    auto const& bound = env.tv_container[r];
+    return !std::holds_alternative<types::rTypeVar>(bound) && std::visit(*this, bound);
+  }
   template <typename T>
   bool operator()(const Box<T>& t) const {
     return (*this)(static_cast<T const&>(t));
@@ -111,17 +119,12 @@ struct TypeInferer {
     // // typevar unifying
     template <typename T>
     types::Value unify(T t1, types::rTypeVar t2) {
-      types::Value res = t1;
-      auto& t2_real = inferer.typeenv.findTypeVar(t2.getraw().index);
-      if (!std::holds_alternative<types::rTypeVar>(t2_real)) {
-        res = inferer.unify(t2_real, types::Value(t1));
-      } else {
-        if (OccurChecker{rv::get<types::TypeVar>(t2_real)}(t1)) {
-          throw std::runtime_error("type loop detected");
-        }
-        inferer.typeenv.tv_container[rv::get<types::TypeVar>(t2_real).index] = t1;
+      const auto root = inferer.typeenv.findRoot(t2.getraw().index);
+      types::Value bound = inferer.typeenv.tv_container[root];
+      if (!std::holds_alternative<types::rTypeVar>(bound)) {
+        return inferer.unify(std::move(bound), types::Value(t1));
       }
-      return res;
+      return bindTypeVar(root, types::Value(t1));
     }
     template <typename T>
     types::Value unify(types::rTypeVar t1, T t2) {
@@ -172,14 +175,21 @@ struct TypeInferer {
     std::vector<types::Value> unifyArgs(std::vector<types::Value>& v1,
                                         std::vector<types::Value>& v2);
     void updateAlias(types::Alias& a) const;
+    // binds the unbound group of root to t.
+    types::Value bindTypeVar(int root, types::Value t);
   };
   struct SubstituteVisitor {
     explicit SubstituteVisitor(TypeInferer& parent) : inferer(parent) {}
+    // substituted types are memoized by the root of type variables.
     types::Value operator()(types::TypeVar& t) {
-      auto& target = inferer.typeenv.findTypeVar(t.index);
-      if (std::visit(OccurChecker{t}, target)) {
+      auto& env = inferer.typeenv;
+      const auto root = env.findRoot(t.index);
+      auto iter = inferer.typevarmap.find(root);
+      if (iter != inferer.typevarmap.end()) { return iter->second; }
+      types::Value target = env.tv_container[root];
+      if (std::visit(OccurChecker{root, env}, target)) {
         Logger::debug_log("type loop detected. decuced into float type.", Logger::WARNING);
-        return types::Float{};
+        return inferer.typevarmap.emplace(root, types::Float{}).first->second;
       }
       types::Value contained = std::visit(*this, target);
       if (std::holds_alternative<types::None>(contained) ||
@@ -187,7 +197,7 @@ struct TypeInferer {
         throw std::runtime_error("failed to replace typevar. decuced into float type.");
         return types::Float{};
       }
-      return std::visit(*this, target);
+      return inferer.typevarmap.emplace(root, std::move(contained)).first->second;
     }
     types::Value operator()(types::Float& t) { return t; }
     types::Value operator()(types::String& t) { return t; }
@@ -253,6 +263,7 @@ struct TypeInferer {
 
  private:
   TypeEnv typeenv;
+  // root of type variables -> substituted type
   std::unordered_map<int, types::Value> typevarmap;
   std::stack<types::Value> selftype_stack;
   ExprTypeVisitor exprvisitor;
@@ -1,5 +1,7 @@
 #pragma once
 #include "basic/filereader.hpp"
+#include "basic/codegen_option.hpp"
+#include "runtime/runtime_defs.hpp"
 #include <optional>
 #include <string_view>
 
@@ -13,6 +15,8 @@ enum class CompileStage {
   ClosureConvert,
   MemobjCollect,
   Codegen,
+  EmitObject,
+  EmitSharedObject,
   Run
 };
 
@@ -24,18 +28,39 @@ enum class ExecutionEngine {
   WebAssembly
 };
 
-enum class BackEnd { Invalid = -1, API, Test, RtAudio };
-
-enum class OptimizeLevel { ON, OFF };
+enum class BackEnd { Invalid = -1, API, Test, RtAudio, Offline };
 
 struct CompileOption {
   CompileStage stage = CompileStage::Run;
+  // floating point type used for numbers and audio buffers.
+  FloatPrecision float_precision = FloatPrecision::F64;
 };
 
 struct RuntimeOption {
   ExecutionEngine engine = ExecutionEngine::LLVM;
   BackEnd backend = BackEnd::RtAudio;
-  OptimizeLevel optimize_level;
+  OptimizeLevel optimize_level = OptimizeLevel::O2;
+  // used for offline rendering.(samplerate and framesize are also used for RtAudio.)
+  std::optional<double> duration = std::nullopt;
+  std::optional<int> samplerate = std::nullopt;
+  std::optional<int> framesize = std::nullopt;
+  // persistent cache of jit-compiled objects. disabled if directory is not set.
+  std::optional<fs::path> jit_cache_dir = std::nullopt;
+  uint64_t jit_cache_size_limit = 256 * 1024 * 1024;  // bytes
+  // compile functions when they are first referred, on jit_threads background threads.
+  bool lazy_jit = false;
+  unsigned int jit_threads = 0;
+  // number of independent instances of dsp rendered in parallel and summed.
+  int num_voices = 1;
+  // threads used for rendering voices. 0 means number of cores.
+  int num_threads = 0;
+  // back the memory for generated code with huge pages.
+  bool use_hugepage = false;
+  // print percentiles of the time spent in audio callbacks periodically.
+  bool show_stats = false;
+  // watch the source and swap dsp with the recompiled one while running.
+  bool live_reload = false;
+  double crossfade_ms = 50;
 };
 struct AppOption {
   CompileOption compile_option;
@@ -43,5 +68,9 @@ struct AppOption {
   std::optional<Source> input = std::nullopt;
   std::optional<fs::path> output_path;
   bool is_verbose = false;
+  // report time and memory of each compiler stage and llvm pass to stderr.
+  bool time_passes = false;
+  // write the report in json to the file("-" for stdout).
+  std::optional<fs::path> time_passes_json = std::nullopt;
 };
 }  // namespace mimium::app
\ No newline at end of file
@@ -15,6 +15,8 @@ const std::unordered_map<std::string_view, ak> str_to_argkind = {
     {"--emit-mir", ak::EmitMir},
     {"--emit-mir-cc", ak::EmitMirClosureCoverted},
     {"--emit-llvm", ak::EmitLLVMIR},
+    {"--emit-obj", ak::EmitObject},
+    {"--emit-so", ak::EmitSharedObject},
     {"--verbose", ak::Verbose},
     {"--version", ak::ShowVersion},
     {"--help", ak::ShowHelp},
@@ -24,8 +26,70 @@ const std::unordered_map<std::string_view, ak> str_to_argkind = {
     {"--optimize", ak::OptimizeLevel},
     {"--backend", ak::BackEnd},
     {"--engine", ak::ExecutionEngine},
+    {"--duration", ak::Duration},
+    {"--samplerate", ak::SampleRate},
+    {"--framesize", ak::FrameSize},
+    {"--jit-cache", ak::JitCacheDir},
+    {"--jit-cache-size", ak::JitCacheSize},
+    {"--lazy-jit", ak::LazyJit},
+    {"--jit-threads", ak::JitThreads},
+    {"--voices", ak::Voices},
+    {"--threads", ak::Threads},
+    {"--hugepage", ak::HugePage},
+    {"--precision", ak::Precision},
+    {"--stats", ak::Stats},
+    {"--live", ak::Live},
+    {"--crossfade", ak::Crossfade},
+    {"--time-passes", ak::TimePasses},
+    {"--time-passes-json", ak::TimePassesJson},
 };
 
+// parse positive number for options like --samplerate.
+template <typename T>
+T parseNumber(std::string_view val) {
+  auto str = std::string(val);
+  std::size_t pos = 0;
+  T res = 0;
+  try {
+    if constexpr (std::is_integral_v<T>) {
+      res = std::stoi(str, &pos);
+    } else {
+      res = std::stod(str, &pos);
+    }
+  } catch (std::logic_error& /*e*/) { pos = 0; }
+  if (pos != str.size() || res <= 0) {
+    throw mimium::CliAppError("Invalid number for option: " + str);
+  }
+  return res;
+}
+
+const std::unordered_map<std::string_view, mimium::OptimizeLevel> str_to_optlevel = {
+    {"0", mimium::OptimizeLevel::O0}, {"1", mimium::OptimizeLevel::O1},
+    {"2", mimium::OptimizeLevel::O2}, {"3", mimium::OptimizeLevel::O3},
+    {"s", mimium::OptimizeLevel::Os},
+};
+
+const std::unordered_map<std::string_view, mimium::FloatPrecision> str_to_precision = {
+    {"32", mimium::FloatPrecision::F32},
+    {"64", mimium::FloatPrecision::F64},
+};
+
+mimium::FloatPrecision parseFloatPrecision(std::string_view val) {
+  auto iter = str_to_precision.find(val);
+  if (iter == str_to_precision.cend()) {
+    throw mimium::CliAppError("Invalid float precision: " + std::string(val));
+  }
+  return iter->second;
+}
+
+mimium::OptimizeLevel parseOptimizeLevel(std::string_view val) {
+  auto iter = str_to_optlevel.find(val);
+  if (iter == str_to_optlevel.cend()) {
+    throw mimium::CliAppError("Invalid optimization level: " + std::string(val));
+  }
+  return iter->second;
+}
+
 }  // namespace
 
 namespace mimium::app::cli {
@@ -41,6 +105,13 @@ bool isArgPaired(ArgKind arg) {
     case ak::EmitMir:
     case ak::EmitMirClosureCoverted:
     case ak::EmitLLVMIR:
+    case ak::EmitObject:
+    case ak::EmitSharedObject:
+    case ak::LazyJit:
+    case ak::HugePage:
+    case ak::Stats:
+    case ak::Live:
+    case ak::TimePasses:
     case ak::Verbose: return false;
     default: return true;
   }
@@ -51,14 +122,37 @@ std::ostream& CliApp::printHelp(std::ostream& out) const {
   app->printAbout(out);
   out <<
       R"(
-Usage: mimium [options] <input file>
+Usage: mimium [options] <input file(*.mmm,*.ll,*.bc,*.so)>
 
 Options: 
 
-  -o|--output [*.mmmast,*.mmmmir,*.ll] - Specify output filename.
-  --optimize  [0,1(default)]           - Set Optimization Level.
-  --engine    [llvm(default)]          - Set execution engine.
-  --backend   [rtaudio(default)]       - Set Audio Backend.
+  -o|--output  [*.mmmast,*.mmmmir,*.ll,*.o,*.so,*.wav,*.flac] - Specify output filename.
+  --optimize   [0,1,2(default),3,s]     - Set Optimization Level.
+  --precision  [32,64(default)]         - Set bit width of float type and audio samples.
+                                          With 32, now and the time of @ lose sample accuracy
+                                          after 2^24 samples(about 5.8 minutes at 48kHz).
+  --engine     [llvm(default)]          - Set execution engine.
+  --backend    [rtaudio(default),offline] - Set Audio Backend.
+                                          offline backend renders into the file set by -o.
+  --duration   [seconds]                - Set duration of offline rendering.
+  --samplerate [Hz]                     - Set sampling rate.
+  --framesize  [frames]                 - Set buffer size of audio driver.
+  --jit-cache  [directory]              - Cache compiled code to skip compilation next time.
+  --jit-cache-size [MB(default:256)]    - Set the size limit of the jit cache.
+  --lazy-jit                           - Compile only the functions used by the program.
+  --jit-threads [number]                - Set number of threads compiling code for --lazy-jit.
+  --voices     [number(default:1)]      - Render independent instances of dsp and sum them.
+                                          Each instance gets its index by voiceindex().
+  --threads    [number(default:cores)]  - Set number of threads used for rendering voices.
+  --hugepage                           - Allocate memory for the program on huge pages(Linux).
+  --stats                              - Print timing of audio callbacks every second.
+  --live                               - Reload dsp when the source is saved, without stopping.
+  --crossfade  [ms(default:50)]         - Set the crossfade time of --live.
+  --time-passes                        - Print time and memory of compiler stages and llvm passes.
+  --time-passes-json [file]            - Write the report of --time-passes in json(- for stdout).
+  --emit-obj                           - Compile into native object file(default: <input>.o).
+  --emit-so                            - Compile into shared library(default: <input>.so),
+                                         which can be run directly as an input file.
   --version                            - Print a version number to stdout.
   -h|--help                            - Show this help.
 )";
@@ -90,6 +184,28 @@ void CliApp::OptionParser::processArgs(ArgKind arg, std::string_view val) {
     case ak::Output: result.output_path = val; break;
     case ak::BackEnd: result.runtime_option.backend = getBackEnd(val); break;
     case ak::ExecutionEngine: result.runtime_option.engine = getExecutionEngine(val); break;
+    case ak::OptimizeLevel: result.runtime_option.optimize_level = parseOptimizeLevel(val); break;
+    case ak::Duration: result.runtime_option.duration = parseNumber<double>(val); break;
+    case ak::SampleRate: result.runtime_option.samplerate = parseNumber<int>(val); break;
+    case ak::FrameSize: result.runtime_option.framesize = parseNumber<int>(val); break;
+    case ak::JitCacheDir: result.runtime_option.jit_cache_dir = val; break;
+    case ak::JitCacheSize:
+      result.runtime_option.jit_cache_size_limit =
+          static_cast<uint64_t>(parseNumber<double>(val) * 1024 * 1024);
+      break;
+    case ak::LazyJit: result.runtime_option.lazy_jit = true; return;
+    case ak::JitThreads: result.runtime_option.jit_threads = parseNumber<int>(val); break;
+    case ak::Voices: result.runtime_option.num_voices = parseNumber<int>(val); break;
+    case ak::Threads: result.runtime_option.num_threads = parseNumber<int>(val); break;
+    case ak::HugePage: result.runtime_option.use_hugepage = true; return;
+    case ak::Stats: result.runtime_option.show_stats = true; return;
+    case ak::Live: result.runtime_option.live_reload = true; return;
+    case ak::Crossfade: result.runtime_option.crossfade_ms = parseNumber<double>(val); break;
+    case ak::TimePasses: result.time_passes = true; return;
+    case ak::TimePassesJson: result.time_passes_json = val; break;
+    case ak::Precision:
+      result.compile_option.float_precision = parseFloatPrecision(val);
+      break;
     case ak::EmitAst: result.compile_option.stage = CompileStage::Parse; break;
     case ak::EmitAstUniqueSymbol: result.compile_option.stage = CompileStage::SymbolRename; break;
     case ak::EmitMir: result.compile_option.stage = CompileStage::MirEmit; break;
@@ -97,6 +213,8 @@ void CliApp::OptionParser::processArgs(ArgKind arg, std::string_view val) {
       result.compile_option.stage = CompileStage::ClosureConvert;
       break;
     case ak::EmitLLVMIR: result.compile_option.stage = CompileStage::Codegen; break;
+    case ak::EmitObject: result.compile_option.stage = CompileStage::EmitObject; break;
+    case ak::EmitSharedObject: result.compile_option.stage = CompileStage::EmitSharedObject; break;
     case ak::ShowVersion: res_mode = CliAppMode::ShowVersion; return;
     case ak::ShowHelp: res_mode = CliAppMode::ShowHelp; return;
 
@@ -25,7 +25,25 @@ enum class ArgKind {
   EmitMir,
   EmitMirClosureCoverted,
   EmitLLVMIR,
+  EmitObject,
+  EmitSharedObject,
   OptimizeLevel,
+  Duration,
+  SampleRate,
+  FrameSize,
+  JitCacheDir,
+  JitCacheSize,
+  LazyJit,
+  JitThreads,
+  Voices,
+  Threads,
+  HugePage,
+  Precision,
+  Stats,
+  Live,
+  Crossfade,
+  TimePasses,
+  TimePassesJson,
   ShowVersion,
   ShowHelp,
   Verbose,
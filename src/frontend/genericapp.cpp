@@ -3,6 +3,7 @@
  * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
 
 #include "genericapp.hpp"
+#include "frontend/live_reload.hpp"
 #include "basic/ast_to_string.hpp"
 #include "compiler/codegen/llvm_header.hpp"
 #include "runtime/executionengine/executionengine.hpp"
@@ -24,8 +25,17 @@ const std::unordered_map<std::string_view, mimium::app::BackEnd> str_to_backend
     {"rtaudio", mimium::app::BackEnd::RtAudio},
     {"api", mimium::app::BackEnd::API},
     {"test", mimium::app::BackEnd::Test},
+    {"offline", mimium::app::BackEnd::Offline},
 };
 
+#if defined(_WIN32)
+const std::string_view shared_object_ext = mimium::dll_ext;
+#elif defined(__APPLE__)
+const std::string_view shared_object_ext = mimium::dylib_ext;
+#else
+const std::string_view shared_object_ext = mimium::so_ext;
+#endif
+
 }  // namespace
 
 namespace mimium::app {
@@ -59,13 +69,16 @@ void GenericApp::handleSignal(int signal) { GenericApp::signal_status = signal;
 
 bool GenericApp::compileMainLoop(Compiler& compiler, const CompileOption& option,
                                  const std::optional<Source>& input,
-                                 const std::optional<fs::path>& output_path) {
+                                 const std::optional<fs::path>& output_path,
+                                 OptimizeLevel optimize_level) {
   auto stage = option.stage;
   compiler.setFilePath(input ? fs::absolute(input.value().filepath).string() : "/stdin");
+  compiler.setFloatPrecision(option.float_precision);
   // auto preprocessor_path = input ? input.value().filepath.parent_path() : fs::current_path();
   Preprocessor preprocessor(fs::current_path());
   std::stringstream iss;
   if (input) {
+    PassTimer::Scope t(compiler.getPassTimer(), "compiler", "preprocess");
     auto newsource = preprocessor.process(input.value().filepath);
     iss << newsource.source;
   } else {
@@ -73,11 +86,13 @@ bool GenericApp::compileMainLoop(Compiler& compiler, const CompileOption& option
         "Reading from stdin. If you are typing from terminal, type Ctrl+D to finish input. ",
         Logger::INFO);
   }
-  std::istream& in = input ? iss : std::cin;
-  auto ast = compiler.loadSource(in);
+  if (!input) { iss << std::cin.rdbuf(); }
+  // loaded as a string so that the compiler can take hash of it for the jit cache.
+  auto ast = compiler.loadSource(iss.str());
 
   std::ofstream fout;
-  if (output_path) { fout.open(output_path.value()); }
+  // native object files are written by llvm, not through this stream.
+  if (output_path && stage <= CompileStage::Codegen) { fout.open(output_path.value()); }
 
   std::ostream& out = output_path ? fout : std::cout;
 
@@ -111,40 +126,123 @@ bool GenericApp::compileMainLoop(Compiler& compiler, const CompileOption& option
     compiler.dumpLLVMModule(out);
     return false;
   }
+  if (stage == CompileStage::EmitObject || stage == CompileStage::EmitSharedObject) {
+    bool is_so = stage == CompileStage::EmitSharedObject;
+    auto stem = input ? input.value().filepath.stem() : fs::path("untitled");
+    auto path = output_path.value_or(stem.replace_extension(is_so ? shared_object_ext : ".o"));
+    if (is_so) {
+      compiler.emitSharedObject(path, optimize_level);
+    } else {
+      compiler.emitObjectFile(path, optimize_level);
+    }
+    return false;
+  }
 
-  if (output_path) { dynamic_cast<std::ofstream&>(out).close(); }
+  if (fout.is_open()) { fout.close(); }
   return true;
 }
 
+std::unique_ptr<AudioDriver> GenericApp::createAudioDriver(
+    const RuntimeOption& option, const fs::path& input_path,
+    const std::optional<fs::path>& output_path) {
+  switch (option.backend) {
+    case BackEnd::RtAudio: return std::make_unique<AudioDriverRtAudio>();
+    case BackEnd::Offline: {
+      auto path = output_path.value_or(fs::path(input_path.stem()).replace_extension(".wav"));
+      return std::make_unique<AudioDriverOffline>(path, option.duration, option.samplerate,
+                                                  option.framesize);
+    }
+    default: throw std::runtime_error("Specified audio backend is not available yet.");
+  }
+}
+
 int GenericApp::runtimeMainLoop(const RuntimeOption& option, const fs::path& input_path,
                                 FileType inputtype, const std::optional<fs::path>& output_path) {
   std::unique_ptr<mimium::ExecutionEngine> exec_engine=nullptr;
   std::unique_ptr<Runtime> runtime=nullptr;
   try {
-    bool optimize = option.optimize_level == OptimizeLevel::ON;
-    if (option.engine == ExecutionEngine::LLVM) {
+    auto optimize = option.optimize_level;
+    const JitCompileOption jit_option{option.lazy_jit, option.jit_threads};
+    // every version of the source is compiled into the jit shared with the reloader.
+    std::shared_ptr<llvm::orc::MimiumJIT> live_jit = nullptr;
+    if (option.live_reload) {
+      if (inputtype != FileType::MimiumSource || !this->option->input ||
+          option.engine != ExecutionEngine::LLVM) {
+        throw std::runtime_error("--live is available only for mimium source file with llvm.");
+      }
+      if (option.num_voices > 1) {
+        throw std::runtime_error("--live can not be used with multiple voices.");
+      }
+      live_jit = LLVMJitExecutionEngine::createSharedJit(optimize, jit_option);
+    }
+    std::optional<JitCacheOption> cache = std::nullopt;
+    if (option.jit_cache_dir) {
+      cache = JitCacheOption{option.jit_cache_dir.value(), option.jit_cache_size_limit};
+      if (option.lazy_jit) {
+        Logger::debug_log("--jit-cache is not used with --lazy-jit.", Logger::WARNING);
+      }
+    }
+    if (inputtype == FileType::SharedObject) {
+      // already compiled ahead-of-time, no need to use jit engine.
+      exec_engine = std::make_unique<NativeExecutionEngine>(fs::absolute(input_path));
+    } else if (option.engine == ExecutionEngine::LLVM) {
+      std::unique_ptr<LLVMJitExecutionEngine> llvm_engine = nullptr;
       switch (inputtype) {
         case FileType::MimiumSource:
-          exec_engine = std::make_unique<LLVMJitExecutionEngine>(
+          if (live_jit) {
+            llvm_engine = std::make_unique<LLVMJitExecutionEngine>(
+                live_jit, compiler->moveLLVMCtx(), compiler->moveLLVMModule(),
+                compiler->getSourceHash());
+            break;
+          }
+          llvm_engine = std::make_unique<LLVMJitExecutionEngine>(
               compiler->moveLLVMCtx(), compiler->moveLLVMModule(),
-              fs::absolute(input_path).string(), optimize);
+              fs::absolute(input_path).string(), optimize, cache, compiler->getSourceHash(),
+              jit_option);
           break;
         case FileType::LLVMIR:
-          exec_engine =
-              std::make_unique<LLVMJitExecutionEngine>(fs::absolute(input_path).string(), optimize);
+          llvm_engine =
+              std::make_unique<LLVMJitExecutionEngine>(fs::absolute(input_path).string(), optimize,
+                                                       cache, jit_option);
           break;
         case FileType::MimiumMir:
           throw std::runtime_error("MIR Parser is not available yet.");
           return -1;
         default: throw std::runtime_error("Unknown File Type"); return -1;
       }
-      runtime =
-          std::make_unique<Runtime>(std::make_unique<AudioDriverRtAudio>(), std::move(exec_engine));
-      runtime->runMainFun();
+      llvm_engine->setPassTimer(passtimer.get());
+      exec_engine = std::move(llvm_engine);
+    } else {
+      throw std::runtime_error("Execution engine other than llvm is not available yet");
+    }
+    ArenaOption arena_option;
+    arena_option.use_hugepage = option.use_hugepage;
+    runtime = std::make_unique<Runtime>(createAudioDriver(option, input_path, output_path),
+                                        std::move(exec_engine), arena_option);
+    runtime->setAudioParameter(option.samplerate, option.framesize);
+    auto& driver = runtime->getAudioDriver();
+    driver.setVoices(option.num_voices, option.num_threads);
+    driver.setStatsEnabled(option.show_stats);
+    runtime->runMainFun();
+    reportPassTimes();
+    {
+      std::optional<LiveReloader> reloader;
+      if (live_jit) {
+        reloader.emplace(driver, live_jit, input_path, this->option->compile_option.float_precision,
+                         astcache.get(), option.crossfade_ms / 1000.0);
+      }
+      // reported from its own thread, not to write from the audio thread.
+      std::optional<ProcessStatsReporter> reporter;
+      if (option.show_stats) { reporter.emplace(driver.getStats(), std::cerr); }
       runtime->start();  // start() blocks thread until scheduler stops
-      return 0;
+      // the code of reloaded dsp is released with the reloader.
+      if (reloader) { driver.stop(); }
+    }
+    if (auto xruns = driver.getStats().getXruns(); xruns > 0) {
+      Logger::debug_log("Stream underflow detected " + std::to_string(xruns) + " times.",
+                        Logger::WARNING);
     }
-    throw std::runtime_error("Execution engine other than llvm is not available yet");
+    return 0;
   } catch (std::exception& e) {
     if (runtime) { runtime->getAudioDriver().stop(); }
     std::cerr << e.what() << std::endl;
@@ -156,19 +254,45 @@ int GenericApp::runtimeMainLoop(const RuntimeOption& option, const fs::path& inp
   }
 }
 
+void GenericApp::reportPassTimes() const {
+  if (!passtimer) { return; }
+  if (option->time_passes) { passtimer->print(std::cerr); }
+  if (option->time_passes_json) {
+    const auto& path = option->time_passes_json.value();
+    if (path == "-") {
+      passtimer->printJson(std::cout);
+      return;
+    }
+    std::ofstream fout(path);
+    if (!fout) { throw std::runtime_error("Failed to open " + path.string()); }
+    passtimer->printJson(fout);
+  }
+}
+
 int GenericApp::run() {
   try {
     this->compiler = std::make_unique<Compiler>();
+    if (option->is_verbose) { Logger::current_report_level = Logger::INFO; }
+    if (option->time_passes || option->time_passes_json) {
+      passtimer = std::make_unique<PassTimer>();
+      compiler->setPassTimer(passtimer.get());
+    }
+    if (option->runtime_option.live_reload) {
+      astcache = std::make_unique<AstCache>();
+      compiler->setAstCache(astcache.get());
+    }
     bool should_compile = true;
     bool should_run = false;
     if (option->input) {
       auto type = option->input.value().filetype;
       if (type != FileType::MimiumSource) { should_compile = false; }
-      if (type == FileType::LLVMIR) { should_run = true; }
+      if (type == FileType::LLVMIR || type == FileType::SharedObject) { should_run = true; }
     }
     if (should_compile) {
       should_run =
-          compileMainLoop(*compiler, option->compile_option, option->input, option->output_path);
+          compileMainLoop(*compiler, option->compile_option, option->input, option->output_path,
+                          option->runtime_option.optimize_level);
+      if (!should_run) { reportPassTimes(); }
     }
 
     int res = 0;
@@ -176,8 +300,7 @@ int GenericApp::run() {
       auto inpath = option->input ? option->input.value().filepath : fs::path("/stdin");
       auto intype = option->input ? option->input.value().filetype : FileType::MimiumSource;
       // auto outpath = option->output_path.value_or(fs::path("/stdout"));
-      res = runtimeMainLoop(option->runtime_option, inpath, intype,
-                            option->output_path.value_or(fs::path("/stdout")));
+      res = runtimeMainLoop(option->runtime_option, inpath, intype, option->output_path);
     }
     return res;
   } catch (std::exception& e) {
@@ -32,12 +32,22 @@ class MIMIUM_DLL_PUBLIC GenericApp {
   static void handleSignal(int signal);
   // Compiler Main Loop. If runtime should start, return 1.
   // If compiler should emit result and quit app, return 0.
+  // optimize_level is used only for emitting native object.
   static bool compileMainLoop(Compiler& compiler, const CompileOption& option,
                               const std::optional<Source>& input,
-                              const std::optional<fs::path>& output_path);
+                              const std::optional<fs::path>& output_path,
+                              OptimizeLevel optimize_level);
+  static std::unique_ptr<AudioDriver> createAudioDriver(const RuntimeOption& option,
+                                                        const fs::path& input_path,
+                                                        const std::optional<fs::path>& output_path);
   int runtimeMainLoop(const RuntimeOption& option, const fs::path& input_path, FileType inputtype,
                       const std::optional<fs::path>& output_path);
+  // print the result of --time-passes. does nothing if the option is not set.
+  void reportPassTimes() const;
   std::unique_ptr<AppOption> option;
+  std::unique_ptr<PassTimer> passtimer;
+  // shared by the compilations of --live.
+  std::unique_ptr<AstCache> astcache;
 };
 
 }  // namespace mimium::app
\ No newline at end of file
@@ -0,0 +1,152 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+#include "frontend/live_reload.hpp"
+#include "compiler/codegen/llvm_header.hpp"
+#include "compiler/compiler.hpp"
+#include "preprocessor/preprocessor.hpp"
+#include "runtime/backend/audiodriver.hpp"
+#include "runtime/executionengine/llvm/llvm_jitengine.hpp"
+
+namespace mimium::app {
+
+namespace {
+// receives the dsp from mimium_main of the reloaded source. never started. tasks and now of the
+// source refer the scheduler of the running driver instead(see Runtime::setLiveScheduler()).
+class StagingDriver : public AudioDriver {
+ public:
+  bool start() override { return true; }
+  bool stop() override { return true; }
+  [[nodiscard]] std::unique_ptr<AudioDriverParams> getDefaultAudioParameter(
+      std::optional<int> /*samplerate*/, std::optional<int> /*framesize*/) const override {
+    return std::make_unique<AudioDriverParams>();
+  }
+  std::unique_ptr<DspFnInfos> takeDspFnInfos() { return std::move(dspfninfos); }
+};
+}  // namespace
+
+LiveReloader::LiveReloader(AudioDriver& driver, std::shared_ptr<llvm::orc::MimiumJIT> jit,
+                           fs::path source, FloatPrecision precision, AstCache* astcache,
+                           double crossfade_sec, std::chrono::milliseconds interval)
+    : driver(driver),
+      jit(std::move(jit)),
+      source(std::move(source)),
+      precision(precision),
+      astcache(astcache),
+      crossfade_sec(crossfade_sec),
+      interval(interval) {
+  std::error_code ec;
+  auto time = fs::last_write_time(this->source, ec);
+  if (!ec) { last_write = time; }
+  thread = std::thread([this]() { loop(); });
+}
+
+LiveReloader::~LiveReloader() {
+  {
+    std::lock_guard<std::mutex> lock(mtx);
+    quit = true;
+  }
+  cv.notify_all();
+  thread.join();
+}
+
+std::unique_ptr<Runtime> LiveReloader::compile() {
+  Compiler compiler;
+  compiler.setFilePath(fs::absolute(source).string());
+  compiler.setFloatPrecision(precision);
+  compiler.setAstCache(astcache);
+  Preprocessor preprocessor(fs::current_path());
+  auto ast = compiler.renameSymbols(compiler.loadSource(preprocessor.process(source).source));
+  compiler.typeInfer(ast);
+  auto mir = compiler.closureConvert(compiler.generateMir(ast));
+  auto funobjs = compiler.collectMemoryObjs(mir);
+  compiler.generateLLVMIr(mir, funobjs);
+  auto engine = std::make_unique<LLVMJitExecutionEngine>(
+      jit, compiler.moveLLVMCtx(), compiler.moveLLVMModule(), compiler.getSourceHash());
+  auto runtime = std::make_unique<Runtime>(std::make_unique<StagingDriver>(), std::move(engine));
+  runtime->setLiveScheduler(&driver.getScheduler(), ++last_owner);
+  runtime->runMainFun();
+  return runtime;
+}
+
+bool LiveReloader::reload() {
+  auto begin = std::chrono::steady_clock::now();
+  std::unique_ptr<Runtime> runtime;
+  try {
+    runtime = compile();
+    auto& staging = static_cast<StagingDriver&>(runtime->getAudioDriver());
+    // the last swap finishes within the crossfade unless the audio has stopped.
+    while (!collectRetired()) {
+      if (!wait(std::chrono::milliseconds(10))) {
+        release(std::move(runtime));
+        return false;
+      }
+    }
+    if (!driver.swapDsp(staging.takeDspFnInfos(), crossfade_sec)) {
+      release(std::move(runtime));
+      return false;
+    }
+  } catch (std::exception& e) {
+    release(std::move(runtime));
+    Logger::debug_log("Failed to reload " + source.string() + ": " + e.what(), Logger::ERROR_);
+    return false;
+  }
+  retiring = std::move(current);
+  current = std::move(runtime);
+  swapping = true;
+  std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - begin;
+  Logger::debug_log("Reloaded " + source.string() + " in " + std::to_string(elapsed.count()) +
+                        " ms.",
+                    Logger::INFO);
+  return true;
+}
+
+void LiveReloader::release(std::unique_ptr<Runtime> runtime) {
+  // tasks of the source may be still in the scheduler of the driver.
+  if (runtime == nullptr || !runtime->hasLiveTasks()) { return; }
+  removing.push_back(std::move(runtime));
+  if (removing.size() == 1) {
+    driver.getScheduler().removeTasksAsync(removing.front()->getLiveOwner());
+  }
+}
+
+void LiveReloader::collectRemoved() {
+  auto& scheduler = driver.getScheduler();
+  while (!removing.empty() && scheduler.isTasksRemoved(removing.front()->getLiveOwner())) {
+    removing.pop_front();
+    if (!removing.empty()) { scheduler.removeTasksAsync(removing.front()->getLiveOwner()); }
+  }
+}
+
+bool LiveReloader::collectRetired() {
+  if (!swapping) { return true; }
+  auto retired = driver.takeRetiredDsp();
+  if (retired == nullptr) { return false; }
+  // the audio thread no longer refers the code and memory of the old runtime.
+  retired.reset();
+  release(std::move(retiring));
+  swapping = false;
+  return true;
+}
+
+bool LiveReloader::wait(std::chrono::milliseconds duration) {
+  std::unique_lock<std::mutex> lock(mtx);
+  cv.wait_for(lock, duration, [this]() { return quit; });
+  return !quit;
+}
+
+void LiveReloader::loop() {
+  while (wait(interval)) {
+    collectRetired();
+    collectRemoved();
+    std::error_code ec;
+    auto time = fs::last_write_time(source, ec);
+    // the file may be missing for a moment while an editor replaces it.
+    if (ec || time == last_write) { continue; }
+    last_write = time;
+    reload();
+  }
+}
+
+}  // namespace mimium::app
@@ -0,0 +1,81 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+#pragma once
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include "export.hpp"
+#include "runtime/runtime_defs.hpp"
+#include "utils/include_filesystem.hpp"
+
+namespace llvm::orc {
+class MimiumJIT;
+}  // namespace llvm::orc
+
+namespace mimium {
+class AstCache;
+class AudioDriver;
+class Runtime;
+namespace app {
+
+// Watches a source file while the audio is running, and replaces the dsp of the driver with the
+// recompiled one through AudioDriver::swapDsp(). Each version is compiled on the watcher thread
+// into its own dylib of the shared jit, and released after the audio thread stopped using it.
+// If compilation fails, the current dsp keeps running. Tasks scheduled by a reloaded source run on
+// the scheduler of the driver, and are removed from it when the source is replaced, before its
+// runtime is released. Unchanged top-level definitions are taken from astcache if given, instead
+// of parsing them again.
+class MIMIUM_DLL_PUBLIC LiveReloader {
+ public:
+  LiveReloader(AudioDriver& driver, std::shared_ptr<llvm::orc::MimiumJIT> jit, fs::path source,
+               FloatPrecision precision, AstCache* astcache, double crossfade_sec,
+               std::chrono::milliseconds interval = std::chrono::milliseconds(200));
+  ~LiveReloader();
+  LiveReloader(LiveReloader const&) = delete;
+  LiveReloader& operator=(LiveReloader const&) = delete;
+
+ private:
+  AudioDriver& driver;
+  std::shared_ptr<llvm::orc::MimiumJIT> jit;
+  fs::path source;
+  FloatPrecision precision;
+  AstCache* astcache;
+  double crossfade_sec;
+  std::chrono::milliseconds interval;
+  // runtime of the running dsp, null while the dsp of the first runtime is running.
+  std::unique_ptr<Runtime> current;
+  // runtime of the dsp being replaced, released when the driver retired it.
+  std::unique_ptr<Runtime> retiring;
+  // replaced runtimes whose tasks are being removed from the scheduler, one at a time from the
+  // front. the driver must be stopped before the reloader is destroyed.
+  std::deque<std::unique_ptr<Runtime>> removing;
+  // owner id of the tasks of the last compiled runtime.
+  uint64_t last_owner = 0;
+  bool swapping = false;
+  std::optional<fs::file_time_type> last_write;
+  bool quit = false;
+  std::mutex mtx;
+  std::condition_variable cv;
+  std::thread thread;
+  std::unique_ptr<Runtime> compile();
+  // compile the source and request the swap. returns false if the source could not be swapped.
+  bool reload();
+  // release the runtime not used by the driver, after its tasks are removed from the scheduler.
+  void release(std::unique_ptr<Runtime> runtime);
+  // release the runtimes whose tasks have been removed.
+  void collectRemoved();
+  // returns true if no swap is in progress.
+  bool collectRetired();
+  // waits for the interval. returns false if the reloader is being destroyed.
+  bool wait(std::chrono::milliseconds duration);
+  void loop();
+};
+
+}  // namespace app
+}  // namespace mimium
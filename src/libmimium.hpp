@@ -17,7 +17,9 @@
 #include "compiler/ffi.hpp"
 
 #include "runtime/backend/rtaudio/driver_rtaudio.hpp"
+#include "runtime/backend/offline/driver_offline.hpp"
 #include "runtime/executionengine/llvm/llvm_jitengine.hpp"
+#include "runtime/executionengine/native/native_engine.hpp"
 
 #include "frontend/genericapp.hpp"
 #include "frontend/cli.hpp"
\ No newline at end of file
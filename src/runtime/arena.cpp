@@ -0,0 +1,103 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+#include "arena.hpp"
+#include <algorithm>
+#include <new>
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+namespace mimium {
+
+namespace {
+constexpr size_t hugepage_size = 2 * 1024 * 1024;
+
+size_t alignUp(size_t v, size_t align) { return (v + align - 1) / align * align; }
+
+class SpinLockGuard {
+ public:
+  explicit SpinLockGuard(std::atomic_flag& f) : flag(f) {
+    while (flag.test_and_set(std::memory_order_acquire)) {}
+  }
+  ~SpinLockGuard() { flag.clear(std::memory_order_release); }
+  SpinLockGuard(SpinLockGuard const&) = delete;
+  SpinLockGuard& operator=(SpinLockGuard const&) = delete;
+
+ private:
+  std::atomic_flag& flag;
+};
+}  // namespace
+
+void* Arena::allocate(size_t size) {
+  // zero size allocation still returns unique address like malloc.
+  const size_t alloc_size = alignUp(std::max<size_t>(size, 1), alignment);
+  SpinLockGuard guard(lock);
+  std::byte* res = nullptr;
+  if (alloc_size >= option.chunk_size) {
+    // dedicated chunk, keeping the rest of current chunk for following small allocations.
+    res = addChunk(alloc_size).begin;
+  } else {
+    if (cur == nullptr || static_cast<size_t>(end - cur) < alloc_size) {
+      const auto& c = addChunk(alloc_size);
+      cur = c.begin;
+      end = c.begin + c.size;
+    }
+    res = cur;
+    cur += alloc_size;
+  }
+  stats.allocated_bytes += alloc_size;
+  stats.peak_bytes = std::max(stats.peak_bytes, stats.allocated_bytes);
+  stats.count++;
+  return res;
+}
+
+Arena::Chunk const& Arena::addChunk(size_t minsize) {
+  Chunk c{nullptr, std::max(minsize, option.chunk_size), false};
+#if defined(__linux__)
+  if (option.use_hugepage) {
+    c.size = alignUp(c.size, hugepage_size);
+    void* p = mmap(nullptr, c.size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (p != MAP_FAILED) {
+      // only a hint. the kernel falls back to normal pages if THP is disabled.
+      madvise(p, c.size, MADV_HUGEPAGE);
+      c.begin = static_cast<std::byte*>(p);
+      c.is_mmap = true;
+    }
+  }
+#endif
+  if (c.begin == nullptr) {
+    c.size = alignUp(c.size, alignment);
+    c.begin = static_cast<std::byte*>(::operator new(c.size, std::align_val_t(alignment)));
+  }
+  stats.reserved_bytes += c.size;
+  return chunks.emplace_back(c);
+}
+
+void Arena::freeChunk(Chunk const& c) {
+#if defined(__linux__)
+  if (c.is_mmap) {
+    munmap(c.begin, c.size);
+    return;
+  }
+#endif
+  ::operator delete(c.begin, std::align_val_t(alignment));
+}
+
+void Arena::reset() {
+  SpinLockGuard guard(lock);
+  for (const auto& c : chunks) { freeChunk(c); }
+  chunks.clear();
+  cur = nullptr;
+  end = nullptr;
+  stats.allocated_bytes = 0;
+  stats.reserved_bytes = 0;
+}
+
+ArenaStats Arena::getStats() const {
+  SpinLockGuard guard(lock);
+  return stats;
+}
+
+}  // namespace mimium
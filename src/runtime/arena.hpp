@@ -0,0 +1,61 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <vector>
+#include "export.hpp"
+
+namespace mimium {
+
+struct ArenaOption {
+  // minimum size of a chunk requested from the OS. larger allocation gets its own chunk.
+  size_t chunk_size = 1024 * 1024;
+  // back chunks with transparent huge pages where available(Linux). chunks are rounded up to 2MB.
+  bool use_hugepage = false;
+};
+
+struct ArenaStats {
+  size_t allocated_bytes = 0;  // requested by allocate(), including padding for alignment
+  size_t reserved_bytes = 0;   // total size of chunks
+  size_t peak_bytes = 0;       // maximum of allocated_bytes since construction
+  size_t count = 0;            // number of allocations
+};
+
+// Bump allocator used for memory allocated by generated code(closures, memory objects...).
+// Memory is never freed individually but released at once by reset() or the destructor.
+// allocate() may be called from the audio thread and voice workers at the same time, so it is
+// guarded with a spinlock which is held only while bumping the pointer or adding a chunk.
+class MIMIUM_DLL_PUBLIC Arena {
+ public:
+  // enough for SIMD loads up to AVX-512 and avoids false sharing between allocations.
+  static constexpr size_t alignment = 64;
+  explicit Arena(ArenaOption option = {}) : option(option) {}
+  ~Arena() { reset(); }
+  Arena(Arena const&) = delete;
+  Arena& operator=(Arena const&) = delete;
+  // returned memory is aligned to `alignment` and not initialized.
+  void* allocate(size_t size);
+  // release all chunks. pointers returned so far become invalid.
+  void reset();
+  [[nodiscard]] ArenaStats getStats() const;
+
+ private:
+  struct Chunk {
+    std::byte* begin;
+    size_t size;
+    bool is_mmap;
+  };
+  ArenaOption option;
+  std::vector<Chunk> chunks;
+  std::byte* cur = nullptr;
+  std::byte* end = nullptr;
+  ArenaStats stats;
+  mutable std::atomic_flag lock = ATOMIC_FLAG_INIT;
+  Chunk const& addChunk(size_t minsize);
+  static void freeChunk(Chunk const& c);
+};
+
+}  // namespace mimium
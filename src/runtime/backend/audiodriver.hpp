@@ -3,8 +3,16 @@
  * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
 
 #pragma once
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
 #include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include "runtime/backend/process_stats.hpp"
 #include "runtime/runtime.hpp"
+#include "runtime/voice_pool.hpp"
 
 namespace mimium {
 
@@ -28,10 +36,31 @@ class MIMIUM_DLL_PUBLIC AudioDriver {
                           std::to_string(dspfninfos->out_numchs) + " output",
                       Logger::INFO);
   }
+  void setDspBlockFn(DspBlockFnPtr fn) {
+    assert(dspfninfos != nullptr);
+    dspfninfos->block_fn = fn;
+  }
+  void setDspPlanarBlockFn(DspPlanarBlockFnPtr fn) {
+    assert(dspfninfos != nullptr);
+    dspfninfos->planar_block_fn = fn;
+  }
+  void setDspMemobjSize(size_t size) {
+    assert(dspfninfos != nullptr);
+    dspfninfos->memobj_size = size;
+  }
+  void setDspMemobjLayout(uint64_t layout) {
+    assert(dspfninfos != nullptr);
+    dspfninfos->memobj_layout = layout;
+  }
+  // render the dsp function as multiple independent voices summed into output. must be called
+  // before setup(). numthreads=0 uses number of cores.
+  void setVoices(int numvoices, int numthreads) {
+    this->numvoices = numvoices;
+    this->numthreads = numthreads;
+  }
   virtual void setup(std::unique_ptr<AudioDriverParams> p) {
     params = std::move(p);
-    interleaved_in.resize(params->audioframesize * dspfninfos->in_numchs);
-    interleaved_out.resize(params->audioframesize * dspfninfos->out_numchs);
+    allocateBuffers();
     if (dspfninfos->in_numchs > params->in_numchs || dspfninfos->out_numchs > params->out_numchs) {
       Logger::debug_log(
           "Number of inputs/outputs is bigger than number of the audio driver's inputs/outputs.",
@@ -47,117 +76,372 @@ class MIMIUM_DLL_PUBLIC AudioDriver {
   virtual bool stop() = 0;
   [[nodiscard]] virtual std::unique_ptr<AudioDriverParams> getDefaultAudioParameter(
       std::optional<int> samplerate, std::optional<int> framesize) const = 0;
-  // Main dsp process function
-  bool process(const double** input, double** output, int framesize) {
-    if (dspfninfos->fn != nullptr) { return processInternal<true>(input, output, framesize); }
-    return processInternal<false>(input, output, framesize);
+  // sample type of the buffers passed to process(). set by the compiled code.
+  [[nodiscard]] FloatPrecision getFloatPrecision() const {
+    assert(dspfninfos != nullptr);
+    return dspfninfos->precision;
+  }
+  // size of a sample in bytes, used for AudioDriverParams::buffersizebyte.
+  [[nodiscard]] int getSampleSize() const {
+    return static_cast<int>(getFloatPrecision() == FloatPrecision::F32 ? sizeof(float)
+                                                                      : sizeof(double));
+  }
+  // true if non-interleaved buffers are passed to the dsp function without copying. Drivers
+  // should prefer planar buffers of the host in this case.
+  [[nodiscard]] bool hasPlanarDsp() const {
+    return dspfninfos->planar_block_fn != nullptr && numvoices <= 1;
   }
-  // Interleaved version of main dsp process.
-  bool process(const double* input, double* output, int framesize) {
-    if (dspfninfos->fn != nullptr) {
-      return processInternalInterleaved<true>(input, output, framesize);
+  // measure time of each callback into getStats(). xruns are counted regardless of this.
+  void setStatsEnabled(bool enabled) { stats_enabled = enabled; }
+  [[nodiscard]] bool isStatsEnabled() const { return stats_enabled; }
+  ProcessStats& getStats() { return stats; }
+  // called by drivers when the device reported underflow or overflow. logging from the audio
+  // thread may block, so only a counter is incremented.
+  void reportXrun() { stats.reportXrun(); }
+  // Replaces the dsp at the beginning of the next block, crossfading from the current one over
+  // crossfade_sec. The state of the memory object is copied to the new one if the layouts
+  // match. Called from a non-realtime thread, the audio thread never waits for it.
+  // Returns false if the last swap has not finished, and throws if the dsp can not be swapped.
+  bool swapDsp(std::unique_ptr<DspFnInfos> next, double crossfade_sec) {
+    if (swap_state.load(std::memory_order_acquire) != SwapState::Idle) { return false; }
+    const auto& cur = *dspfninfos;
+    if (cur.fn == nullptr || next->fn == nullptr) {
+      throw std::runtime_error("dsp function is needed both before and after swapping.");
     }
-    return processInternalInterleaved<false>(input, output, framesize);
+    if (voicepool != nullptr) {
+      throw std::runtime_error("dsp rendered as multiple voices can not be swapped.");
+    }
+    if (next->in_numchs != cur.in_numchs || next->out_numchs != cur.out_numchs) {
+      throw std::runtime_error("number of channels of dsp can not be changed while running.");
+    }
+    if (next->precision != cur.precision) {
+      throw std::runtime_error("float precision can not be changed while running.");
+    }
+    swap_next = std::move(next);
+    assert(params != nullptr);
+    fade_len = std::max(static_cast<int>(std::lround(crossfade_sec * params->samplerate)), 0);
+    swap_state.store(SwapState::Pending, std::memory_order_release);
+    return true;
+  }
+  // dsp replaced by the last swap, returned once after the crossfade finished. code and memory
+  // referred by it can be released after this. null otherwise.
+  std::unique_ptr<DspFnInfos> takeRetiredDsp() {
+    if (swap_state.load(std::memory_order_acquire) != SwapState::Retired) { return nullptr; }
+    auto res = std::move(swap_prev);
+    swap_state.store(SwapState::Idle, std::memory_order_release);
+    return res;
+  }
+  // Main dsp process function with array of channel pointers. T must match getFloatPrecision().
+  template <typename T>
+  bool process(const T** input, T** output, int framesize) {
+    return measure(framesize, [&]() { return processImpl(input, output, framesize); });
+  }
+  // Interleaved version of main dsp process. Buffers are passed to dsp function as they are if
+  // number of channels matches.
+  template <typename T>
+  bool process(const T* input, T* output, int framesize) {
+    return measure(framesize, [&]() { return processImpl(input, output, framesize); });
+  }
+  // Non-interleaved buffers placed contiguously for each channel(e.g. RtAudio with
+  // RTAUDIO_NONINTERLEAVED). Channel i starts at input + i * framesize.
+  template <typename T>
+  bool processNonInterleaved(const T* input, T* output, int framesize) {
+    return measure(framesize, [&]() {
+      auto& buf = getBuffers<T>();
+      for (int ch = 0; ch < params->in_numchs; ch++) {
+        buf.device_in[ch] = std::next(input, ch * framesize);
+      }
+      for (int ch = 0; ch < params->out_numchs; ch++) {
+        buf.device_out[ch] = std::next(output, ch * framesize);
+      }
+      return processImpl(buf.device_in.data(), buf.device_out.data(), framesize);
+    });
   }
 
  protected:
   inline static constexpr int default_framesize = 256;
+  template <typename T>
+  [[nodiscard]] bool isSampleType() const {
+    static_assert(std::is_same_v<T, double> || std::is_same_v<T, float>,
+                  "sample type must be double or float");
+    return (getFloatPrecision() == FloatPrecision::F32) == std::is_same_v<T, float>;
+  }
+  // (re)allocate buffers and voices for params->audioframesize. called from setup(), and should
+  // be called again if the driver changed the frame size.
+  void allocateBuffers() {
+    voicepool = nullptr;
+    if (numvoices > 1 && dspfninfos->fn != nullptr) {
+      voicepool = std::make_unique<VoicePool>(*dspfninfos, numvoices, numthreads,
+                                              params->audioframesize);
+    }
+    if (getFloatPrecision() == FloatPrecision::F32) {
+      resizeBuffers(buffers_f32);
+    } else {
+      resizeBuffers(buffers_f64);
+    }
+  }
 
  private:
-  std::vector<double> interleaved_in;
-  std::vector<double> interleaved_out;
-  // buffer copy into vector from pointer of poitner
-  static void interleaveSamples(const double** src, std::vector<double>& dest, int framesize,
-                                int dsp_chans, int device_chans) {
-    for (int ch = 0; ch < dsp_chans; ch++) {
-      const auto* samples_ch = *std::next(src, ch);
-      if (ch < device_chans) {
-        for (int count = 0; count < framesize; count++) {
-          dest.at(count + count * ch) = *std::next(samples_ch, count);
-        }
+  template <typename T>
+  bool processImpl(const T** input, T** output, int framesize) {
+    assert(isSampleType<T>());
+    assert(framesize <= params->audioframesize);
+    beginSwapIfPending();
+    if (dspfninfos->fn == nullptr) {
+      return runSpans(framesize, [](int /*pos*/, int /*span*/) {});
+    }
+    // crossfade is done on interleaved buffers.
+    if (hasPlanarDsp() && !is_fading) { return processPlanar(input, output, framesize); }
+    auto& buf = getBuffers<T>();
+    interleave(input, params->in_numchs, buf.in.data(), dspfninfos->in_numchs, framesize);
+    bool res = processBlock(buf.in.data(), buf.out.data(), framesize);
+    deinterleave(buf.out.data(), dspfninfos->out_numchs, output, params->out_numchs, framesize);
+    return res;
+  }
+  template <typename T>
+  bool processImpl(const T* input, T* output, int framesize) {
+    assert(isSampleType<T>());
+    assert(framesize <= params->audioframesize);
+    beginSwapIfPending();
+    if (dspfninfos->fn == nullptr) {
+      return runSpans(framesize, [](int /*pos*/, int /*span*/) {});
+    }
+    const int dsp_ins = dspfninfos->in_numchs;
+    const int dsp_outs = dspfninfos->out_numchs;
+    auto& buf = getBuffers<T>();
+    const T* dspin = input;
+    if (dsp_ins != params->in_numchs) {
+      remapInterleaved(input, params->in_numchs, buf.in.data(), dsp_ins, framesize);
+      dspin = buf.in.data();
+    }
+    const bool directout = dsp_outs == params->out_numchs;
+    bool res = processBlock(dspin, directout ? output : buf.out.data(), framesize);
+    if (!directout) {
+      remapInterleaved(buf.out.data(), dsp_outs, output, params->out_numchs, framesize);
+    }
+    return res;
+  }
+  template <typename T>
+  struct IOBuffers {
+    // interleaved buffers used when the layout or number of channels differs from the device.
+    std::vector<T> in;
+    std::vector<T> out;
+    // for planar dsp: read by inputs without device channel, written by surplus outputs.
+    std::vector<T> zeros;
+    std::vector<T> discard;
+    // output of the old dsp during crossfade.
+    std::vector<T> fade;
+    // channel pointers passed to planar dsp, offset for each span.
+    std::vector<const T*> dsp_in;
+    std::vector<T*> dsp_out;
+    // channel pointers of the device for processNonInterleaved().
+    std::vector<const T*> device_in;
+    std::vector<T*> device_out;
+  };
+  // only the one for current precision is allocated.
+  IOBuffers<double> buffers_f64;
+  IOBuffers<float> buffers_f32;
+  int numvoices = 1;
+  int numthreads = 0;
+  std::unique_ptr<VoicePool> voicepool;
+  bool stats_enabled = false;
+  ProcessStats stats;
+  // accumulated during the current callback.
+  ProcessTiming timing;
+  // Idle -> Pending(set by swapDsp) -> Fading(by the audio thread) -> Retired(by the audio
+  // thread after the crossfade) -> Idle(by takeRetiredDsp). swap_next and swap_prev are owned
+  // by the thread which is allowed to change the state.
+  enum class SwapState { Idle, Pending, Fading, Retired };
+  std::atomic<SwapState> swap_state{SwapState::Idle};
+  std::unique_ptr<DspFnInfos> swap_next;
+  std::unique_ptr<DspFnInfos> swap_prev;
+  int fade_len = 0;
+  // used only by the audio thread.
+  int fade_pos = 0;
+  bool is_fading = false;
+  template <typename T>
+  IOBuffers<T>& getBuffers() {
+    if constexpr (std::is_same_v<T, float>) {
+      return buffers_f32;
+    } else {
+      return buffers_f64;
+    }
+  }
+  template <typename T>
+  void resizeBuffers(IOBuffers<T>& b) {
+    const auto frames = static_cast<size_t>(params->audioframesize);
+    b.in.assign(frames * dspfninfos->in_numchs, 0);
+    b.out.assign(frames * dspfninfos->out_numchs, 0);
+    b.zeros.assign(frames, 0);
+    b.discard.assign(frames, 0);
+    b.fade.assign(frames * dspfninfos->out_numchs, 0);
+    b.dsp_in.resize(dspfninfos->in_numchs);
+    b.dsp_out.resize(dspfninfos->out_numchs);
+    b.device_in.resize(params->in_numchs);
+    b.device_out.resize(params->out_numchs);
+  }
+
+  // copy kernels. each loop walks one of the buffers contiguously without bounds checks so that
+  // the compiler can vectorize it.
+
+  // planar(src_chs channels) to interleaved(dst_chs channels). missing channels are zero.
+  template <typename T>
+  static void interleave(const T* const* src, int src_chs, T* dst, int dst_chs, int frames) {
+    for (int ch = 0; ch < dst_chs; ch++) {
+      if (ch < src_chs) {
+        const T* s = src[ch];  // NOLINT
+        for (int i = 0; i < frames; i++) { dst[i * dst_chs + ch] = s[i]; }  // NOLINT
       } else {
-        for (int count = 0; count < framesize; count++) { dest.at(count + count * ch) = 0; }
+        for (int i = 0; i < frames; i++) { dst[i * dst_chs + ch] = 0; }  // NOLINT
       }
     }
   }
-  // buffer copy into pointer of poitner from vector
-  static void deinterleaveSamples(std::vector<double> const& src, double** dest, int framesize,
-                                  int dsp_chans, int device_chans) {
-    for (int ch = 0; ch < dsp_chans; ch++) {
-      auto* dest_ch = *std::next(dest, ch);
-      if (ch < device_chans) {
-        for (int count = 0; count < framesize; count++) {
-          *std::next(dest_ch, count) = src.at(count + count * ch);
-        }
+  // interleaved(src_chs channels) to planar(dst_chs channels). missing channels are zero.
+  template <typename T>
+  static void deinterleave(const T* src, int src_chs, T* const* dst, int dst_chs, int frames) {
+    for (int ch = 0; ch < dst_chs; ch++) {
+      T* d = dst[ch];  // NOLINT
+      if (ch < src_chs) {
+        for (int i = 0; i < frames; i++) { d[i] = src[i * src_chs + ch]; }  // NOLINT
       } else {
-        std::fill(dest_ch, std::next(dest_ch, framesize), 0);
+        std::fill_n(d, frames, 0);
       }
     }
   }
+  // interleaved to interleaved with different number of channels.
+  template <typename T>
+  static void remapInterleaved(const T* src, int src_chs, T* dst, int dst_chs, int frames) {
+    const int chs = std::min(src_chs, dst_chs);
+    // clearing whole buffer at once is faster than clearing surplus channels for each frame.
+    if (dst_chs > chs) { std::fill_n(dst, frames * dst_chs, 0); }
+    for (int ch = 0; ch < chs; ch++) {
+      for (int i = 0; i < frames; i++) { dst[i * dst_chs + ch] = src[i * src_chs + ch]; }  // NOLINT
+    }
+  }
 
-  template <bool HASDSP>
-  bool processInternal(const double** input, double** output, int framesize) {
-    assert(framesize == params->audioframesize);
-    bool res = true;
-    interleaveSamples(input, interleaved_in, framesize, dspfninfos->in_numchs, params->in_numchs);
-    for (int count = 0; count < framesize; count++) {
-      res &= this->processSample<HASDSP>(interleaved_in.data(), interleaved_out.data());
-    }
-    deinterleaveSamples(interleaved_out, output, framesize, dspfninfos->out_numchs,
-                        params->out_numchs);
+  // The block is split only at the samples where scheduled tasks are due, and each span is
+  // processed at once by processspan(pos, nframes). Due tasks fire before the span, and the time
+  // is advanced after it.
+  template <typename F>
+  bool runSpans(int framesize, F&& processspan) {
+    int pos = 0;
+    while (pos < framesize) {
+      const auto t0 = timestamp();
+      auto span = static_cast<int>(sch.beginSpan(framesize - pos));
+      const auto t1 = timestamp();
+      timing.scheduler += t1 - t0;
+      if (span == 0) {
+        sch.stop();
+        return false;
+      }
+      processspan(pos, span);
+      sch.endSpan(span);
+      timing.dsp += timestamp() - t1;
+      pos += span;
+    }
+    return true;
+  }
+  // monotonic clock in nanoseconds, or 0 if stats are disabled.
+  [[nodiscard]] uint64_t timestamp() const { return stats_enabled ? ProcessStats::now() : 0; }
+  template <typename F>
+  bool measure(int framesize, F&& processfn) {
+    if (!stats_enabled) { return processfn(); }
+    timing = {};
+    const auto start = ProcessStats::now();
+    const bool res = processfn();
+    stats.record(timing, ProcessStats::now() - start, framesize, params->samplerate);
     return res;
   }
-  template <bool HASDSP>
-  bool processSample(const double* input, double* output) {
-    auto shouldstop = sch.incrementTime();
-    if (shouldstop) {
-      sch.stop();
-      return false;
+  // Process interleaved frames.
+  template <typename T>
+  bool processBlock(const T* input, T* output, int framesize) {
+    const int dsp_ins = dspfninfos->in_numchs;
+    const int dsp_outs = dspfninfos->out_numchs;
+    return runSpans(framesize, [&](int pos, int span) {
+      processSpan(std::next(input, pos * dsp_ins), std::next(output, pos * dsp_outs), span);
+    });
+  }
+  template <typename T>
+  void processSpan(const T* input, T* output, int nframes) {
+    if (voicepool) {
+      voicepool->process(output, input, nframes);
+      return;
     }
-    if constexpr (HASDSP) {
-      dspfninfos->fn(output, input, dspfninfos->cls_address, dspfninfos->memobj_address);
+    runDsp(*dspfninfos, input, output, nframes);
+    if (is_fading) { crossfade(input, output, nframes); }
+  }
+  template <typename T>
+  static void runDsp(DspFnInfos const& d, const T* input, T* output, int nframes) {
+    if (d.block_fn != nullptr) {
+      auto* block_fn = reinterpret_cast<DspBlockFnPtrT<T>>(d.block_fn);  // NOLINT
+      block_fn(output, input, nframes, d.cls_address, d.memobj_address);
+      return;
     }
-    return true;
+    // fallback for the module without dsp_block(e.g. LLVM IR emitted by older version).
+    auto* fn = reinterpret_cast<DspFnPtrT<T>>(d.fn);  // NOLINT
+    for (int count = 0; count < nframes; count++) {
+      current_frame_offset = count;
+      fn(std::next(output, count * d.out_numchs), std::next(input, count * d.in_numchs),
+         d.cls_address, d.memobj_address);
+    }
+    current_frame_offset = 0;
   }
-
-  template <bool HASDSP>
-  bool processInternalInterleaved(const double* input, double* output, int framesize) {
-    if constexpr (HASDSP) {
-      int dsp_ins = dspfninfos->in_numchs;
-      int device_ins = params->in_numchs;
-      int dsp_outs = dspfninfos->out_numchs;
-      int device_outs = params->out_numchs;
-      for (int ch = 0; ch < dsp_ins; ch++) {
-        for (int count = 0; count < framesize; count++) {
-          if (ch > device_ins) {
-            interleaved_in[ch + dsp_ins * count] = input[ch + device_ins * count];
-          } else {
-            interleaved_in[ch + dsp_ins * count] = 0;
-          }
-        }
-      }
-      bool res = true;
-      for (int count = 0; count < framesize; count++) {
-        res &= processSample<true>(std::next(interleaved_in.data(), count * dsp_ins),
-                                   std::next(interleaved_out.data(), count * dsp_outs));
+  // called at the beginning of a block.
+  void beginSwapIfPending() {
+    if (swap_state.load(std::memory_order_acquire) != SwapState::Pending) { return; }
+    auto& next = *swap_next;
+    const auto& cur = *dspfninfos;
+    if (next.memobj_layout != 0 && next.memobj_layout == cur.memobj_layout &&
+        next.memobj_size == cur.memobj_size && next.memobj_address != nullptr &&
+        cur.memobj_address != nullptr) {
+      std::memcpy(next.memobj_address, cur.memobj_address, cur.memobj_size);
+    }
+    swap_prev = std::move(dspfninfos);
+    dspfninfos = std::move(swap_next);
+    fade_pos = 0;
+    is_fading = fade_len > 0;
+    swap_state.store(is_fading ? SwapState::Fading : SwapState::Retired,
+                     std::memory_order_release);
+  }
+  // mix the output of the old dsp with linear gain.
+  template <typename T>
+  void crossfade(const T* input, T* output, int nframes) {
+    const int chs = dspfninfos->out_numchs;
+    T* old = getBuffers<T>().fade.data();
+    runDsp(*swap_prev, input, old, nframes);
+    for (int i = 0; i < nframes; i++) {
+      const T gain = std::min(static_cast<T>(fade_pos + i) / static_cast<T>(fade_len), T(1));
+      for (int ch = 0; ch < chs; ch++) {
+        const int idx = i * chs + ch;
+        output[idx] = output[idx] * gain + old[idx] * (1 - gain);  // NOLINT
       }
-      for (int ch = 0; ch < dsp_outs; ch++) {
-        for (int count = 0; count < framesize; count++) {
-          if (ch < device_outs) {
-            output[ch + device_outs * count] = interleaved_out[ch + dsp_outs * count];
-          } else {
-            output[ch + device_outs * count] = 0;
-          }
-        }
+    }
+    fade_pos += nframes;
+    if (fade_pos >= fade_len) {
+      is_fading = false;
+      swap_state.store(SwapState::Retired, std::memory_order_release);
+    }
+  }
+  // Pass the channel pointers of the host to dsp. Channels are remapped by pointers only.
+  template <typename T>
+  bool processPlanar(const T** input, T** output, int framesize) {
+    const auto& d = *dspfninfos;
+    auto& buf = getBuffers<T>();
+    auto* planar_fn = reinterpret_cast<DspPlanarBlockFnPtrT<T>>(d.planar_block_fn);  // NOLINT
+    for (int ch = d.out_numchs; ch < params->out_numchs; ch++) {
+      std::fill_n(output[ch], framesize, 0);  // NOLINT
+    }
+    return runSpans(framesize, [&](int pos, int span) {
+      for (int ch = 0; ch < d.in_numchs; ch++) {
+        const T* base = ch < params->in_numchs ? input[ch] : buf.zeros.data();  // NOLINT
+        buf.dsp_in[ch] = std::next(base, pos);
       }
-      return res;
-    } else {
-      bool res = true;
-      for (int count = 0; count < framesize; count++) {
-        res |= processSample<false>(input, output);
+      for (int ch = 0; ch < d.out_numchs; ch++) {
+        T* base = ch < params->out_numchs ? output[ch] : buf.discard.data();  // NOLINT
+        buf.dsp_out[ch] = std::next(base, pos);
       }
-      return res;
-    }
+      planar_fn(buf.dsp_out.data(), buf.dsp_in.data(), span, d.cls_address, d.memobj_address);
+    });
   }
 };
 }  // namespace mimium
\ No newline at end of file
@@ -0,0 +1,137 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+#include "runtime/backend/offline/driver_offline.hpp"
+#include "runtime/executionengine/executionengine.hpp"
+#include <chrono>
+#include <iostream>
+#include "sndfile.h"
+
+namespace mimium {
+class SndFilePrivate {
+ public:
+  SNDFILE* file = nullptr;
+  SF_INFO info{};
+  ~SndFilePrivate() {
+    if (file != nullptr) { sf_close(file); }
+  }
+};
+
+AudioDriverOffline::AudioDriverOffline(fs::path output_path, std::optional<double> duration,
+                                       std::optional<int> samplerate,
+                                       std::optional<int> framesize)
+    : AudioDriver(),
+      output_path(std::move(output_path)),
+      duration(duration),
+      samplerate(samplerate),
+      framesize(framesize),
+      sndfile(nullptr) {}
+
+AudioDriverOffline::~AudioDriverOffline() = default;
+
+std::unique_ptr<AudioDriverParams> AudioDriverOffline::getDefaultAudioParameter(
+    std::optional<int> samplerate, std::optional<int> framesize) const {
+  assert(dspfninfos != nullptr);
+  int sr = samplerate.value_or(this->samplerate.value_or(default_samplerate));
+  int frames = framesize.value_or(this->framesize.value_or(AudioDriver::default_framesize));
+  return std::make_unique<AudioDriverParams>(
+      AudioDriverParams{static_cast<double>(sr), frames * getSampleSize(), frames,
+                        dspfninfos->in_numchs, dspfninfos->out_numchs});
+}
+
+void AudioDriverOffline::openFile(int numchs) {
+  sndfile = std::make_unique<SndFilePrivate>();
+  auto& info = sndfile->info;
+  info.samplerate = static_cast<int>(params->samplerate);
+  info.channels = numchs;
+  auto ext = output_path.extension().string();
+  if (ext == ".flac") {
+    info.format = SF_FORMAT_FLAC | SF_FORMAT_PCM_24;
+  } else if (ext == ".wav") {
+    info.format = SF_FORMAT_WAV | SF_FORMAT_FLOAT;
+  } else {
+    throw std::runtime_error("Unsupported output file type for offline rendering: \"" + ext +
+                             "\". Use .wav or .flac.");
+  }
+  sndfile->file = sf_open(output_path.string().c_str(), SFM_WRITE, &info);
+  if (sndfile->file == nullptr) {
+    throw std::runtime_error("Failed to open " + output_path.string() + ": " +
+                             sf_strerror(nullptr));
+  }
+}
+
+void AudioDriverOffline::closeFile() {
+  const int err = sf_close(sndfile->file);
+  sndfile->file = nullptr;
+  sndfile = nullptr;
+  if (err != 0) {
+    throw std::runtime_error("Failed to close " + output_path.string() + ": " +
+                             sf_error_number(err));
+  }
+}
+
+void AudioDriverOffline::printRenderInfo(int64_t frames, double elapsed_sec) const {
+  const double rendered_sec = static_cast<double>(frames) / params->samplerate;
+  // the result of the rendering, always shown unlike the logs.
+  std::cerr << "Rendered " << rendered_sec << " sec(" << frames << " frames) to "
+            << output_path.string() << " in " << elapsed_sec << " sec. Realtime Factor : "
+            << rendered_sec / elapsed_sec << "x" << std::endl;
+}
+
+template <typename T>
+int64_t AudioDriverOffline::render(int64_t total_frames) {
+  const int frames = params->audioframesize;
+  std::vector<T> inbuf(static_cast<size_t>(frames) * params->in_numchs, 0.0);
+  std::vector<T> outbuf(static_cast<size_t>(frames) * params->out_numchs, 0.0);
+  int64_t count = 0;
+  while (count < total_frames) {
+    const bool shouldcontinue = process(inbuf.data(), outbuf.data(), frames);
+    const auto towrite = std::min<int64_t>(frames, total_frames - count);
+    if (sndfile != nullptr) {
+      sf_count_t written = 0;
+      if constexpr (std::is_same_v<T, float>) {
+        written = sf_writef_float(sndfile->file, outbuf.data(), towrite);
+      } else {
+        written = sf_writef_double(sndfile->file, outbuf.data(), towrite);
+      }
+      if (written != towrite) {
+        throw std::runtime_error("Failed to write " + output_path.string() + ": " +
+                                 sf_strerror(sndfile->file));
+      }
+    }
+    count += towrite;
+    if (!shouldcontinue) { break; }
+  }
+  return count;
+}
+
+bool AudioDriverOffline::start() {
+  AudioDriver::start();
+  const bool hasdsp = dspfninfos->fn != nullptr;
+  if (hasdsp && !duration) {
+    throw std::runtime_error("--duration must be specified to render dsp function offline.");
+  }
+  if (params->out_numchs > 0) { openFile(params->out_numchs); }
+  const auto total_frames = duration ? static_cast<int64_t>(duration.value() * params->samplerate)
+                                     : std::numeric_limits<int64_t>::max();
+  sch.start(hasdsp);
+  auto begin = std::chrono::steady_clock::now();
+  const auto count = getFloatPrecision() == FloatPrecision::F32 ? render<float>(total_frames)
+                                                                : render<double>(total_frames);
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - begin;
+  // nothing is written when dsp has no output.
+  if (sndfile != nullptr) {
+    closeFile();
+    printRenderInfo(count, elapsed.count());
+  }
+  sch.stop();  // notify to exit runtime
+  return true;
+}
+
+bool AudioDriverOffline::stop() {
+  sch.stop();
+  return true;
+}
+
+}  // namespace mimium
@@ -0,0 +1,41 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+#pragma once
+#include "runtime/backend/audiodriver.hpp"
+#include "utils/include_filesystem.hpp"
+
+namespace mimium {
+class SndFilePrivate;
+
+// Audio driver without audio device. It pulls process() as fast as possible and writes output
+// into a sound file(format is chosen from the extension, wav or flac).
+class MIMIUM_DLL_PUBLIC AudioDriverOffline : public AudioDriver {
+ public:
+  explicit AudioDriverOffline(fs::path output_path, std::optional<double> duration = std::nullopt,
+                              std::optional<int> samplerate = std::nullopt,
+                              std::optional<int> framesize = std::nullopt);
+  ~AudioDriverOffline() override;
+  // renders synchronously until the duration is reached or scheduler stops.
+  bool start() override;
+  bool stop() override;
+  [[nodiscard]] std::unique_ptr<AudioDriverParams> getDefaultAudioParameter(
+      std::optional<int> samplerate, std::optional<int> framesize) const override;
+
+ private:
+  fs::path output_path;
+  std::optional<double> duration;
+  std::optional<int> samplerate;
+  std::optional<int> framesize;
+  std::unique_ptr<SndFilePrivate> sndfile;
+  // throw if the file can not be opened or closed.
+  void openFile(int numchs);
+  void closeFile();
+  void printRenderInfo(int64_t frames, double elapsed_sec) const;
+  // process and write blocks with the sample type of dsp function. returns rendered frames.
+  template <typename T>
+  int64_t render(int64_t total_frames);
+  inline static constexpr int default_samplerate = 48000;
+};
+}  // namespace mimium
@@ -0,0 +1,138 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+#include "process_stats.hpp"
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <ostream>
+#include <sstream>
+#include <string_view>
+
+namespace mimium {
+
+namespace {
+std::string formatDuration(uint64_t ns) {
+  std::ostringstream ss;
+  ss << std::fixed << std::setprecision(1);
+  if (ns < 1000) {
+    ss << ns << "ns";
+  } else if (ns < 1000 * 1000) {
+    ss << static_cast<double>(ns) / 1e3 << "us";
+  } else {
+    ss << static_cast<double>(ns) / 1e6 << "ms";
+  }
+  return ss.str();
+}
+std::string formatPermille(uint64_t permille) {
+  std::ostringstream ss;
+  ss << std::fixed << std::setprecision(1) << static_cast<double>(permille) / 10.0 << "%";
+  return ss.str();
+}
+template <typename F>
+std::string formatPercentiles(std::string_view name, LatencyHistogram::Snapshot const& s,
+                              F&& format) {
+  return std::string(name) + " p50 " + format(s.percentile(50)) + " p99 " +
+         format(s.percentile(99)) + " p99.9 " + format(s.percentile(99.9)) + " max " +
+         format(s.max);
+}
+}  // namespace
+
+uint64_t LatencyHistogram::Snapshot::percentile(double p) const {
+  if (count == 0) { return 0; }
+  const auto rank = std::max<uint64_t>(
+      1, static_cast<uint64_t>(std::ceil(p / 100.0 * static_cast<double>(count))));
+  uint64_t acc = 0;
+  for (size_t i = 0; i < num_buckets; i++) {
+    acc += counts[i];
+    if (acc >= rank) {
+      if (i + 1 == num_buckets) { return max; }
+      // the largest value in the bucket, but no more than the recorded maximum.
+      return std::min(bucketLowerBound(i + 1) - 1, max);
+    }
+  }
+  return max;
+}
+
+LatencyHistogram::Snapshot LatencyHistogram::Snapshot::operator-(Snapshot const& prev) const {
+  Snapshot res;
+  for (size_t i = 0; i < num_buckets; i++) { res.counts[i] = counts[i] - prev.counts[i]; }
+  res.count = count - prev.count;
+  res.max = max;
+  return res;
+}
+
+LatencyHistogram::Snapshot LatencyHistogram::snapshot() const {
+  Snapshot res;
+  for (size_t i = 0; i < num_buckets; i++) {
+    res.counts[i] = counts[i].load(std::memory_order_relaxed);
+    res.count += res.counts[i];
+  }
+  res.max = max.load(std::memory_order_relaxed);
+  return res;
+}
+
+ProcessStatsSnapshot ProcessStatsSnapshot::operator-(ProcessStatsSnapshot const& prev) const {
+  return ProcessStatsSnapshot{dsp - prev.dsp,
+                              scheduler - prev.scheduler,
+                              io - prev.io,
+                              callback - prev.callback,
+                              load - prev.load,
+                              callbacks - prev.callbacks,
+                              deadline_misses - prev.deadline_misses,
+                              xruns - prev.xruns};
+}
+
+std::string ProcessStatsSnapshot::toString() const {
+  std::string res = "callbacks " + std::to_string(callbacks) + " / deadline misses " +
+                    std::to_string(deadline_misses) + " / xruns " + std::to_string(xruns) + "\n";
+  res += "  " + formatPercentiles("load    ", load, formatPermille) + "\n";
+  res += "  " + formatPercentiles("callback", callback, formatDuration) + "\n";
+  res += "  " + formatPercentiles("dsp     ", dsp, formatDuration) + "\n";
+  res += "  " + formatPercentiles("schedule", scheduler, formatDuration) + "\n";
+  res += "  " + formatPercentiles("io      ", io, formatDuration) + "\n";
+  return res;
+}
+
+ProcessStatsSnapshot ProcessStats::snapshot() const {
+  // counters are read before histograms, so that they never exceed the histogram counts.
+  ProcessStatsSnapshot res;
+  res.callbacks = callbacks.load(std::memory_order_acquire);
+  res.deadline_misses = deadline_misses.load(std::memory_order_relaxed);
+  res.xruns = xruns.load(std::memory_order_relaxed);
+  res.dsp = dsp.snapshot();
+  res.scheduler = scheduler.snapshot();
+  res.io = io.snapshot();
+  res.callback = callback.snapshot();
+  res.load = load.snapshot();
+  return res;
+}
+
+ProcessStatsReporter::ProcessStatsReporter(ProcessStats const& stats, std::ostream& out,
+                                           std::chrono::milliseconds interval)
+    : stats(stats), out(out), interval(interval) {
+  thread = std::thread([this]() { loop(); });
+}
+
+ProcessStatsReporter::~ProcessStatsReporter() {
+  {
+    std::lock_guard<std::mutex> lock(mtx);
+    quit = true;
+  }
+  cv.notify_all();
+  thread.join();
+  out << "[stats] total: " << stats.snapshot().toString() << std::flush;
+}
+
+void ProcessStatsReporter::loop() {
+  ProcessStatsSnapshot prev;
+  std::unique_lock<std::mutex> lock(mtx);
+  while (!cv.wait_for(lock, interval, [this]() { return quit; })) {
+    auto cur = stats.snapshot();
+    out << "[stats] " << (cur - prev).toString() << std::flush;
+    prev = cur;
+  }
+}
+
+}  // namespace mimium
@@ -0,0 +1,142 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+#pragma once
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <iosfwd>
+#include <mutex>
+#include <string>
+#include <thread>
+#include "export.hpp"
+
+namespace mimium {
+
+// Histogram of durations in nanoseconds with logarithmic buckets(4 buckets per octave, so a
+// percentile is accurate within 25%). record() is wait-free and called from the audio thread
+// while another thread reads it with snapshot().
+class MIMIUM_DLL_PUBLIC LatencyHistogram {
+ public:
+  static constexpr size_t num_buckets = 252;
+  struct Snapshot {
+    std::array<uint64_t, num_buckets> counts{};
+    uint64_t count = 0;
+    uint64_t max = 0;  // since the start, not reset by subtraction.
+    // upper bound of the bucket which contains p-th percentile(0-100). 0 if empty.
+    [[nodiscard]] uint64_t percentile(double p) const;
+    // counts recorded between prev and this.
+    [[nodiscard]] Snapshot operator-(Snapshot const& prev) const;
+  };
+  // only one thread may record at a time.
+  void record(uint64_t ns) {
+    counts[bucketOf(ns)].fetch_add(1, std::memory_order_relaxed);
+    if (ns > max.load(std::memory_order_relaxed)) { max.store(ns, std::memory_order_relaxed); }
+  }
+  [[nodiscard]] Snapshot snapshot() const;
+  static size_t bucketOf(uint64_t ns) {
+    if (ns < 4) { return static_cast<size_t>(ns); }
+    int msb = 0;
+    for (uint64_t v = ns; v > 1; v >>= 1) { msb++; }
+    // 2 bits below the most significant bit select a sub-bucket in the octave.
+    const auto sub = static_cast<size_t>((ns >> (msb - 2)) & 3U);
+    return static_cast<size_t>(msb - 1) * 4 + sub;
+  }
+  static uint64_t bucketLowerBound(size_t index) {
+    if (index < 4) { return index; }
+    const auto msb = index / 4 + 1;
+    return (4 + index % 4) << (msb - 2);
+  }
+
+ private:
+  std::array<std::atomic<uint64_t>, num_buckets> counts{};
+  std::atomic<uint64_t> max{0};
+};
+
+// time spent in each stage of a callback, accumulated over the spans.
+struct ProcessTiming {
+  uint64_t dsp = 0;
+  uint64_t scheduler = 0;
+};
+
+struct ProcessStatsSnapshot {
+  LatencyHistogram::Snapshot dsp;
+  LatencyHistogram::Snapshot scheduler;
+  LatencyHistogram::Snapshot io;
+  LatencyHistogram::Snapshot callback;
+  // time of callback relative to the duration of the buffer, in permille.
+  LatencyHistogram::Snapshot load;
+  uint64_t callbacks = 0;
+  uint64_t deadline_misses = 0;  // callbacks took longer than the duration of the buffer
+  uint64_t xruns = 0;            // underflow/overflow reported by the audio device
+  [[nodiscard]] ProcessStatsSnapshot operator-(ProcessStatsSnapshot const& prev) const;
+  // percentiles of each stage in a line, like "dsp p50 12.0us p99 ...".
+  [[nodiscard]] std::string toString() const;
+};
+
+// Timing of audio callbacks measured by AudioDriver. Written only from the audio thread, and
+// read from others through snapshot().
+class MIMIUM_DLL_PUBLIC ProcessStats {
+ public:
+  using Clock = std::chrono::steady_clock;
+  static uint64_t now() {
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch())
+            .count());
+  }
+  // total_ns is the whole callback. the rest of dsp and scheduler is counted as io(copying
+  // buffers between the device and dsp).
+  void record(ProcessTiming const& t, uint64_t total_ns, int framesize, double samplerate) {
+    const uint64_t inner = t.dsp + t.scheduler;
+    dsp.record(t.dsp);
+    scheduler.record(t.scheduler);
+    io.record(total_ns > inner ? total_ns - inner : 0);
+    callback.record(total_ns);
+    const double period_ns = framesize * 1e9 / samplerate;
+    load.record(static_cast<uint64_t>(static_cast<double>(total_ns) * 1000.0 / period_ns));
+    if (static_cast<double>(total_ns) > period_ns) {
+      deadline_misses.fetch_add(1, std::memory_order_relaxed);
+    }
+    callbacks.fetch_add(1, std::memory_order_release);
+  }
+  // may be called from any thread.
+  void reportXrun() { xruns.fetch_add(1, std::memory_order_relaxed); }
+  [[nodiscard]] uint64_t getXruns() const { return xruns.load(std::memory_order_relaxed); }
+  [[nodiscard]] ProcessStatsSnapshot snapshot() const;
+
+ private:
+  LatencyHistogram dsp;
+  LatencyHistogram scheduler;
+  LatencyHistogram io;
+  LatencyHistogram callback;
+  LatencyHistogram load;
+  std::atomic<uint64_t> callbacks{0};
+  std::atomic<uint64_t> deadline_misses{0};
+  std::atomic<uint64_t> xruns{0};
+};
+
+// Prints the statistics of the last interval periodically from its own thread, so that nothing
+// is written from the audio thread. Stops and prints the total on destruction.
+class MIMIUM_DLL_PUBLIC ProcessStatsReporter {
+ public:
+  ProcessStatsReporter(ProcessStats const& stats, std::ostream& out,
+                       std::chrono::milliseconds interval = std::chrono::milliseconds(1000));
+  ~ProcessStatsReporter();
+  ProcessStatsReporter(ProcessStatsReporter const&) = delete;
+  ProcessStatsReporter& operator=(ProcessStatsReporter const&) = delete;
+
+ private:
+  ProcessStats const& stats;
+  std::ostream& out;
+  std::chrono::milliseconds interval;
+  bool quit = false;
+  std::mutex mtx;
+  std::condition_variable cv;
+  std::thread thread;
+  void loop();
+};
+
+}  // namespace mimium
@@ -3,20 +3,33 @@
  * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
 
 #include "runtime/backend/rtaudio/driver_rtaudio.hpp"
+#include "basic/rt_logger.hpp"
 #include "runtime/executionengine/executionengine.hpp"
 #include "RtAudio.h"
 
 namespace {
+template <typename T>
+void processStream(mimium::AudioDriverRtAudio* driver, void* output, void* input, int n_frames) {
+  const auto* in = static_cast<const T*>(input);
+  auto* out = static_cast<T*>(output);
+  if (driver->isNonInterleaved()) {
+    driver->processNonInterleaved(in, out, n_frames);
+  } else {
+    driver->process(in, out, n_frames);
+  }
+}
 const RtAudioCallback callback = [](void* output, void* input, unsigned int n_frames,
                                     double /*time*/, RtAudioStreamStatus status,
                                     void* userdata) -> int {
   auto* driver = static_cast<mimium::AudioDriverRtAudio*>(userdata);
-  // Process interleaved audio data.
-  driver->process(static_cast<const double*>(input), static_cast<double*>(output),
-                  static_cast<int>(n_frames));
-  if (status > 0) {
-    mimium::Logger::debug_log("Stream underflow detected!", mimium::Logger::WARNING);
+  mimium::RtLogger::setRealtimeThread(true);
+  // the stream is opened with the sample format and layout of dsp function.
+  if (driver->getFloatPrecision() == mimium::FloatPrecision::F32) {
+    processStream<float>(driver, output, input, static_cast<int>(n_frames));
+  } else {
+    processStream<double>(driver, output, input, static_cast<int>(n_frames));
   }
+  if (status > 0) { driver->reportXrun(); }
   return status;
 };
 
@@ -92,13 +105,16 @@ std::unique_ptr<AudioDriverParams> AudioDriverRtAudio::getDefaultAudioParameter(
   int sr = samplerate.value_or(getPreferredSampleRate());
   int frames = framesize.value_or(AudioDriver::default_framesize);
   return std::make_unique<AudioDriverParams>(AudioDriverParams{
-      static_cast<double>(sr), static_cast<int>(frames * sizeof(double)), frames, in_chs, out_chs});
+      static_cast<double>(sr), frames * getSampleSize(), frames, in_chs, out_chs});
 }
 
 bool AudioDriverRtAudio::start() {
   try {
     AudioDriver::start();
     rtaudio_options->get().streamName = "mimium";
+    // host buffers are passed to dsp directly without interleaving.
+    noninterleaved = hasPlanarDsp();
+    if (noninterleaved) { rtaudio_options->get().flags |= RTAUDIO_NONINTERLEAVED; }
 
     rtaudio_params_input->get().nChannels = params->in_numchs;
     rtaudio_params_output->get().nChannels = params->out_numchs;
@@ -110,10 +126,15 @@ bool AudioDriverRtAudio::start() {
     }
     // check parameter are valid
     unsigned int framesize = params->audioframesize;
-    rtaudio->openStream(oparam, iparam, RTAUDIO_FLOAT64, params->samplerate, &framesize, callback,
-                        this, &rtaudio_options->get(), nullptr);
+    const RtAudioFormat format =
+        getFloatPrecision() == FloatPrecision::F32 ? RTAUDIO_FLOAT32 : RTAUDIO_FLOAT64;
+    rtaudio->openStream(oparam, iparam, format, params->samplerate, &framesize, callback, this,
+                        &rtaudio_options->get(), nullptr);
+    if (static_cast<int>(framesize) != params->audioframesize) {
+      params->audioframesize = static_cast<int>(framesize);
+      allocateBuffers();
+    }
     printStreamInfo();
-    params->audioframesize = framesize;
 
     bool hasdsp = dspfninfos->fn != nullptr;
     sch.start(hasdsp);
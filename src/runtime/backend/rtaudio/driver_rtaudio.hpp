@@ -20,12 +20,15 @@ class MIMIUM_DLL_PUBLIC AudioDriverRtAudio : public AudioDriver {
   bool stop() override;
   [[nodiscard]] std::unique_ptr<AudioDriverParams> getDefaultAudioParameter(
       std::optional<int> samplerate, std::optional<int> framesize)const override;
+  // true if the stream was opened with RTAUDIO_NONINTERLEAVED.
+  [[nodiscard]] bool isNonInterleaved() const { return noninterleaved; }
 
  private:
   std::unique_ptr<RtAudio> rtaudio;
   std::unique_ptr<StreamParametersPrivate> rtaudio_params_input;
   std::unique_ptr<StreamParametersPrivate> rtaudio_params_output;
   std::unique_ptr<StreamOptionsPrivate> rtaudio_options;
+  bool noninterleaved = false;
   bool setCallback();
   std::vector<std::unique_ptr<std::vector<double>>> in_buffer;
   std::vector<std::unique_ptr<std::vector<double>>> out_buffer;
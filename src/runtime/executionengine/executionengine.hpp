@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include "basic/codegen_option.hpp"
 #include "export.hpp"
 
 namespace mimium {
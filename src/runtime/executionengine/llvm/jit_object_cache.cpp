@@ -0,0 +1,97 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+#include "jit_object_cache.hpp"
+#include <algorithm>
+#include <fstream>
+#include <vector>
+#include "basic/helper_functions.hpp"
+#include "llvm/Support/MemoryBuffer.h"
+
+namespace {
+constexpr std::string_view cache_ext = ".o";
+}
+
+namespace mimium {
+
+JitObjectCache::JitObjectCache(JitCacheOption option) : option(std::move(option)) {
+  std::error_code ec;
+  fs::create_directories(this->option.directory, ec);
+  if (ec) {
+    Logger::debug_log("Failed to create jit cache directory: " + ec.message(), Logger::WARNING);
+  }
+}
+
+void JitObjectCache::registerModule(const llvm::Module* m, std::string const& key) {
+  std::lock_guard<std::mutex> lock(mtx);
+  keys.insert_or_assign(m, key);
+}
+
+std::optional<fs::path> JitObjectCache::getPath(const llvm::Module* m) {
+  std::lock_guard<std::mutex> lock(mtx);
+  auto iter = keys.find(m);
+  if (iter == keys.end()) { return std::nullopt; }
+  return option.directory / (iter->second + std::string(cache_ext));
+}
+
+bool JitObjectCache::hasObject(const llvm::Module* m) {
+  auto path = getPath(m);
+  std::error_code ec;
+  return path && fs::exists(path.value(), ec);
+}
+
+std::unique_ptr<llvm::MemoryBuffer> JitObjectCache::getObject(const llvm::Module* m) {
+  last_hit = false;
+  auto path = getPath(m);
+  if (!path) { return nullptr; }
+  auto buf = llvm::MemoryBuffer::getFile(path->string());
+  if (!buf) { return nullptr; }
+  // update timestamp so that frequently used objects survive pruning.
+  std::error_code ec;
+  fs::last_write_time(path.value(), fs::file_time_type::clock::now(), ec);
+  last_hit = true;
+  return std::move(buf.get());
+}
+
+void JitObjectCache::notifyObjectCompiled(const llvm::Module* m, llvm::MemoryBufferRef obj) {
+  auto path = getPath(m);
+  if (!path) { return; }
+  {
+    std::ofstream out(path.value(), std::ios::binary);
+    out.write(obj.getBufferStart(), static_cast<std::streamsize>(obj.getBufferSize()));
+    if (!out) {
+      Logger::debug_log("Failed to write jit cache " + path->string(), Logger::WARNING);
+      return;
+    }
+  }
+  prune();
+}
+
+void JitObjectCache::prune() {
+  struct Entry {
+    fs::path path;
+    fs::file_time_type time;
+    uintmax_t size;
+  };
+  std::vector<Entry> entries;
+  uintmax_t total = 0;
+  std::error_code ec;
+  for (const auto& f : fs::directory_iterator(option.directory, ec)) {
+    if (f.path().extension() != cache_ext) { continue; }
+    auto size = f.file_size(ec);
+    auto time = f.last_write_time(ec);
+    if (ec) { continue; }
+    entries.push_back({f.path(), time, size});
+    total += size;
+  }
+  if (total <= option.size_limit) { return; }
+  std::sort(entries.begin(), entries.end(),
+            [](Entry const& a, Entry const& b) { return a.time < b.time; });
+  for (auto& e : entries) {
+    if (total <= option.size_limit) { break; }
+    if (fs::remove(e.path, ec)) { total -= e.size; }
+  }
+}
+
+}  // namespace mimium
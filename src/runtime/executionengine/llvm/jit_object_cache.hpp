@@ -0,0 +1,47 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+#pragma once
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include "llvm/ExecutionEngine/ObjectCache.h"
+#include "utils/include_filesystem.hpp"
+
+namespace mimium {
+
+// settings for persistent cache of jit-compiled objects.
+struct JitCacheOption {
+  fs::path directory;
+  // in bytes. least recently used objects are removed when the total size exceeds this.
+  uint64_t size_limit;
+};
+
+// ObjectCache which stores compiled objects as files in the cache directory.
+// A module is cached only when a key is registered for it, so that modules without stable
+// identity are always compiled.
+class JitObjectCache : public llvm::ObjectCache {
+ public:
+  explicit JitObjectCache(JitCacheOption option);
+  // key should contain everything affects to the compiled object (source, optimization level,
+  // target triple...).
+  void registerModule(const llvm::Module* m, std::string const& key);
+  [[nodiscard]] bool hasObject(const llvm::Module* m);
+  void notifyObjectCompiled(const llvm::Module* m, llvm::MemoryBufferRef obj) override;
+  std::unique_ptr<llvm::MemoryBuffer> getObject(const llvm::Module* m) override;
+  // whether the last object was loaded from cache. used for reporting startup time.
+  [[nodiscard]] bool isLastHit() const { return last_hit; }
+
+ private:
+  std::optional<fs::path> getPath(const llvm::Module* m);
+  void prune();
+  JitCacheOption option;
+  std::mutex mtx;
+  std::unordered_map<const llvm::Module*, std::string> keys;
+  bool last_hit = false;
+};
+
+}  // namespace mimium
@@ -3,40 +3,101 @@
  * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
 
 #include "llvm_jitengine.hpp"
+#include <chrono>
 #include <llvm/IRReader/IRReader.h>
+#include <llvm/Support/MemoryBuffer.h>
 #include "basic/error_def.hpp"
 #include "mimium_llvm_orcjit.hpp"
 namespace mimium {
+namespace {
+void initNativeTarget() {
+  llvm::InitializeNativeTarget();
+  llvm::InitializeNativeTargetAsmPrinter();
+  llvm::InitializeNativeTargetAsmParser();
+  llvm::InitializeNativeTargetDisassembler();
+}
+}  // namespace
+
 LLVMJitExecutionEngine::LLVMJitExecutionEngine(std::unique_ptr<llvm::LLVMContext> ctx,
                                                std::unique_ptr<llvm::Module> module,
-                                               std::string const& /*filename_i*/, bool optimize)
-    : ExecutionEngine(), module(std::move(module)) {
-  initInternal(std::move(ctx), optimize);
+                                               std::string const& /*filename_i*/,
+                                               OptimizeLevel level,
+                                               std::optional<JitCacheOption> cache,
+                                               std::optional<uint64_t> source_hash,
+                                               JitCompileOption compile_option)
+    : ExecutionEngine(), module(std::move(module)), source_hash(source_hash) {
+  initInternal(std::move(ctx), level, std::move(cache), compile_option);
+}
+
+LLVMJitExecutionEngine::LLVMJitExecutionEngine(std::shared_ptr<llvm::orc::MimiumJIT> jit,
+                                               std::unique_ptr<llvm::LLVMContext> ctx,
+                                               std::unique_ptr<llvm::Module> module,
+                                               std::optional<uint64_t> source_hash)
+    : ExecutionEngine(),
+      ctx(std::move(ctx)),
+      module(std::move(module)),
+      source_hash(source_hash),
+      jitengine(std::move(jit)),
+      dylib(&jitengine->createDylib()),
+      is_shared(true) {}
+
+std::shared_ptr<llvm::orc::MimiumJIT> LLVMJitExecutionEngine::createSharedJit(
+    OptimizeLevel level, JitCompileOption compile_option) {
+  initNativeTarget();
+  return std::make_shared<llvm::orc::MimiumJIT>(level, std::nullopt, compile_option);
 }
 
-LLVMJitExecutionEngine::LLVMJitExecutionEngine(std::string const& filepath, bool optimize)
+LLVMJitExecutionEngine::LLVMJitExecutionEngine(std::string const& filepath, OptimizeLevel level,
+                                               std::optional<JitCacheOption> cache,
+                                               JitCompileOption compile_option)
     : ExecutionEngine(), module() {
   auto ctx = std::make_unique<llvm::LLVMContext>();
   llvm::SMDiagnostic errorreporter;
-  module = llvm::parseIRFile(filepath, errorreporter, *ctx);
-  initInternal(std::move(ctx), optimize);
+  auto buf = llvm::MemoryBuffer::getFile(filepath);
+  if (buf) {
+    source_hash = llvm::xxHash64(buf.get()->getBuffer());
+    module = llvm::parseIR(buf.get()->getMemBufferRef(), errorreporter, *ctx);
+  }
+  if (module == nullptr) { throw mimium::RuntimeError("Failed to load llvm ir " + filepath); }
+  initInternal(std::move(ctx), level, std::move(cache), compile_option);
+}
+LLVMJitExecutionEngine::~LLVMJitExecutionEngine() {
+  if (is_shared) {
+    if (auto err = jitengine->removeDylib(*dylib)) { llvm::consumeError(std::move(err)); }
+  }
 }
-LLVMJitExecutionEngine::~LLVMJitExecutionEngine() = default;
 
-void LLVMJitExecutionEngine::initInternal(std::unique_ptr<llvm::LLVMContext> ctx, bool optimize) {
-  llvm::InitializeNativeTarget();
-  llvm::InitializeNativeTargetAsmPrinter();
-  llvm::InitializeNativeTargetAsmParser();
-  llvm::InitializeNativeTargetDisassembler();
-  using optlevel = llvm::orc::MimiumJIT::OptimizeLevel;
-  auto opt = optimize ? optlevel::NORMAL : optlevel::NO;
-  jitengine = std::make_unique<llvm::orc::MimiumJIT>(std::move(ctx), opt);
+void LLVMJitExecutionEngine::initInternal(std::unique_ptr<llvm::LLVMContext> ctx,
+                                          OptimizeLevel level,
+                                          std::optional<JitCacheOption> cache,
+                                          JitCompileOption compile_option) {
+  initNativeTarget();
+  this->ctx = std::move(ctx);
+  jitengine = std::make_shared<llvm::orc::MimiumJIT>(level, std::move(cache), compile_option);
+  dylib = &jitengine->getMainJITDylib();
+}
+void LLVMJitExecutionEngine::setPassTimer(PassTimer* timer) {
+  passtimer = timer;
+  jitengine->setPassTimer(timer);
 }
 bool LLVMJitExecutionEngine::runMainFunction(Runtime* runtime_ptr) {
   assert(module != nullptr);
-  llvm::Error err = jitengine->addModule(std::move(this->module));
-  if (err) { llvm::errs() << err << "\n"; };
-  auto mainfun = jitengine->lookup("mimium_main");
+  auto start = std::chrono::steady_clock::now();
+  auto mainfun = [&]() {
+    // includes optimization, which is also reported separately.
+    PassTimer::Scope t(passtimer, "jit", "compile");
+    llvm::Error err = jitengine->addModule(
+        llvm::orc::ThreadSafeModule(std::move(this->module), std::move(this->ctx)), *dylib,
+        source_hash);
+    if (err) { llvm::errs() << err << "\n"; };
+    // the module is compiled(or loaded from cache) on the first lookup. lazy jit compiles
+    // mimium_main and the functions it refers on the first call instead.
+    return jitengine->lookup(*dylib, "mimium_main");
+  }();
+  std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+  Logger::debug_log("JIT compilation took " + std::to_string(elapsed.count()) + "ms" +
+                        (jitengine->isLastObjectCached() ? " (loaded from cache)" : ""),
+                    Logger::INFO);
 
   if (!mainfun) {
     std::string tmpout;
@@ -47,10 +108,11 @@ bool LLVMJitExecutionEngine::runMainFunction(Runtime* runtime_ptr) {
 
   auto mimium_main_function =
       llvm::jitTargetAddressToPointer<void* (*)(void*)>(mainfun->getAddress());
-  //
-  mimium_main_function(runtime_ptr);
-  //
-  auto symbol_or_error = jitengine->lookup("dsp");
+  {
+    PassTimer::Scope t(passtimer, "jit", "run mimium_main");
+    mimium_main_function(runtime_ptr);
+  }
+  auto symbol_or_error = jitengine->lookup(*dylib, "dsp");
   if (!symbol_or_error) {
     auto dsperr = symbol_or_error.takeError();
     Logger::debug_log("dsp function not found", Logger::INFO);
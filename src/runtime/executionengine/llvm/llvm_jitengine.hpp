@@ -4,34 +4,64 @@
 
 #pragma once
 #include <memory>
+#include <optional>
 #include <string>
 #include "runtime/executionengine/executionengine.hpp"
+#include "runtime/executionengine/llvm/jit_object_cache.hpp"
 
 namespace llvm {
 class LLVMContext;
 class Module;
 namespace orc {
 class MimiumJIT;
-}
+class JITDylib;
+}  // namespace orc
 }  // namespace llvm
 
 namespace mimium {
+class PassTimer;
 
 class MIMIUM_DLL_PUBLIC LLVMJitExecutionEngine : public ExecutionEngine {
  public:
+  // source_hash is used as a key of the object cache. (see Compiler::getSourceHash())
   explicit LLVMJitExecutionEngine(std::unique_ptr<llvm::LLVMContext> ctx,
                                   std::unique_ptr<llvm::Module>,
                                   std::string const& filename = "untitled.mmm",
-                                  bool optimize = true);
-  explicit LLVMJitExecutionEngine(std::string const& filepath, bool optimize = true);
+                                  OptimizeLevel level = OptimizeLevel::O2,
+                                  std::optional<JitCacheOption> cache = std::nullopt,
+                                  std::optional<uint64_t> source_hash = std::nullopt,
+                                  JitCompileOption compile_option = {});
+  // the hash of the llvm ir file itself is used as a cache key.
+  explicit LLVMJitExecutionEngine(std::string const& filepath,
+                                  OptimizeLevel level = OptimizeLevel::O2,
+                                  std::optional<JitCacheOption> cache = std::nullopt,
+                                  JitCompileOption compile_option = {});
+  // runs the module in a new dylib of the jit shared with other engines, which saves creating
+  // the jit for each source. the engines may be used from different threads.
+  explicit LLVMJitExecutionEngine(std::shared_ptr<llvm::orc::MimiumJIT> jit,
+                                  std::unique_ptr<llvm::LLVMContext> ctx,
+                                  std::unique_ptr<llvm::Module>,
+                                  std::optional<uint64_t> source_hash = std::nullopt);
   ~LLVMJitExecutionEngine() override;
+  // jit to be passed to the constructor above.
+  static std::shared_ptr<llvm::orc::MimiumJIT> createSharedJit(
+      OptimizeLevel level = OptimizeLevel::O2, JitCompileOption compile_option = {});
   bool runMainFunction(Runtime* runtime_ptr) override;
+  // measure jit compilation and optimization passes for --time-passes. null disables it.
+  void setPassTimer(PassTimer* timer);
 
  private:
   // called by constructor.
-  void initInternal(std::unique_ptr<llvm::LLVMContext> ctx, bool optimize);
+  void initInternal(std::unique_ptr<llvm::LLVMContext> ctx, OptimizeLevel level,
+                    std::optional<JitCacheOption> cache, JitCompileOption compile_option);
+  std::unique_ptr<llvm::LLVMContext> ctx;
   std::unique_ptr<llvm::Module> module;
-  std::unique_ptr<llvm::orc::MimiumJIT> jitengine;
+  std::optional<uint64_t> source_hash;
+  std::shared_ptr<llvm::orc::MimiumJIT> jitengine;
+  // main dylib of the jit if it is owned by this engine, otherwise created for this engine.
+  llvm::orc::JITDylib* dylib = nullptr;
+  bool is_shared = false;
+  PassTimer* passtimer = nullptr;
 };
 
 }  // namespace mimium
\ No newline at end of file
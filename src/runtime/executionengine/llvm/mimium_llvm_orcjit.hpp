@@ -3,11 +3,13 @@
  * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
 
 #pragma once
+#include <atomic>
 #include <iostream>
 #include <memory>
 
 #include "llvm/ADT/StringRef.h"
 #include "llvm/ExecutionEngine/JITSymbol.h"
+#include "llvm/ExecutionEngine/Orc/CompileOnDemandLayer.h"
 #include "llvm/ExecutionEngine/Orc/CompileUtils.h"
 #include "llvm/ExecutionEngine/Orc/Core.h"
 #include "llvm/ExecutionEngine/Orc/ExecutionUtils.h"
@@ -20,87 +22,211 @@
 #include "llvm/ExecutionEngine/RTDyldMemoryManager.h"
 #include "llvm/ExecutionEngine/SectionMemoryManager.h"
 #include "llvm/IR/DataLayout.h"
+#include "llvm/IR/InstIterator.h"
 #include "llvm/IR/LLVMContext.h"
-#include "llvm/IR/LegacyPassManager.h"
 
 #include "llvm/Support/Error.h"
+#include "llvm/Support/Host.h"
 #include "llvm/Support/TargetSelect.h"
-
-#include "llvm/Transforms/InstCombine/InstCombine.h"
-#include "llvm/Transforms/Scalar.h"
-#include "llvm/Transforms/Scalar/GVN.h"
-#include "llvm/Transforms/Utils.h"
-#include "llvm/Transforms/Vectorize.h"
+#include "llvm/Support/xxhash.h"
+#include "llvm/Target/TargetMachine.h"
 
 #include "basic/helper_functions.hpp"  //load NO_SANITIZE
-
-#define LAZY_ENABLE 0
-#if LAZY_ENABLE
-  #define LLJITCLASS LLLazyJIT
-#else
-  #define LLJITCLASS LLJIT
-#endif
+#include "basic/pass_timer.hpp"
+#include "compiler/codegen/pass_pipeline.hpp"
+#include "runtime/executionengine/executionengine.hpp"
+#include "jit_object_cache.hpp"
 
 namespace llvm::orc {
 class MimiumJIT {
  private:
-  std::unique_ptr<LLJITCLASS> lllazyjit;
+  // declared before engine because the compiler in engine refers this.
+  std::unique_ptr<mimium::JitObjectCache> objcache;
+  // target machines for optimization passes are created from this for each module, since a
+  // target machine can not be shared between modules optimized in parallel.
+  JITTargetMachineBuilder jtmb;
+  // optimization passes are measured if set.
+  mimium::PassTimer* passtimer = nullptr;
+  // LLLazyJIT if the jit is lazy. destructor of LLJIT is not virtual, so the deleter knows the
+  // actual type.
+  using EnginePtr = std::unique_ptr<LLJIT, void (*)(LLJIT*)>;
+  EnginePtr lllazyjit;
 
   ExecutionSession& ES;
   const DataLayout& DL;
   JITDylib& MainJD;
 
   MangleAndInterner Mangle;
-  ThreadSafeContext Ctx;
+  std::atomic<uint64_t> dylib_count{0};
 
  public:
-  enum OptimizeLevel { NO = 0, NORMAL = 1 } optimize_level;
-  explicit MimiumJIT(std::unique_ptr<LLVMContext> ctx,
-                     OptimizeLevel optimizelevel = OptimizeLevel::NO)
-      : lllazyjit(createEngine()),
+  const mimium::OptimizeLevel optimize_level;
+  const bool is_lazy;
+  // modules are added with their own LLVMContext, so one jit can be shared by multiple
+  // execution engines, each of which owns a dylib.
+  // the object cache is not used for lazy jit since modules are compiled in pieces.
+  explicit MimiumJIT(mimium::OptimizeLevel optimizelevel = mimium::OptimizeLevel::O0,
+                     std::optional<mimium::JitCacheOption> cache = std::nullopt,
+                     mimium::JitCompileOption compile_option = {})
+      : objcache(cache && !compile_option.lazy
+                     ? std::make_unique<mimium::JitObjectCache>(std::move(cache.value()))
+                     : nullptr),
+        jtmb(createHostJTMB(optimizelevel)),
+        lllazyjit(createEngine(jtmb, objcache.get(), compile_option)),
         ES(lllazyjit->getExecutionSession()),
         DL(lllazyjit->getDataLayout()),
         MainJD(lllazyjit->getMainJITDylib()),
         Mangle(ES, this->DL),
-        Ctx(std::move(ctx)),
-        optimize_level(optimizelevel) {
-    if (optimize_level == OptimizeLevel::NORMAL) {
-#if LAZY_ENABLE
-      lllazyjit->setLazyCompileTransform(optimizeModule);
+        optimize_level(optimizelevel),
+        is_lazy(compile_option.lazy) {
+    if (optimize_level != mimium::OptimizeLevel::O0) {
+      auto transform = [this](ThreadSafeModule M, const MaterializationResponsibility& /*R*/)
+          -> Expected<ThreadSafeModule> {
+        M.withModuleDo([&](Module& m) {
+          // optimization is skipped as well as codegen when the object is in cache.
+          if (objcache != nullptr && objcache->hasObject(&m)) { return; }
+          mimium::PassTimer::Scope t(passtimer, "jit", "optimize");
+          auto targetmachine = cantFail(jtmb.createTargetMachine());
+          mimium::runPassPipeline(m, targetmachine.get(), optimize_level, passtimer);
+        });
+        return std::move(M);
+      };
+#if LLVM_VERSION_MAJOR < 12
+      // lazy jit of old llvm has its own transform layer before partitioning.
+      if (is_lazy) {
+        getLazyJIT().setLazyCompileTransform(transform);
+      } else {
+        lllazyjit->getIRTransformLayer().setTransform(transform);
+      }
 #else
-      lllazyjit->getIRTransformLayer().setTransform(optimizeModule);
+      lllazyjit->getIRTransformLayer().setTransform(transform);
 #endif
     }
-// MainJD.getExecutionSession()
-#if LLVM_VERSION_MAJOR >= 10
-    MainJD.addGenerator(
-        cantFail(DynamicLibrarySearchGenerator::GetForCurrentProcess(DL.getGlobalPrefix())));
-#else
-    MainJD.setGenerator(
-        cantFail(DynamicLibrarySearchGenerator::GetForCurrentProcess(DL.getGlobalPrefix())));
-#endif
+    if (is_lazy) { getLazyJIT().setPartitionFunction(partitionReachable); }
+    addProcessSymbols(MainJD);
+  }
+  // target machine for the host cpu and its features, equivalent to "-march=native".
+  static JITTargetMachineBuilder createHostJTMB(mimium::OptimizeLevel level) {
+    auto jtmb = cantFail(JITTargetMachineBuilder::detectHost());  // also detects cpu features
+    jtmb.setCPU(sys::getHostCPUName().str());
+    switch (level) {
+      case mimium::OptimizeLevel::O0: jtmb.setCodeGenOptLevel(CodeGenOpt::None); break;
+      case mimium::OptimizeLevel::O3: jtmb.setCodeGenOptLevel(CodeGenOpt::Aggressive); break;
+      default: jtmb.setCodeGenOptLevel(CodeGenOpt::Default); break;
+    }
+    return jtmb;
   }
-  // Creates LLJIT engine. Note that builder.create causes container overflow inside llvm library.
-  // maybe in llvm::LLVMTargetMachine::initAsmInfo()?
 
-  NO_SANITIZE static std::unique_ptr<LLJITCLASS> createEngine() {
-#if LAZY_ENABLE
-    auto builder = LLLazyJITBuilder();
+  // Note that builder.create causes container overflow inside llvm library.
+  // maybe in llvm::LLVMTargetMachine::initAsmInfo()?
+  template <typename Builder>
+  NO_SANITIZE static auto buildEngine(Builder& builder, JITTargetMachineBuilder jtmb,
+                                      ObjectCache* cache, unsigned int num_threads) {
+    builder.setJITTargetMachineBuilder(std::move(jtmb));
+    builder.setNumCompileThreads(num_threads);
+    // the default compiler shares a target machine, which is not thread safe. a target machine is
+    // created for each compilation so that modules in different dylibs can be compiled in
+    // parallel.
+#if LLVM_VERSION_MAJOR >= 11
+    builder.setCompileFunctionCreator([cache](JITTargetMachineBuilder jtmb)
+                                          -> Expected<std::unique_ptr<IRCompileLayer::IRCompiler>> {
+      return std::make_unique<ConcurrentIRCompiler>(std::move(jtmb), cache);
+    });
 #else
-    auto builder = LLJITBuilder();
+    builder.setCompileFunctionCreator(
+        [cache](JITTargetMachineBuilder jtmb) -> Expected<IRCompileLayer::CompileFunction> {
+          return IRCompileLayer::CompileFunction(ConcurrentIRCompiler(std::move(jtmb), cache));
+        });
 #endif
     auto jit = builder.create();
     if (!jit) { llvm::errs() << jit.takeError() << "\n"; }
     return std::move(jit.get());
   }
-  Error addModule(std::unique_ptr<Module> M) {
-#if LAZY_ENABLE
-    return lllazyjit->addLazyIRModule(ThreadSafeModule(std::move(M), Ctx));
+  // Creates LLJIT or LLLazyJIT engine.
+  NO_SANITIZE static EnginePtr createEngine(JITTargetMachineBuilder jtmb, ObjectCache* cache,
+                                            mimium::JitCompileOption const& compile_option) {
+    if (compile_option.lazy) {
+      auto builder = LLLazyJITBuilder();
+      return EnginePtr(
+          buildEngine(builder, std::move(jtmb), cache, compile_option.num_threads).release(),
+          [](LLJIT* jit) { delete static_cast<LLLazyJIT*>(jit); });  // NOLINT
+    }
+    // dylibs being removed may be still referred from the tasks of compile threads, and a module
+    // is compiled at once anyway.
+    auto builder = LLJITBuilder();
+    return EnginePtr(buildEngine(builder, std::move(jtmb), cache, 0).release(),
+        [](LLJIT* jit) { delete jit; });  // NOLINT
+  }
+  // partition of lazy compilation: requested functions with all the functions and variables
+  // referred from them. the code once compiled never calls back to the compiler, so that dsp
+  // passed from mimium_main is not compiled on the audio thread. functions not referred from
+  // mimium_main(mostly unused library functions) are never compiled.
+  static Optional<CompileOnDemandLayer::GlobalValueSet> partitionReachable(
+      CompileOnDemandLayer::GlobalValueSet requested) {
+    std::vector<const User*> worklist(requested.cbegin(), requested.cend());
+    std::set<const User*> visited;
+    auto push = [&](const Value* v) {
+      if (const auto* gv = dyn_cast<GlobalValue>(v)) {
+        if (gv->isDeclaration()) { return; }
+        requested.insert(gv);
+      }
+      if (const auto* c = dyn_cast<Constant>(v)) { worklist.push_back(c); }
+    };
+    while (!worklist.empty()) {
+      const auto* user = worklist.back();
+      worklist.pop_back();
+      if (!visited.insert(user).second) { continue; }
+      if (const auto* f = dyn_cast<Function>(user)) {
+        for (const auto& inst : instructions(f)) {
+          for (const auto& op : inst.operands()) { push(op.get()); }
+        }
+      } else {
+        for (const auto& op : user->operands()) { push(op.get()); }
+      }
+    }
+    return requested;
+  }
+  // source_hash is a hash of the source code the module was generated from. the module is
+  // looked up from the object cache only when it is given.
+  Error addModule(ThreadSafeModule M, JITDylib& jd,
+                  std::optional<uint64_t> source_hash = std::nullopt) {
+    if (objcache != nullptr && source_hash) {
+      M.withModuleDo([&](Module& m) {
+        objcache->registerModule(&m, makeCacheKey(source_hash.value()));
+      });
+    }
+    if (is_lazy) { return getLazyJIT().addLazyIRModule(jd, std::move(M)); }
+    return lllazyjit->addIRModule(jd, std::move(M));
+  }
+  Expected<JITEvaluatedSymbol> lookup(JITDylib& jd, StringRef name) {
+    return lllazyjit->lookup(jd, name);
+  }
+  JITDylib& getMainJITDylib() { return MainJD; }
+  // an empty dylib which resolves runtime functions from the process. every module defines
+  // mimium_main and dsp, so modules living in the jit at the same time need their own dylibs.
+  JITDylib& createDylib() {
+    auto name = "mimium" + std::to_string(dylib_count.fetch_add(1));
+#if LLVM_VERSION_MAJOR >= 11
+    auto& jd = ES.createBareJITDylib(name);
 #else
-    return lllazyjit->addIRModule(ThreadSafeModule(std::move(M), Ctx));
+    auto& jd = ES.createJITDylib(name);
 #endif
+    addProcessSymbols(jd);
+    return jd;
   }
-  Expected<JITEvaluatedSymbol> lookup(StringRef name) { return lllazyjit->lookup(name); }
+  // releases the code of modules in the dylib. the dylib must not be used after this.
+  Error removeDylib(JITDylib& jd) {
+#if LLVM_VERSION_MAJOR >= 13
+    // the compile-on-demand layer keeps resources for each dylib which are not released with
+    // it, so the code of lazy jit is kept until the jit is destroyed.
+    if (is_lazy) { return Error::success(); }
+    return ES.removeJITDylib(jd);
+#else
+    // dylibs can not be removed. the code is kept until the jit is destroyed.
+    return Error::success();
+#endif
+  }
+  void setPassTimer(mimium::PassTimer* timer) { passtimer = timer; }
 
   Error addSymbol(StringRef name, void* ptr) {
     // auto symbol = JITEvaluatedSymbol(pointerToJITTargetAddress(&puts),
@@ -117,36 +243,36 @@ class MimiumJIT {
     return res.takeError();
   }
 
-  static Expected<ThreadSafeModule> optimizeModule(ThreadSafeModule M,
-                                                   const MaterializationResponsibility& R) {
-// Create a function pass manager.
-#if LLVM_VERSION_MAJOR >= 10
-    auto FPM = std::make_unique<legacy::FunctionPassManager>(M.getModuleUnlocked());
-#else
-    auto FPM = std::make_unique<legacy::FunctionPassManager>(M.getModule());
-#endif
-    // Add some optimizations.
-    FPM->add(createPromoteMemoryToRegisterPass());  // mem2reg
-    FPM->add(createDeadStoreEliminationPass());
-    FPM->add(createInstructionCombiningPass());
-    FPM->add(createReassociatePass());
-    FPM->add(createGVNPass());
-    FPM->add(createCFGSimplificationPass());
-    FPM->add(createLoopInterchangePass());
-    FPM->add(createLoopVectorizePass());
-    FPM->doInitialization();
+  // key of object cache. llvm version is included since the object format may change.
+  // must be incremented when the generated code or the runtime functions it refers change(e.g.
+  // the arguments of dsp_block), so that the objects cached by older versions are not loaded.
+  static constexpr int codegen_abi_version = 1;
+  [[nodiscard]] std::string makeCacheKey(uint64_t source_hash) const {
+    auto str = std::to_string(source_hash) + "-abi" + std::to_string(codegen_abi_version) + "-O" +
+               std::to_string(static_cast<int>(optimize_level)) + "-" +
+               lllazyjit->getTargetTriple().str() + "-" + sys::getHostCPUName().str() + "-" +
+               LLVM_VERSION_STRING;
+    auto hash = xxHash64(str);
+    return utohexstr(hash, true);
+  }
+  [[nodiscard]] bool isLastObjectCached() const {
+    return objcache != nullptr && objcache->isLastHit();
+  }
+  [[nodiscard]] const DataLayout& getDataLayout() const { return DL; }
 
-// Run the optimizations over all functions in the module being added to
-// the JIT.
+ private:
+  LLLazyJIT& getLazyJIT() {
+    assert(is_lazy);
+    return static_cast<LLLazyJIT&>(*lllazyjit);
+  }
+  void addProcessSymbols(JITDylib& jd) {
 #if LLVM_VERSION_MAJOR >= 10
-    M.withModuleDo(
-        [&](Module& m) { std::for_each(m.begin(), m.end(), [&](auto& f) { FPM->run(f); }); });
+    jd.addGenerator(
+        cantFail(DynamicLibrarySearchGenerator::GetForCurrentProcess(DL.getGlobalPrefix())));
 #else
-    for (auto& f : M.getModule()->functions()) { FPM->run(f); }
+    jd.setGenerator(
+        cantFail(DynamicLibrarySearchGenerator::GetForCurrentProcess(DL.getGlobalPrefix())));
 #endif
-    return M;
   }
-  [[nodiscard]] const DataLayout& getDataLayout() const { return DL; }
-  LLVMContext& getContext() { return *Ctx.getContext(); }
 };
 }  // namespace llvm::orc
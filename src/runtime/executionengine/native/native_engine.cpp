@@ -0,0 +1,58 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+#include "native_engine.hpp"
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <dlfcn.h>
+#endif
+#include "basic/error_def.hpp"
+#include "basic/helper_functions.hpp"
+
+namespace mimium {
+
+NativeExecutionEngine::NativeExecutionEngine(fs::path const& path) : ExecutionEngine() {
+#ifdef _WIN32
+  handle = static_cast<void*>(LoadLibraryW(path.wstring().c_str()));
+  if (handle == nullptr) { throw mimium::RuntimeError("Failed to load " + path.string()); }
+#else
+  // runtime functions referred from the library are resolved from the host application.
+  handle = dlopen(path.string().c_str(), RTLD_NOW | RTLD_LOCAL);
+  if (handle == nullptr) { throw mimium::RuntimeError(std::string(dlerror())); }
+#endif
+}
+
+NativeExecutionEngine::~NativeExecutionEngine() {
+  if (handle == nullptr) { return; }
+#ifdef _WIN32
+  FreeLibrary(static_cast<HMODULE>(handle));
+#else
+  dlclose(handle);
+#endif
+}
+
+void* NativeExecutionEngine::lookup(std::string const& name) {
+#ifdef _WIN32
+  return reinterpret_cast<void*>(GetProcAddress(static_cast<HMODULE>(handle), name.c_str()));  // NOLINT
+#else
+  return dlsym(handle, name.c_str());
+#endif
+}
+
+bool NativeExecutionEngine::runMainFunction(Runtime* runtime_ptr) {
+  auto* mainfun = lookup("mimium_main");
+  if (mainfun == nullptr) {
+    throw mimium::RuntimeError("mimium_main function not found in the shared library.");
+  }
+  auto* mimium_main_function = reinterpret_cast<void* (*)(void*)>(mainfun);  // NOLINT
+  mimium_main_function(runtime_ptr);
+  if (lookup("dsp") == nullptr) {
+    Logger::debug_log("dsp function not found", Logger::INFO);
+    return false;
+  }
+  return true;
+}
+
+}  // namespace mimium
@@ -0,0 +1,28 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+#pragma once
+#include <string>
+#include "runtime/executionengine/executionengine.hpp"
+#include "utils/include_filesystem.hpp"
+
+namespace mimium {
+
+// Execution engine that loads a shared library compiled ahead-of-time with "--emit-so".
+// No compilation happens at runtime, so the startup does not depend on LLVM.
+class MIMIUM_DLL_PUBLIC NativeExecutionEngine : public ExecutionEngine {
+ public:
+  explicit NativeExecutionEngine(fs::path const& path);
+  ~NativeExecutionEngine() override;
+  NativeExecutionEngine(NativeExecutionEngine const&) = delete;
+  NativeExecutionEngine& operator=(NativeExecutionEngine const&) = delete;
+  bool runMainFunction(Runtime* runtime_ptr) override;
+
+ private:
+  // returns nullptr if the symbol was not found.
+  void* lookup(std::string const& name);
+  void* handle = nullptr;
+};
+
+}  // namespace mimium
@@ -1,19 +1,31 @@
 #include "runtime.hpp"
+#include "basic/rt_logger.hpp"
 #include "runtime/backend/audiodriver.hpp"
 #include "runtime/executionengine/executionengine.hpp"
 
 namespace mimium {
-Runtime::Runtime(std::unique_ptr<AudioDriver> a, std::unique_ptr<ExecutionEngine> e)
-    : audiodriver(std::move(a)), executionengine(std::move(e)) {}
+Runtime::Runtime(std::unique_ptr<AudioDriver> a, std::unique_ptr<ExecutionEngine> e,
+                 ArenaOption arena_option)
+    : audiodriver(std::move(a)), executionengine(std::move(e)), arena(arena_option) {
+  // println may be called first from dsp on the audio thread.
+  RtLogger::initStdout();
+}
 
-void Runtime::runMainFun() { this->hasdsp = executionengine->runMainFunction(this); }
+void Runtime::runMainFun() {
+  main_thread = std::this_thread::get_id();
+  this->hasdsp = executionengine->runMainFunction(this);
+  auto stats = arena.getStats();
+  Logger::debug_log("memory allocated in main: " + std::to_string(stats.allocated_bytes) +
+                        " bytes in " + std::to_string(stats.count) + " allocations",
+                    Logger::INFO);
+}
 
 void Runtime::start() {
   executionengine->preStart();
 
   auto& sch = audiodriver->getScheduler();
   if (hasdsp || sch.hasTask()) {
-    audiodriver->setup(audiodriver->getDefaultAudioParameter(std::nullopt, std::nullopt));
+    audiodriver->setup(audiodriver->getDefaultAudioParameter(samplerate, framesize));
     audiodriver->start();
     {
       auto& waitc = sch.getWaitController();
@@ -22,16 +34,63 @@ void Runtime::start() {
       waitc.cv.wait(uniq_lk, [&]() { return waitc.isready; });
     }
   }
+  auto stats = arena.getStats();
+  Logger::debug_log("memory allocation: " + std::to_string(stats.allocated_bytes) + " bytes in " +
+                        std::to_string(stats.count) + " allocations, peak " +
+                        std::to_string(stats.peak_bytes) + " bytes, reserved " +
+                        std::to_string(stats.reserved_bytes) + " bytes",
+                    Logger::INFO);
+}
+
+void Runtime::setAudioParameter(std::optional<int> samplerate, std::optional<int> framesize) {
+  this->samplerate = samplerate;
+  this->framesize = framesize;
 }
 
 AudioDriver& Runtime::getAudioDriver() { return *audiodriver; }
 
-void Runtime::pushMalloc(void* address, size_t size) {
-  malloc_container.emplace_back(address, size);
+void Runtime::setFloatPrecision(FloatPrecision p) {
+  precision = p;
+  audiodriver->getScheduler().setFloatPrecision(p);
+  if (p == FloatPrecision::F32) { Logger::debug_log("float precision: 32bit", Logger::INFO); }
+}
+
+void Runtime::addTask(double time, void* addresstofn, double arg, void* addresstocls) {
+  if (live_scheduler == nullptr) {
+    auto& sch = audiodriver->getScheduler();
+    // no logging on failure, as voice workers are real-time threads.
+    if (is_dsp_worker_thread) {
+      sch.addTaskAsync(time, addresstofn, arg, addresstocls);
+    } else {
+      sch.addTask(time, addresstofn, arg, addresstocls);
+    }
+    return;
+  }
+  has_live_tasks = true;
+  if (is_dsp_worker_thread) {
+    live_scheduler->addTaskAsync(time, addresstofn, arg, addresstocls, live_owner);
+  } else if (!isOnMainThread()) {
+    // called from a task or dsp on the audio thread.
+    live_scheduler->addTask(time, addresstofn, arg, addresstocls, live_owner);
+  } else if (!live_scheduler->addTaskAsync(time, addresstofn, arg, addresstocls, live_owner)) {
+    Logger::debug_log("A task scheduled by the reloaded source is dropped.", Logger::WARNING);
+  }
+}
+
+int64_t Runtime::getNow() const {
+  if (live_scheduler == nullptr) {
+    return audiodriver->getScheduler().getTime() + current_frame_offset;
+  }
+  if (isOnMainThread()) { return live_scheduler->getTimeAsync(); }
+  return live_scheduler->getTime() + current_frame_offset;
 }
 }  // namespace mimium
 
 extern "C" {
+void setFloatPrecision(void* runtimeptr, int32_t precision) {
+  auto* runtime = static_cast<mimium::Runtime*>(runtimeptr);
+  runtime->setFloatPrecision(static_cast<mimium::FloatPrecision>(precision));
+}
 void setDspParams(void* runtimeptr, void* dspfn, void* clsaddress, void* memobjaddress,
                   int in_numchs, int out_numchs) {
   auto* runtime = static_cast<mimium::Runtime*>(runtimeptr);
@@ -39,30 +98,52 @@ void setDspParams(void* runtimeptr, void* dspfn, void* clsaddress, void* memobja
   auto p = std::make_unique<mimium::DspFnInfos>(
       mimium::DspFnInfos{reinterpret_cast<mimium::DspFnPtr>(dspfn), clsaddress, memobjaddress,
                          in_numchs, out_numchs});  // NOLINT
+  p->precision = runtime->getFloatPrecision();
   audiodriver.setDspFnInfos(std::move(p));
 }
+// called after setDspParams only when dsp function exists.
+void setDspBlockFn(void* runtimeptr, void* dspblockfn) {
+  auto* runtime = static_cast<mimium::Runtime*>(runtimeptr);
+  auto* fn = reinterpret_cast<mimium::DspBlockFnPtr>(dspblockfn);  // NOLINT
+  runtime->getAudioDriver().setDspBlockFn(fn);
+}
+// called after setDspParams only when dsp function exists.
+void setDspPlanarBlockFn(void* runtimeptr, void* dspplanarfn) {
+  auto* runtime = static_cast<mimium::Runtime*>(runtimeptr);
+  auto* fn = reinterpret_cast<mimium::DspPlanarBlockFnPtr>(dspplanarfn);  // NOLINT
+  runtime->getAudioDriver().setDspPlanarBlockFn(fn);
+}
+
+// called after setDspParams only when dsp function has memory object.
+void setDspMemobjSize(void* runtimeptr, int64_t size) {
+  auto* runtime = static_cast<mimium::Runtime*>(runtimeptr);
+  runtime->getAudioDriver().setDspMemobjSize(static_cast<size_t>(size));
+}
+// called after setDspMemobjSize.
+void setDspMemobjLayout(void* runtimeptr, int64_t layout) {
+  auto* runtime = static_cast<mimium::Runtime*>(runtimeptr);
+  runtime->getAudioDriver().setDspMemobjLayout(static_cast<uint64_t>(layout));
+}
 
 NO_SANITIZE void addTask(void* runtimeptr, double time, void* addresstofn, double arg) {
   auto* runtime = static_cast<mimium::Runtime*>(runtimeptr);
-  mimium::Scheduler& sch = runtime->getAudioDriver().getScheduler();
-  sch.addTask(time, addresstofn, arg, nullptr);
+  runtime->addTask(time, addresstofn, arg, nullptr);
 }
 NO_SANITIZE void addTask_cls(void* runtimeptr, double time, void* addresstofn, double arg,
                              void* addresstocls) {
   auto* runtime = static_cast<mimium::Runtime*>(runtimeptr);
-  mimium::Scheduler& sch = runtime->getAudioDriver().getScheduler();
-  sch.addTask(time, addresstofn, arg, addresstocls);
+  runtime->addTask(time, addresstofn, arg, addresstocls);
 }
 double mimium_getnow(void* runtimeptr) {
   auto* runtime = static_cast<mimium::Runtime*>(runtimeptr);
-  return (double)runtime->getAudioDriver().getScheduler().getTime();
+  return (double)runtime->getNow();
 }
+void mimium_setframeoffset(int64_t offset) { mimium::current_frame_offset = offset; }
+double mimium_getvoiceindex() { return mimium::current_voice_index; }
 
 // TODO(tomoya) ideally we need to move this to base runtime library
 void* mimium_malloc(void* runtimeptr, size_t size) {
   auto* runtime = static_cast<mimium::Runtime*>(runtimeptr);
-  void* address = malloc(size);  // NOLINT
-  runtime->pushMalloc(address, size);
-  return address;
+  return runtime->allocate(size);
 }
 }
\ No newline at end of file
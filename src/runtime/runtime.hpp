@@ -4,10 +4,13 @@
 
 #pragma once
 
-#include <list>
+#include <atomic>
+#include <optional>
+#include <thread>
 #include "export.hpp"
 
 #include "basic/helper_functions.hpp"
+#include "runtime/arena.hpp"
 #include "runtime/runtime_defs.hpp"
 #include "runtime/scheduler.hpp"
 
@@ -16,34 +19,72 @@ class AudioDriver;
 class ExecutionEngine;
 class MIMIUM_DLL_PUBLIC Runtime {
  public:
-  explicit Runtime(std::unique_ptr<AudioDriver> a, std::unique_ptr<ExecutionEngine> e);
+  explicit Runtime(std::unique_ptr<AudioDriver> a, std::unique_ptr<ExecutionEngine> e,
+                   ArenaOption arena_option = {});
 
-  virtual ~Runtime() {
-    for (auto&& [address, size] : malloc_container) { free(address); }
-  };
+  // memory allocated by generated code is released at once with the arena.
+  virtual ~Runtime() = default;
 
   virtual void runMainFun();
   virtual void start();
+  // Set the parameters passed to AudioDriver. If not set, driver's default value is used.
+  void setAudioParameter(std::optional<int> samplerate, std::optional<int> framesize);
   AudioDriver& getAudioDriver();
   [[nodiscard]] bool hasDsp() const { return hasdsp; }
   [[nodiscard]] bool hasDspCls() const { return hasdspcls; }
-  void pushMalloc(void* address, size_t size);
+  // memory for generated code, which lives until the runtime is destroyed.
+  void* allocate(size_t size) { return arena.allocate(size); }
+  [[nodiscard]] ArenaStats getAllocationStats() const { return arena.getStats(); }
+  // set by generated code at the beginning of mimium_main.
+  void setFloatPrecision(FloatPrecision p);
+  [[nodiscard]] FloatPrecision getFloatPrecision() const { return precision; }
+  // The source which replaces the dsp of a running driver(see LiveReloader) refers the scheduler
+  // of that driver for its tasks and now, instead of the one of this runtime's driver. The tasks
+  // are tagged with the owner id(non-zero and unique for the scheduler) to be removed by
+  // Scheduler::removeTasksAsync() when this runtime is replaced.
+  void setLiveScheduler(Scheduler* s, uint64_t owner) {
+    live_scheduler = s;
+    live_owner = owner;
+  }
+  [[nodiscard]] uint64_t getLiveOwner() const { return live_owner; }
+  // true if the source added tasks to the live scheduler, which may refer its code and memory
+  // until they are removed.
+  [[nodiscard]] bool hasLiveTasks() const { return has_live_tasks.load(); }
+  void addTask(double time, void* addresstofn, double arg, void* addresstocls);
+  [[nodiscard]] int64_t getNow() const;
 
  protected:
   std::unique_ptr<AudioDriver> audiodriver;
   std::unique_ptr<ExecutionEngine> executionengine;
   bool hasdsp = false;
   bool hasdspcls = false;
-  std::list<std::pair<void*, size_t>> malloc_container{};
+  std::optional<int> samplerate = std::nullopt;
+  std::optional<int> framesize = std::nullopt;
+  Arena arena;
+  FloatPrecision precision = FloatPrecision::F64;
+  Scheduler* live_scheduler = nullptr;
+  uint64_t live_owner = 0;
+  // the live scheduler is accessed asynchronously from the thread running mimium_main.
+  std::thread::id main_thread;
+  std::atomic<bool> has_live_tasks = false;
+  [[nodiscard]] bool isOnMainThread() const { return std::this_thread::get_id() == main_thread; }
 };
 
 extern "C" {
+MIMIUM_DLL_PUBLIC void setFloatPrecision(void* runtimeptr, int32_t precision);
 MIMIUM_DLL_PUBLIC void setDspParams(void* runtimeptr, void* dspfn, void* clsaddress,
                                     void* memobjaddress, int in_numchs, int out_numchs);
+MIMIUM_DLL_PUBLIC void setDspBlockFn(void* runtimeptr, void* dspblockfn);
+MIMIUM_DLL_PUBLIC void setDspPlanarBlockFn(void* runtimeptr, void* dspplanarfn);
+MIMIUM_DLL_PUBLIC void setDspMemobjSize(void* runtimeptr, int64_t size);
+MIMIUM_DLL_PUBLIC void setDspMemobjLayout(void* runtimeptr, int64_t layout);
 MIMIUM_DLL_PUBLIC void addTask(void* runtimeptr, double time, void* addresstofn, double arg);
 MIMIUM_DLL_PUBLIC void addTask_cls(void* runtimeptr, double time, void* addresstofn, double arg,
                                    void* addresstocls);
 MIMIUM_DLL_PUBLIC double mimium_getnow(void* runtimeptr);
+// called for each frame by dsp_block of the source which refers now.
+MIMIUM_DLL_PUBLIC void mimium_setframeoffset(int64_t offset);
+MIMIUM_DLL_PUBLIC double mimium_getvoiceindex();
 MIMIUM_DLL_PUBLIC void* mimium_malloc(void* runtimeptr, size_t size);
 }
 
@@ -3,10 +3,27 @@
  * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
 
 #pragma once
+#include <cstddef>
+#include <cstdint>
 namespace mimium {
 
+// floating point type which types::Float is lowered to. the value is passed to the runtime as is.
+enum class FloatPrecision : int32_t { F64 = 0, F32 = 1 };
+
 // outputresult,input, clsaddress,memobjaddress
-using DspFnPtr = void (*)(double*, const double*, void*, void*);
+template <typename T>
+using DspFnPtrT = void (*)(T*, const T*, void*, void*);
+// interleaved output buffer, interleaved input buffer, number of frames, clsaddress,memobjaddress
+template <typename T>
+using DspBlockFnPtrT = void (*)(T*, const T*, int64_t, void*, void*);
+// array of output channel pointers, array of input channel pointers, number of frames,
+// clsaddress,memobjaddress
+template <typename T>
+using DspPlanarBlockFnPtrT = void (*)(T* const*, const T* const*, int64_t, void*, void*);
+// pointers are stored in double version and cast to float version if precision is F32.
+using DspFnPtr = DspFnPtrT<double>;
+using DspBlockFnPtr = DspBlockFnPtrT<double>;
+using DspPlanarBlockFnPtr = DspPlanarBlockFnPtrT<double>;
 
 // Information set by definition of dsp function.
 // number of in&out channels are determined by type of dsp function.
@@ -17,6 +34,17 @@ struct DspFnInfos {
   void* memobj_address = nullptr;
   int in_numchs = 0;
   int out_numchs = 0;
+  // wrapper of fn which loops over a block of frames. May be null for IR emitted by old compilers.
+  DspBlockFnPtr block_fn = nullptr;
+  // size of memory object in bytes, used to make copies for voices. 0 if unknown.
+  size_t memobj_size = 0;
+  // sample type of the buffers passed to fn and block_fn.
+  FloatPrecision precision = FloatPrecision::F64;
+  // same as block_fn but takes non-interleaved buffers. May be null like block_fn.
+  DspPlanarBlockFnPtr planar_block_fn = nullptr;
+  // hash of the type of memory object. the state can be copied to another dsp with the same
+  // layout on live reload. 0 if unknown.
+  uint64_t memobj_layout = 0;
 };
 
 // Information of AudioDriver(e.g. Hardware Device).
@@ -12,22 +12,75 @@ bool Scheduler::Greater::operator()(const key_type& l, const key_type& r) const
 
 // return value: shouldstop
 bool Scheduler::incrementTime() {
+  moveAsyncTasks();
+  removeRequestedTasks();
   bool hastask = !tasks.empty();
   bool shouldplay = hasdsp || hastask;
   if (!shouldplay) { return true; }
 
   time += 1;
-  if (hastask && time > tasks.top().first) { executeTask(tasks.top().second); }
+  shared_time.store(time, std::memory_order_relaxed);
+  if (hastask) { executeDueTasks(); }
   return false;
 }
-void Scheduler::addTask(double time, void* addresstofn, double arg, void* addresstocls) {
-  tasks.emplace(static_cast<int64_t>(time), TaskType{addresstofn, arg, addresstocls});
+int64_t Scheduler::beginSpan(int64_t max) {
+  assert(max > 0);
+  if (incrementTime()) { return 0; }
+  return 1 + getTicksUntilNextTask(max - 1);
+}
+int64_t Scheduler::getTicksUntilNextTask(int64_t max) const {
+  if (tasks.empty()) { return max; }
+  // a task fires at the tick where time gets greater than its scheduled time.
+  return std::clamp<int64_t>(tasks.top().first - time, 0, max);
 }
 
-void Scheduler::executeTask(const TaskType& task) {
-  // todo
-  const auto& [addresstofn, arg, addresstocls] = task;
+void Scheduler::addTask(double time, void* addresstofn, double arg, void* addresstocls,
+                        uint64_t owner) {
+  pushTask(key_type{static_cast<int64_t>(time), TaskType{addresstofn, arg, addresstocls, owner}});
+}
+bool Scheduler::addTaskAsync(double time, void* addresstofn, double arg, void* addresstocls,
+                             uint64_t owner) {
+  return async_tasks.tryPush(
+      key_type{static_cast<int64_t>(time), TaskType{addresstofn, arg, addresstocls, owner}});
+}
+void Scheduler::pushTask(key_type const& task) {
+  // no logging here because this may be called on audio thread.
+  if (!tasks.push(task)) { dropped_tasks++; }
+}
+void Scheduler::moveAsyncTasks() {
+  key_type task;
+  while (async_tasks.tryPop(task)) { pushTask(task); }
+}
+
+void Scheduler::removeRequestedTasks() {
+  auto owner = remove_request.load(std::memory_order_acquire);
+  if (owner == removed_owner.load(std::memory_order_relaxed)) { return; }
+  tasks.removeIf([owner](key_type const& task) { return task.second.owner == owner; });
+  removed_owner.store(owner, std::memory_order_release);
+}
 
+void Scheduler::executeDueTasks() {
+  // the task is popped before execution because it may push another task to the queue.
+  // a task added for the current time is fired at the next tick so that this loop always ends.
+  while (!tasks.empty() && time > tasks.top().first) {
+    auto task = tasks.top().second;
+    tasks.pop();
+    executeTask(task);
+  }
+  if (tasks.empty() && !hasdsp) { stop(); }
+}
+
+void Scheduler::executeTask(const TaskType& task) {
+  const auto& [addresstofn, arg, addresstocls, owner] = task;
+  if (precision == FloatPrecision::F32) {
+    const auto arg_f = static_cast<float>(arg);
+    if (addresstocls == nullptr) {
+      reinterpret_cast<void (*)(float)>(addresstofn)(arg_f);  // NOLINT
+    } else {
+      reinterpret_cast<void (*)(float, void*)>(addresstofn)(arg_f, addresstocls);  // NOLINT
+    }
+    return;
+  }
   if (addresstocls == nullptr) {
     auto fn = reinterpret_cast<void (*)(double)>(addresstofn);//NOLINT
     fn(arg);
@@ -35,13 +88,6 @@ void Scheduler::executeTask(const TaskType& task) {
     auto fn = reinterpret_cast<void (*)(double, void*)>(addresstofn);//NOLINT
     fn(arg, addresstocls);
   }
-  tasks.pop();
-  if (tasks.empty() && !hasdsp) {
-    stop();
-  } else {
-    // recursive call until all tasks have been done!
-    if (time >= tasks.top().first) { this->executeTask(tasks.top().second); }
-  }
 }
 
 void Scheduler::start(bool hasdsp) { this->hasdsp = hasdsp; }
@@ -4,10 +4,13 @@
 
 #pragma once
 
-#include <queue>
+#include <atomic>
 #include <utility>
 #include "export.hpp"
 #include "basic/helper_functions.hpp"
+#include "basic/ringbuffer.hpp"
+#include "runtime/runtime_defs.hpp"
+#include "runtime/task_queue.hpp"
 // #include "sndfile.h"
 
 namespace mimium {
@@ -16,11 +19,24 @@ struct TaskType {
   // int64_t tasktypeid;
   double arg;
   void* addresstocls;
+  // id of the runtime which added the task to the scheduler of another one(see
+  // Runtime::setLiveScheduler()), 0 for the tasks of the runtime owning the scheduler.
+  uint64_t owner;
 };
 
+// offset of the frame being processed from the beginning of the span, which is added to the time
+// seen from dsp. thread local since voices are processed on their own threads.
+inline thread_local int64_t current_frame_offset = 0;  // NOLINT
+// true on the threads running dsp other than the one running the scheduler(voice workers), where
+// tasks must be added by Scheduler::addTaskAsync().
+inline thread_local bool is_dsp_worker_thread = false;  // NOLINT
+
 class MIMIUM_DLL_PUBLIC Scheduler {  // scheduler interface
  public:
-  explicit Scheduler() : wc() {}
+  // Queues are allocated here and never grow. Tasks over the capacity are dropped.
+  explicit Scheduler(size_t capacity = default_capacity,
+                     size_t async_capacity = default_async_capacity)
+      : wc(), tasks(capacity), async_tasks(async_capacity) {}
 
   virtual ~Scheduler() = default;
   virtual void start(bool hasdsp);
@@ -28,15 +44,52 @@ class MIMIUM_DLL_PUBLIC Scheduler {  // scheduler interface
 
   bool hasTask() { return !tasks.empty(); }
 
-  // tick the time and return if scheduler should be stopped
+  // tick the time, fire all due tasks and return if scheduler should be stopped
   bool incrementTime();
 
+  // number of following ticks(up to max) which do not fire any task.
+  [[nodiscard]] int64_t getTicksUntilNextTask(int64_t max) const;
+  // advance the time without checking tasks. Used with getTicksUntilNextTask().
+  void skipTime(int64_t ticks) {
+    time += ticks;
+    shared_time.store(time, std::memory_order_relaxed);
+  }
+  // tick the time and fire all due tasks at the beginning of a span. returns number of ticks(1 to
+  // max) until the next deadline, or 0 if scheduler should be stopped. The time stays at the
+  // first tick of the span while it is processed, and the frames in it see the time with their
+  // offset (see mimium_getnow()).
+  // A span is processed by a single call of dsp_block, so a task added by dsp in the middle of a
+  // span is not checked until the next span begins: when it is due within the current span, it
+  // fires at the beginning of the next one, up to one block late. Tasks added by tasks are fired
+  // at their due tick since they are added before the span is decided.
+  int64_t beginSpan(int64_t max);
+  // advance the time to the last tick of the span after it is processed.
+  void endSpan(int64_t span) { skipTime(span - 1); }
+
   // time,address to fun, arg(double), addresstoclosure,
-  void addTask(double time, void* addresstofn, double arg, void* addresstocls);
+  // must be called from the thread running the scheduler (or before it starts).
+  void addTask(double time, void* addresstofn, double arg, void* addresstocls,
+               uint64_t owner = 0);
+  // thread-safe version of addTask to be called from other threads like a control thread.
+  // The task is moved to the queue at the next tick. returns false if the buffer is full.
+  bool addTaskAsync(double time, void* addresstofn, double arg, void* addresstocls,
+                    uint64_t owner = 0);
+  // thread-safe request to remove all the tasks of the owner at the next tick, so that the code
+  // and memory of a replaced runtime can be released. A request replaces the last one.
+  void removeTasksAsync(uint64_t owner) { remove_request.store(owner, std::memory_order_release); }
+  // true after the tasks of the owner of the last request are removed.
+  [[nodiscard]] bool isTasksRemoved(uint64_t owner) const {
+    return removed_owner.load(std::memory_order_acquire) == owner;
+  }
+  [[nodiscard]] int64_t getDroppedTaskCount() const { return dropped_tasks; }
+  // tasks take float argument in F32 mode. the argument is stored as double anyway.
+  void setFloatPrecision(FloatPrecision p) { precision = p; }
 
   // if dsp function exists
   bool hasdsp = false;
   [[nodiscard]] auto getTime() const { return time; }
+  // time read from other threads, such as the one running mimium_main of a reloaded source.
+  [[nodiscard]] int64_t getTimeAsync() const { return shared_time.load(std::memory_order_relaxed); }
   auto& getWaitController() { return wc; }
 
  protected:
@@ -45,10 +98,23 @@ class MIMIUM_DLL_PUBLIC Scheduler {  // scheduler interface
     bool operator()(const key_type& l, const key_type& r) const;
   };
   WaitController wc;
-  using queue_type = std::priority_queue<key_type, std::vector<key_type>, Greater>;
+  using queue_type = BoundedPriorityQueue<key_type, Greater>;
   int64_t time = 0;
+  std::atomic<int64_t> shared_time = 0;
   queue_type tasks;
+  MpscRingBuffer<key_type> async_tasks;
+  std::atomic<uint64_t> remove_request = 0;
+  std::atomic<uint64_t> removed_owner = 0;
+  int64_t dropped_tasks = 0;
+  FloatPrecision precision = FloatPrecision::F64;
+  void pushTask(key_type const& task);
+  void moveAsyncTasks();
+  void removeRequestedTasks();
+  // pop and execute the tasks due at current time in a loop, including tasks added by them.
+  void executeDueTasks();
   virtual void executeTask(const TaskType& task);
+  static constexpr size_t default_capacity = 16384;
+  static constexpr size_t default_async_capacity = 1024;
 };
 
 }  // namespace mimium
\ No newline at end of file
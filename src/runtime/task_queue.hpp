@@ -0,0 +1,77 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+#pragma once
+#include <cassert>
+#include <utility>
+#include <vector>
+
+namespace mimium {
+
+// Binary heap on a buffer allocated once in constructor, used in the scheduler instead of
+// std::priority_queue so that adding a task from the audio thread never reallocates.
+// Compare has the same meaning as the one for std::priority_queue.
+template <typename T, typename Compare>
+class BoundedPriorityQueue {
+ public:
+  explicit BoundedPriorityQueue(size_t capacity) : buf(capacity), count(0) {}
+  // returns false without modifying queue if the queue is full.
+  bool push(T const& v) {
+    if (count == buf.size()) { return false; }
+    buf[count] = v;
+    siftUp(count++);
+    return true;
+  }
+  [[nodiscard]] const T& top() const {
+    assert(count > 0);
+    return buf[0];
+  }
+  void pop() {
+    assert(count > 0);
+    buf[0] = std::move(buf[--count]);
+    if (count > 0) { siftDown(0); }
+  }
+  // removes all elements satisfying pred in O(n), without allocation.
+  template <typename Pred>
+  size_t removeIf(Pred pred) {
+    size_t kept = 0;
+    for (size_t i = 0; i < count; i++) {
+      if (!pred(buf[i])) { buf[kept++] = std::move(buf[i]); }
+    }
+    auto removed = count - kept;
+    count = kept;
+    for (size_t i = count / 2; i > 0; i--) { siftDown(i - 1); }
+    return removed;
+  }
+  [[nodiscard]] bool empty() const { return count == 0; }
+  [[nodiscard]] size_t size() const { return count; }
+  [[nodiscard]] size_t capacity() const { return buf.size(); }
+
+ private:
+  std::vector<T> buf;
+  size_t count;
+  Compare comp{};
+  void siftUp(size_t i) {
+    while (i > 0) {
+      size_t parent = (i - 1) / 2;
+      if (!comp(buf[parent], buf[i])) { break; }
+      std::swap(buf[parent], buf[i]);
+      i = parent;
+    }
+  }
+  void siftDown(size_t i) {
+    while (true) {
+      size_t left = 2 * i + 1;
+      size_t right = left + 1;
+      size_t target = i;
+      if (left < count && comp(buf[target], buf[left])) { target = left; }
+      if (right < count && comp(buf[target], buf[right])) { target = right; }
+      if (target == i) { break; }
+      std::swap(buf[i], buf[target]);
+      i = target;
+    }
+  }
+};
+
+}  // namespace mimium
@@ -0,0 +1,188 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+#include "voice_pool.hpp"
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+#include <string>
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+#include "basic/helper_functions.hpp"
+#include "basic/rt_logger.hpp"
+#include "runtime/scheduler.hpp"
+
+namespace mimium {
+
+namespace {
+// number of yields before a worker sleeps. a block arrives within a few milliseconds while
+// audio is running, so workers mostly wake up without the condition variable.
+constexpr int spin_count = 2000;
+constexpr auto sleep_timeout = std::chrono::milliseconds(1);
+}  // namespace
+
+VoicePool::VoicePool(DspFnInfos const& dspinfos, int numvoices, int numthreads, int maxframes)
+    : dsp(dspinfos) {
+  if (numvoices < 1) { throw std::runtime_error("Number of voices must be more than 0."); }
+  if (dsp.memobj_address != nullptr && dsp.memobj_size == 0) {
+    throw std::runtime_error(
+        "Size of memory object for dsp function is unknown. Recompile the source to use voices.");
+  }
+  if (numthreads <= 0) { numthreads = static_cast<int>(std::thread::hardware_concurrency()); }
+  this->numthreads = std::clamp(numthreads, 1, numvoices);
+
+  const size_t memobj_len = (dsp.memobj_size + sizeof(double) - 1) / sizeof(double);
+  voices.resize(numvoices);
+  for (int i = 0; i < numvoices; i++) {
+    auto& v = voices[i];
+    const auto outlen = static_cast<size_t>(maxframes) * dsp.out_numchs;
+    if (dsp.precision == FloatPrecision::F32) {
+      v.output_f32.resize(outlen);
+    } else {
+      v.output.resize(outlen);
+    }
+    if (i == 0 || dsp.memobj_address == nullptr) {
+      v.memobj = dsp.memobj_address;
+    } else {
+      // zero-initialized like the original memory object in mimium_main.
+      memobj_container.emplace_back(std::make_unique<double[]>(memobj_len));  // NOLINT
+      v.memobj = memobj_container.back().get();
+    }
+  }
+  ranges = std::make_unique<Range[]>(this->numthreads);  // NOLINT
+  for (int t = 0; t < this->numthreads; t++) {
+    ranges[t].begin = numvoices * t / this->numthreads;
+    ranges[t].end = numvoices * (t + 1) / this->numthreads;
+    ranges[t].next.store(ranges[t].end);
+  }
+  for (int t = 1; t < this->numthreads; t++) {
+    workers.emplace_back([this, t]() { workerLoop(t); });
+    setRealtimeAndAffinity(workers.back(), t);
+  }
+  Logger::debug_log("Voice pool: " + std::to_string(numvoices) + " voices on " +
+                        std::to_string(this->numthreads) + " threads",
+                    Logger::INFO);
+}
+
+VoicePool::~VoicePool() {
+  {
+    std::lock_guard<std::mutex> lock(mtx);
+    quit.store(true);
+  }
+  cv.notify_all();
+  for (auto& w : workers) { w.join(); }
+}
+
+template <typename T>
+void VoicePool::process(T* output, const T* input, int nframes) {
+  cur_input = input;
+  cur_nframes = nframes;
+  remaining.store(getNumVoices(), std::memory_order_relaxed);
+  for (int t = 0; t < numthreads; t++) {
+    ranges[t].next.store(ranges[t].begin, std::memory_order_release);
+  }
+  epoch.fetch_add(1, std::memory_order_release);
+  // no lock here not to block audio thread. a worker missed the notification wakes up by timeout
+  // and the others(including this thread) steal its voices in the meantime.
+  if (!workers.empty()) { cv.notify_all(); }
+  runVoices(0);
+  while (remaining.load(std::memory_order_acquire) > 0) { std::this_thread::yield(); }
+
+  const size_t len = static_cast<size_t>(nframes) * dsp.out_numchs;
+  std::copy_n(voices[0].getOutput<T>().cbegin(), len, output);
+  for (auto iter = std::next(voices.begin()); iter != voices.end(); ++iter) {
+    const auto& voiceout = iter->getOutput<T>();
+    for (size_t i = 0; i < len; i++) { output[i] += voiceout[i]; }
+  }
+}
+template void VoicePool::process<double>(double*, const double*, int);
+template void VoicePool::process<float>(float*, const float*, int);
+
+void VoicePool::workerLoop(int index) {
+  RtLogger::setRealtimeThread(true);
+  is_dsp_worker_thread = true;
+  uint64_t seen = 0;
+  while (true) {
+    for (int i = 0; i < spin_count && epoch.load(std::memory_order_acquire) == seen; i++) {
+      if (quit.load()) { return; }
+      std::this_thread::yield();
+    }
+    if (epoch.load(std::memory_order_acquire) == seen) {
+      std::unique_lock<std::mutex> lock(mtx);
+      cv.wait_for(lock, sleep_timeout, [&]() {
+        return quit.load() || epoch.load(std::memory_order_acquire) != seen;
+      });
+    }
+    if (quit.load()) { return; }
+    seen = epoch.load(std::memory_order_acquire);
+    runVoices(index);
+  }
+}
+
+void VoicePool::runVoices(int index) {
+  // own range first, then steal from the following threads in turn.
+  for (int t = 0; t < numthreads; t++) {
+    auto& range = ranges[(index + t) % numthreads];
+    while (true) {
+      int v = range.next.fetch_add(1, std::memory_order_acq_rel);
+      if (v >= range.end) { break; }
+      current_voice_index = v;
+      renderVoice(voices[v]);
+      remaining.fetch_sub(1, std::memory_order_release);
+    }
+  }
+  current_voice_index = 0;
+}
+
+void VoicePool::renderVoice(Voice& v) {
+  if (dsp.precision == FloatPrecision::F32) {
+    renderVoiceT<float>(v);
+  } else {
+    renderVoiceT<double>(v);
+  }
+}
+
+template <typename T>
+void VoicePool::renderVoiceT(Voice& v) {
+  auto* output = v.getOutput<T>().data();
+  const auto* input = static_cast<const T*>(cur_input);
+  if (dsp.block_fn != nullptr) {
+    auto* block_fn = reinterpret_cast<DspBlockFnPtrT<T>>(dsp.block_fn);  // NOLINT
+    block_fn(output, input, cur_nframes, dsp.cls_address, v.memobj);
+    return;
+  }
+  auto* fn = reinterpret_cast<DspFnPtrT<T>>(dsp.fn);  // NOLINT
+  for (int count = 0; count < cur_nframes; count++) {
+    current_frame_offset = count;
+    fn(std::next(output, count * dsp.out_numchs), std::next(input, count * dsp.in_numchs),
+       dsp.cls_address, v.memobj);
+  }
+  current_frame_offset = 0;
+}
+
+void VoicePool::setRealtimeAndAffinity(std::thread& t, int cpu) {
+#if defined(__linux__)
+  auto handle = t.native_handle();
+  cpu_set_t cpuset;
+  CPU_ZERO(&cpuset);
+  CPU_SET(cpu % static_cast<int>(std::thread::hardware_concurrency()), &cpuset);
+  if (pthread_setaffinity_np(handle, sizeof(cpu_set_t), &cpuset) != 0) {
+    Logger::debug_log("Failed to pin voice worker thread to cpu " + std::to_string(cpu),
+                      Logger::INFO);
+  }
+  // real-time priority usually needs privilege. keep running with normal priority if failed.
+  sched_param param{};
+  param.sched_priority = sched_get_priority_max(SCHED_FIFO) - 1;
+  if (pthread_setschedparam(handle, SCHED_FIFO, &param) != 0) {
+    Logger::debug_log("Failed to set real-time priority to voice worker thread", Logger::INFO);
+  }
+#else
+  (void)t;
+  (void)cpu;
+#endif
+}
+
+}  // namespace mimium
@@ -0,0 +1,91 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+#include "export.hpp"
+#include "runtime/runtime_defs.hpp"
+
+namespace mimium {
+
+// index of the voice being rendered, read by voiceindex() in dsp so that voices can differ. 0
+// outside of the voice pool.
+inline thread_local int current_voice_index = 0;  // NOLINT
+
+// Renders N independent instances(voices) of the dsp function in parallel and sums them into the
+// output. Each voice has its own copy of the memory object while the closure is shared, and
+// voices are told apart by current_voice_index.
+// Voices are split into a contiguous range for each thread. A thread which finished its own range
+// steals remaining voices from the ranges of other threads. The calling thread(audio callback)
+// works as the first worker, so numthreads=1 runs without any worker thread.
+// Tasks added by dsp on worker threads are queued through Scheduler::addTaskAsync() and moved to
+// the scheduler at the next tick.
+class MIMIUM_DLL_PUBLIC VoicePool {
+ public:
+  // maxframes is the largest nframes passed to process(). numthreads=0 uses number of cores.
+  VoicePool(DspFnInfos const& dspinfos, int numvoices, int numthreads, int maxframes);
+  ~VoicePool();
+  VoicePool(VoicePool const&) = delete;
+  VoicePool& operator=(VoicePool const&) = delete;
+  // interleaved buffers in the same layout as dsp_block. T is float if dsp precision is F32,
+  // otherwise double.
+  template <typename T>
+  void process(T* output, const T* input, int nframes);
+  [[nodiscard]] int getNumVoices() const { return static_cast<int>(voices.size()); }
+  [[nodiscard]] int getNumThreads() const { return numthreads; }
+
+ private:
+  struct Voice {
+    void* memobj = nullptr;
+    // only the one for dsp precision is allocated.
+    std::vector<double> output;
+    std::vector<float> output_f32;
+    template <typename T>
+    std::vector<T>& getOutput() {
+      if constexpr (std::is_same_v<T, float>) {
+        return output_f32;
+      } else {
+        return output;
+      }
+    }
+  };
+  // range of voices assigned to a thread. aligned to avoid false sharing between threads.
+  struct alignas(64) Range {
+    std::atomic<int> next{0};
+    int begin = 0;
+    int end = 0;
+  };
+  DspFnInfos dsp;
+  std::vector<Voice> voices;
+  // memory objects for voices other than the first one, which uses the original.
+  std::vector<std::unique_ptr<double[]>> memobj_container;  // NOLINT
+  int numthreads;
+  std::unique_ptr<Range[]> ranges;  // NOLINT
+  std::vector<std::thread> workers;
+
+  // parameters of the current block, written before the ranges are reset.
+  const void* cur_input = nullptr;
+  int cur_nframes = 0;
+  std::atomic<int> remaining{0};
+  std::atomic<uint64_t> epoch{0};
+  std::atomic<bool> quit{false};
+  std::mutex mtx;
+  std::condition_variable cv;
+
+  void workerLoop(int index);
+  // render voices of own range, then steal from others.
+  void runVoices(int index);
+  void renderVoice(Voice& v);
+  template <typename T>
+  void renderVoiceT(Voice& v);
+  static void setRealtimeAndAffinity(std::thread& t, int cpu);
+};
+
+}  // namespace mimium
@@ -0,0 +1,219 @@
+#include "gtest/gtest.h"
+#include "gtest/internal/gtest-port.h"
+#include "runtime/backend/audiodriver.hpp"
+
+namespace mimium {
+namespace {
+constexpr int framesize = 8;
+constexpr double gain = 2.0;
+
+// dsp(in:(float,float)) -> (float,float) multiplying each channel by gain.
+void gainFrame(double* out, const double* in, void* /*cls*/, void* /*memobj*/) {
+  out[0] = in[0] * gain;  // NOLINT
+  out[1] = in[1] * gain;  // NOLINT
+}
+void gainBlock(double* out, const double* in, int64_t nframes, void* cls, void* memobj) {
+  for (int64_t i = 0; i < nframes; i++) { gainFrame(out + i * 2, in + i * 2, cls, memobj); }  // NOLINT
+}
+void gainPlanar(double* const* out, const double* const* in, int64_t nframes, void* /*cls*/,
+                void* /*memobj*/) {
+  for (int ch = 0; ch < 2; ch++) {
+    for (int64_t i = 0; i < nframes; i++) { out[ch][i] = in[ch][i] * gain; }  // NOLINT
+  }
+}
+
+// swapped with gainFrame in the tests of swapDsp.
+constexpr double newgain = 4.0;
+void newGainFrame(double* out, const double* in, void* /*cls*/, void* /*memobj*/) {
+  out[0] = in[0] * newgain;  // NOLINT
+  out[1] = in[1] * newgain;  // NOLINT
+}
+void newGainBlock(double* out, const double* in, int64_t nframes, void* cls, void* memobj) {
+  for (int64_t i = 0; i < nframes; i++) { newGainFrame(out + i * 2, in + i * 2, cls, memobj); }  // NOLINT
+}
+// outputs the sum of the first input channel, kept in the memory object.
+void sumFrame(double* out, const double* in, void* /*cls*/, void* memobj) {
+  auto* sum = static_cast<double*>(memobj);
+  *sum += in[0];     // NOLINT
+  out[0] = *sum;     // NOLINT
+  out[1] = *sum;     // NOLINT
+}
+std::unique_ptr<DspFnInfos> makeInfos(DspFnPtr fn, DspBlockFnPtr block_fn, double* memobj = nullptr,
+                                      uint64_t layout = 0) {
+  auto infos = std::make_unique<DspFnInfos>(DspFnInfos{fn, nullptr, memobj, 2, 2, block_fn, 0});
+  if (memobj != nullptr) { infos->memobj_size = sizeof(double); }
+  infos->memobj_layout = layout;
+  return infos;
+}
+
+class TestAudioDriver : public AudioDriver {
+ public:
+  TestAudioDriver(int device_ins, int device_outs, bool hasplanar)
+      : device_ins(device_ins), device_outs(device_outs) {
+    auto infos = std::make_unique<DspFnInfos>(
+        DspFnInfos{&gainFrame, nullptr, nullptr, 2, 2, &gainBlock, 0});
+    if (hasplanar) { infos->planar_block_fn = &gainPlanar; }
+    setDspFnInfos(std::move(infos));
+    setup(getDefaultAudioParameter(48000, framesize));
+    start();
+  }
+  bool start() override {
+    AudioDriver::start();
+    sch.start(true);
+    return true;
+  }
+  bool stop() override { return true; }
+  [[nodiscard]] std::unique_ptr<AudioDriverParams> getDefaultAudioParameter(
+      std::optional<int> sr, std::optional<int> frames) const override {
+    return std::make_unique<AudioDriverParams>(AudioDriverParams{
+        static_cast<double>(sr.value()), frames.value() * getSampleSize(), frames.value(),
+        device_ins, device_outs});
+  }
+
+ private:
+  int device_ins;
+  int device_outs;
+};
+
+// channel ch of frame i is ch * 100 + i.
+double inputSample(int ch, int i) { return ch * 100.0 + i; }
+
+void checkPlanar(int device_ins, int device_outs, bool hasplanar) {
+  TestAudioDriver driver(device_ins, device_outs, hasplanar);
+  EXPECT_EQ(driver.hasPlanarDsp(), hasplanar);
+  std::vector<std::vector<double>> in(device_ins, std::vector<double>(framesize));
+  std::vector<std::vector<double>> out(device_outs, std::vector<double>(framesize, -1.0));
+  std::vector<const double*> inptrs;
+  std::vector<double*> outptrs;
+  for (int ch = 0; ch < device_ins; ch++) {
+    for (int i = 0; i < framesize; i++) { in[ch][i] = inputSample(ch, i); }
+    inptrs.push_back(in[ch].data());
+  }
+  for (auto& o : out) { outptrs.push_back(o.data()); }
+  EXPECT_TRUE(driver.process(inptrs.data(), outptrs.data(), framesize));
+  for (int ch = 0; ch < device_outs; ch++) {
+    for (int i = 0; i < framesize; i++) {
+      // dsp inputs without device channel are zero, device outputs without dsp channel are zero.
+      const double expect = (ch < 2 && ch < device_ins) ? inputSample(ch, i) * gain : 0.0;
+      EXPECT_DOUBLE_EQ(out[ch][i], expect) << "ch " << ch << " frame " << i;
+    }
+  }
+}
+
+void checkInterleaved(int device_ins, int device_outs) {
+  TestAudioDriver driver(device_ins, device_outs, false);
+  std::vector<double> in(framesize * device_ins);
+  std::vector<double> out(framesize * device_outs, -1.0);
+  for (int i = 0; i < framesize; i++) {
+    for (int ch = 0; ch < device_ins; ch++) { in[i * device_ins + ch] = inputSample(ch, i); }
+  }
+  EXPECT_TRUE(driver.process(in.data(), out.data(), framesize));
+  for (int i = 0; i < framesize; i++) {
+    for (int ch = 0; ch < device_outs; ch++) {
+      const double expect = (ch < 2 && ch < device_ins) ? inputSample(ch, i) * gain : 0.0;
+      EXPECT_DOUBLE_EQ(out[i * device_outs + ch], expect) << "ch " << ch << " frame " << i;
+    }
+  }
+}
+}  // namespace
+
+TEST(audiodriver, planar) {  // NOLINT
+  checkPlanar(2, 2, true);
+  checkPlanar(1, 3, true);
+  checkPlanar(3, 1, true);
+}
+
+TEST(audiodriver, planarfallback) {  // NOLINT
+  checkPlanar(2, 2, false);
+  checkPlanar(1, 3, false);
+  checkPlanar(3, 1, false);
+}
+
+TEST(audiodriver, interleaved) {  // NOLINT
+  checkInterleaved(2, 2);
+  checkInterleaved(1, 3);
+  checkInterleaved(3, 1);
+}
+
+TEST(audiodriver, noninterleaved) {  // NOLINT
+  TestAudioDriver driver(2, 2, true);
+  std::vector<double> in(framesize * 2);
+  std::vector<double> out(framesize * 2, -1.0);
+  for (int ch = 0; ch < 2; ch++) {
+    for (int i = 0; i < framesize; i++) { in[ch * framesize + i] = inputSample(ch, i); }
+  }
+  EXPECT_TRUE(driver.processNonInterleaved(in.data(), out.data(), framesize));
+  for (int ch = 0; ch < 2; ch++) {
+    for (int i = 0; i < framesize; i++) {
+      EXPECT_DOUBLE_EQ(out[ch * framesize + i], inputSample(ch, i) * gain);
+    }
+  }
+}
+
+TEST(audiodriver, stats) {  // NOLINT
+  TestAudioDriver driver(2, 2, true);
+  std::vector<double> in(framesize * 2);
+  std::vector<double> out(framesize * 2);
+  EXPECT_TRUE(driver.process(in.data(), out.data(), framesize));
+  EXPECT_EQ(driver.getStats().snapshot().callbacks, 0U);
+  driver.setStatsEnabled(true);
+  EXPECT_TRUE(driver.process(in.data(), out.data(), framesize));
+  EXPECT_TRUE(driver.processNonInterleaved(in.data(), out.data(), framesize));
+  driver.reportXrun();
+  auto s = driver.getStats().snapshot();
+  EXPECT_EQ(s.callbacks, 2U);
+  EXPECT_EQ(s.dsp.count, 2U);
+  EXPECT_EQ(s.xruns, 1U);
+  EXPECT_GE(s.callback.max, s.dsp.max);
+}
+
+TEST(audiodriver, swap) {  // NOLINT
+  TestAudioDriver driver(2, 2, true);
+  std::vector<double> in(framesize * 2, 1.0);
+  std::vector<double> out(framesize * 2);
+  constexpr int fade = framesize * 2;
+  EXPECT_TRUE(driver.swapDsp(makeInfos(&newGainFrame, &newGainBlock), fade / 48000.0));
+  // the last swap is not finished yet.
+  EXPECT_FALSE(driver.swapDsp(makeInfos(&newGainFrame, &newGainBlock), 0));
+  EXPECT_EQ(driver.takeRetiredDsp(), nullptr);
+  for (int block = 0; block < 2; block++) {
+    EXPECT_TRUE(driver.process(in.data(), out.data(), framesize));
+    for (int i = 0; i < framesize; i++) {
+      const double g = (block * framesize + i) / static_cast<double>(fade);
+      EXPECT_DOUBLE_EQ(out[i * 2], newgain * g + gain * (1 - g)) << "frame " << i;
+    }
+  }
+  auto retired = driver.takeRetiredDsp();
+  ASSERT_NE(retired, nullptr);
+  EXPECT_EQ(retired->fn, &gainFrame);
+  EXPECT_EQ(driver.takeRetiredDsp(), nullptr);
+  EXPECT_TRUE(driver.process(in.data(), out.data(), framesize));
+  for (auto& o : out) { EXPECT_DOUBLE_EQ(o, newgain); }
+  auto mono = makeInfos(&newGainFrame, &newGainBlock);
+  mono->out_numchs = 1;
+  EXPECT_THROW(driver.swapDsp(std::move(mono), 0), std::runtime_error);  // NOLINT
+}
+
+TEST(audiodriver, swapstate) {  // NOLINT
+  TestAudioDriver driver(2, 2, false);
+  double mem1 = 0;
+  double mem2 = 0;
+  double mem3 = 0;
+  driver.setDspFnInfos(makeInfos(&sumFrame, nullptr, &mem1, 1));
+  driver.setup(driver.getDefaultAudioParameter(48000, framesize));
+  std::vector<double> in(framesize * 2, 1.0);
+  std::vector<double> out(framesize * 2);
+  EXPECT_TRUE(driver.process(in.data(), out.data(), framesize));
+  // state is carried over to the dsp with the same layout.
+  EXPECT_TRUE(driver.swapDsp(makeInfos(&sumFrame, nullptr, &mem2, 1), 0));
+  EXPECT_TRUE(driver.process(in.data(), out.data(), framesize));
+  EXPECT_DOUBLE_EQ(mem1, framesize);
+  EXPECT_DOUBLE_EQ(mem2, framesize * 2);
+  EXPECT_NE(driver.takeRetiredDsp(), nullptr);
+  // and not for different layout.
+  EXPECT_TRUE(driver.swapDsp(makeInfos(&sumFrame, nullptr, &mem3, 2), 0));
+  EXPECT_TRUE(driver.process(in.data(), out.data(), framesize));
+  EXPECT_DOUBLE_EQ(mem3, framesize);
+  EXPECT_DOUBLE_EQ(out[(framesize - 1) * 2], framesize);
+}
+}  // namespace mimium
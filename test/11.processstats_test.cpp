@@ -0,0 +1,87 @@
+#include <sstream>
+#include <thread>
+#include "gtest/gtest.h"
+#include "gtest/internal/gtest-port.h"
+#include "runtime/backend/process_stats.hpp"
+
+namespace mimium {
+
+TEST(processstats, bucket) {  // NOLINT
+  // buckets are contiguous and each value is in [lowerbound(i), lowerbound(i+1)).
+  for (uint64_t ns : {0ULL, 1ULL, 3ULL, 4ULL, 7ULL, 8ULL, 1000ULL, 123456789ULL, ~0ULL}) {
+    auto i = LatencyHistogram::bucketOf(ns);
+    ASSERT_LT(i, LatencyHistogram::num_buckets);
+    EXPECT_LE(LatencyHistogram::bucketLowerBound(i), ns);
+    if (i + 1 < LatencyHistogram::num_buckets) {
+      EXPECT_LT(ns, LatencyHistogram::bucketLowerBound(i + 1));
+    }
+  }
+  for (size_t i = 0; i < LatencyHistogram::num_buckets; i++) {
+    EXPECT_EQ(LatencyHistogram::bucketOf(LatencyHistogram::bucketLowerBound(i)), i);
+  }
+}
+
+TEST(processstats, percentile) {  // NOLINT
+  LatencyHistogram h;
+  EXPECT_EQ(h.snapshot().percentile(50), 0U);
+  for (uint64_t i = 1; i <= 1000; i++) { h.record(i * 1000); }
+  auto s = h.snapshot();
+  EXPECT_EQ(s.count, 1000U);
+  EXPECT_EQ(s.max, 1000000U);
+  // within the resolution of buckets.
+  EXPECT_NEAR(static_cast<double>(s.percentile(50)), 500000.0, 500000.0 * 0.25);
+  EXPECT_NEAR(static_cast<double>(s.percentile(99)), 990000.0, 990000.0 * 0.25);
+  EXPECT_EQ(s.percentile(100), 1000000U);
+  // percentiles of the interval after the snapshot.
+  for (int i = 0; i < 10; i++) { h.record(10); }
+  auto diff = h.snapshot() - s;
+  EXPECT_EQ(diff.count, 10U);
+  EXPECT_LE(diff.percentile(99), 11U);
+}
+
+TEST(processstats, record) {  // NOLINT
+  ProcessStats stats;
+  // 64 frames at 48kHz is 1.33ms.
+  stats.record(ProcessTiming{400000, 100000}, 600000, 64, 48000);
+  stats.record(ProcessTiming{1500000, 100000}, 2000000, 64, 48000);
+  stats.reportXrun();
+  auto s = stats.snapshot();
+  EXPECT_EQ(s.callbacks, 2U);
+  EXPECT_EQ(s.deadline_misses, 1U);
+  EXPECT_EQ(s.xruns, 1U);
+  EXPECT_EQ(s.io.max, 400000U);
+  EXPECT_EQ(s.dsp.max, 1500000U);
+  EXPECT_EQ(s.load.max, 1500U);
+  EXPECT_NE(s.toString().find("deadline misses 1"), std::string::npos);
+}
+
+TEST(processstats, concurrentread) {  // NOLINT
+  ProcessStats stats;
+  constexpr int count = 100000;
+  std::thread writer([&]() {
+    for (int i = 0; i < count; i++) { stats.record(ProcessTiming{100, 10}, 200, 64, 48000); }
+  });
+  uint64_t last = 0;
+  while (last < count) {
+    auto s = stats.snapshot();
+    // counters are never ahead of histograms and never go back.
+    EXPECT_LE(s.callbacks, s.callback.count);
+    EXPECT_GE(s.callbacks, last);
+    last = s.callbacks;
+  }
+  writer.join();
+  EXPECT_EQ(stats.snapshot().dsp.count, static_cast<uint64_t>(count));
+}
+
+TEST(processstats, reporter) {  // NOLINT
+  ProcessStats stats;
+  std::ostringstream out;
+  {
+    ProcessStatsReporter reporter(stats, out, std::chrono::milliseconds(1));
+    stats.record(ProcessTiming{100, 10}, 200, 64, 48000);
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  }
+  EXPECT_NE(out.str().find("[stats] total: callbacks 1"), std::string::npos);
+}
+
+}  // namespace mimium
@@ -0,0 +1,75 @@
+#include <sstream>
+#include <thread>
+#include "basic/rt_logger.hpp"
+#include "gtest/gtest.h"
+#include "gtest/internal/gtest-port.h"
+
+namespace mimium {
+
+TEST(rtlogger, write) {  // NOLINT
+  std::ostringstream out;
+  {
+    RtLogger logger(out);
+    EXPECT_TRUE(logger.print("%g\n", 2.55255e+08));
+    EXPECT_TRUE(logger.print("%g", 0.5));
+    // split into multiple records.
+    const std::string longstr(RtLogger::record_size * 2 + 10, 'a');
+    EXPECT_TRUE(logger.write(longstr));
+    logger.flush();
+    EXPECT_EQ(out.str(), "2.55255e+08\n0.5" + longstr);
+  }
+}
+
+TEST(rtlogger, multithread) {  // NOLINT
+  std::ostringstream out;
+  constexpr int num_threads = 4;
+  constexpr int count = 1000;
+  {
+    // smaller than the number of messages, non real-time threads wait for the space.
+    RtLogger logger(out, 64, std::chrono::milliseconds(1));
+    std::vector<std::thread> threads;
+    for (int t = 0; t < num_threads; t++) {
+      threads.emplace_back([&]() {
+        for (int i = 0; i < count; i++) { logger.write("x\n"); }
+      });
+    }
+    for (auto& t : threads) { t.join(); }
+  }
+  const auto res = out.str();
+  EXPECT_EQ(std::count(res.cbegin(), res.cend(), 'x'), num_threads * count);
+}
+
+TEST(rtlogger, realtimedrop) {  // NOLINT
+  std::ostringstream out;
+  // long interval so that the buffer is not drained while pushing.
+  RtLogger logger(out, 4, std::chrono::seconds(10));
+  std::thread rt([&]() {
+    RtLogger::setRealtimeThread(true);
+    EXPECT_TRUE(RtLogger::isRealtimeThread());
+    int failed = 0;
+    for (int i = 0; i < 16; i++) { failed += logger.write("x") ? 0 : 1; }
+    EXPECT_GT(failed, 0);
+    EXPECT_EQ(logger.getDropped(), static_cast<uint64_t>(failed));
+  });
+  rt.join();
+  EXPECT_FALSE(RtLogger::isRealtimeThread());
+}
+
+TEST(rtlogger, threadstdout) {  // NOLINT
+  std::ostringstream out;
+  {
+    RtLogger logger(out);
+    std::thread th([&]() {
+      RtLogger::setThreadStdout(&logger);
+      EXPECT_EQ(&RtLogger::getStdout(), &logger);
+      RtLogger::getStdout().print("%d", 42);
+      RtLogger::setThreadStdout(nullptr);
+    });
+    th.join();
+    EXPECT_NE(&RtLogger::getStdout(), &logger);
+    logger.flush();
+  }
+  EXPECT_EQ(out.str(), "42");
+}
+
+}  // namespace mimium
@@ -0,0 +1,54 @@
+#include <sstream>
+#include "basic/pass_timer.hpp"
+#include "gtest/gtest.h"
+#include "gtest/internal/gtest-port.h"
+
+namespace mimium {
+
+TEST(passtimer, aggregate) {  // NOLINT
+  PassTimer timer;
+  timer.add("compiler", "parse", 1.0, 100, 2048);
+  timer.add("llvm passes", "InstCombinePass", 0.5);
+  timer.add("llvm passes", "InstCombinePass", 0.25);
+  auto entries = timer.getEntries();
+  ASSERT_EQ(entries.size(), 2U);
+  EXPECT_EQ(entries[0].name, "parse");
+  EXPECT_EQ(entries[0].peak_rss_bytes, 2048U);
+  EXPECT_EQ(entries[1].count, 2U);
+  EXPECT_DOUBLE_EQ(entries[1].wall_ms, 0.75);
+}
+
+TEST(passtimer, scope) {  // NOLINT
+  PassTimer timer;
+  {
+    PassTimer::Scope t(&timer, "compiler", "type inference");
+    std::vector<int> v(1024 * 1024);
+    EXPECT_EQ(v.size(), 1024U * 1024U);
+  }
+  { PassTimer::Scope t(nullptr, "compiler", "ignored"); }
+  auto entries = timer.getEntries();
+  ASSERT_EQ(entries.size(), 1U);
+  EXPECT_EQ(entries[0].count, 1U);
+  EXPECT_GE(entries[0].wall_ms, 0.0);
+#if defined(__linux__)
+  EXPECT_GT(entries[0].peak_rss_bytes, 0U);
+#endif
+}
+
+TEST(passtimer, json) {  // NOLINT
+  PassTimer timer;
+  timer.add("llvm passes", R"(RequireAnalysisPass<"quoted">)", 1.5);
+  std::ostringstream out;
+  timer.printJson(out);
+  const auto str = out.str();
+  EXPECT_EQ(str.front(), '{');
+  EXPECT_NE(str.find(R"("group":"llvm passes")"), std::string::npos);
+  EXPECT_NE(str.find(R"("name":"RequireAnalysisPass<\"quoted\">")"), std::string::npos);
+  EXPECT_NE(str.find(R"("wall_ms":1.5)"), std::string::npos);
+  EXPECT_NE(str.find(R"("count":1)"), std::string::npos);
+  std::ostringstream table;
+  timer.print(table);
+  EXPECT_NE(table.str().find("llvm passes:"), std::string::npos);
+}
+
+}  // namespace mimium
@@ -0,0 +1,45 @@
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "basic/symbol.hpp"
+#include "gtest/gtest.h"
+#include "gtest/internal/gtest-port.h"
+
+namespace mimium {
+
+TEST(symbol, intern) {  // NOLINT
+  SymbolId a = "symbol_test_a";
+  SymbolId b = std::string("symbol_test_") + "a";
+  SymbolId c = "symbol_test_c";
+  EXPECT_EQ(a, b);
+  EXPECT_EQ(a.getId(), b.getId());
+  EXPECT_EQ(&a.str(), &b.str());
+  EXPECT_NE(a, c);
+  EXPECT_EQ(c.str(), "symbol_test_c");
+  EXPECT_EQ(a + "_ptr", "symbol_test_a_ptr");
+  EXPECT_TRUE(SymbolId().empty());
+  EXPECT_EQ(SymbolId(""), SymbolId());
+  std::unordered_map<SymbolId, int> map{{a, 1}};
+  EXPECT_EQ(map.at(b), 1);
+}
+
+TEST(symbol, threads) {  // NOLINT
+  constexpr int num_threads = 4;
+  constexpr int num_symbols = 1000;
+  std::vector<std::vector<SymbolId>> results(num_threads);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_threads; t++) {
+    threads.emplace_back([&, t]() {
+      for (int i = 0; i < num_symbols; i++) {
+        results[t].emplace_back("symbol_test_thread" + std::to_string(i));
+      }
+    });
+  }
+  for (auto& th : threads) { th.join(); }
+  for (int i = 0; i < num_symbols; i++) {
+    for (int t = 1; t < num_threads; t++) { EXPECT_EQ(results[0][i], results[t][i]); }
+    EXPECT_EQ(results[0][i].str(), "symbol_test_thread" + std::to_string(i));
+  }
+}
+
+}  // namespace mimium
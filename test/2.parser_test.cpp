@@ -1,5 +1,6 @@
 #include "basic/ast.hpp"
 #include "basic/ast_to_string.hpp"
+#include "compiler/ast_cache.hpp"
 #include "compiler/ast_loader.hpp"
 #include "mimium_parser.hpp"
 #include "compiler/scanner.hpp"
@@ -37,4 +38,51 @@ TEST(parser, ast_complete) {//NOLINT
   // std::cerr << ast << "\n";
 }
 
+TEST(parser, ast_cache) {  // NOLINT
+  const std::string lib = "x = 1\nfn add(a,b){\n    return a+b\n}\n";
+  const std::string comment = "/*\nfn commented(){\n}\n*/\n";
+  auto source = lib + comment + "fn dsp(){\n    return add(x,2)\n}\n";
+  auto chunks = AstCache::splitTopLevel(source);
+  ASSERT_EQ(chunks.size(), 2);
+  EXPECT_EQ(chunks[1].first_line, 9);
+  AstCache cache;
+  Driver driver{};
+  std::ostringstream expected;
+  std::ostringstream actual;
+  expected << *Driver{}.parseString(source);
+  actual << *cache.parse(driver, source);
+  EXPECT_EQ(actual.str(), expected.str());
+  EXPECT_EQ(cache.getLastStats().parsed, 2);
+  // only the edited function is parsed again.
+  source = lib + comment + "fn dsp(){\n    return add(x,3)\n}\n";
+  expected.str("");
+  actual.str("");
+  expected << *Driver{}.parseString(source);
+  actual << *cache.parse(driver, source);
+  EXPECT_EQ(actual.str(), expected.str());
+  EXPECT_EQ(cache.getLastStats().parsed, 1);
+  EXPECT_EQ(cache.getLastStats().reused, 1);
+}
+
+TEST(parser, ast_cache_nested) {  // NOLINT
+  // a function defined inside of another one without indentation is not a top-level definition.
+  const std::string source =
+      "fn outer(a){\nfn inner(b){\n    return b*2\n}\n    return inner(a)\n}\nfn dsp(){\n"
+      "    return outer(1)\n}\n";
+  auto chunks = AstCache::splitTopLevel(source);
+  ASSERT_EQ(chunks.size(), 2);
+  EXPECT_EQ(chunks[1].first_line, 7);
+  AstCache cache;
+  Driver driver{};
+  std::ostringstream expected;
+  std::ostringstream actual;
+  expected << *Driver{}.parseString(source);
+  actual << *cache.parse(driver, source);
+  EXPECT_EQ(actual.str(), expected.str());
+  EXPECT_FALSE(cache.getLastStats().whole);
+  // a syntax error is reported by parsing the whole source.
+  EXPECT_THROW(cache.parse(driver, source + "fn broken({\n"), std::runtime_error);
+  EXPECT_TRUE(cache.getLastStats().whole);
+}
+
 }  // namespace mimium
\ No newline at end of file
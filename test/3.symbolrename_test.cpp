@@ -7,6 +7,24 @@
 #include "gtest/internal/gtest-port.h"
 
 namespace mimium {
+TEST(symbolrename, environment) {  // NOLINT
+  RenameEnvironment env;
+  env.addToMap("x", "x0");
+  env.enterScope();
+  EXPECT_EQ(env.search("x"), SymbolId("x0"));
+  EXPECT_EQ(env.isFreeVar("x"), std::optional(true));
+  env.addToMap("x", "x1");
+  env.addToMap("x", "x2");  // ignored, already bound in this scope
+  EXPECT_EQ(env.search("x"), SymbolId("x1"));
+  EXPECT_EQ(env.isFreeVar("x"), std::optional(false));
+  // enough symbols to grow the index
+  for (int i = 0; i < 1000; i++) { env.addToMap("y" + std::to_string(i), "z" + std::to_string(i)); }
+  EXPECT_EQ(env.search("y500"), SymbolId("z500"));
+  env.exitScope();
+  EXPECT_EQ(env.search("x"), SymbolId("x0"));
+  EXPECT_EQ(env.search("y500"), std::nullopt);
+  EXPECT_EQ(env.isFreeVar("y500"), std::nullopt);
+}
 TEST(symbolrename, astcomplete) {//NOLINT
   Driver driver{};
   auto ast = driver.parseFile(TEST_ROOT_DIR "/ast_complete.mmm");
@@ -88,5 +88,10 @@ TEST(typeinfer, occurfail) {//NOLINT
   PREP(occur_failure)
   EXPECT_THROW(auto a = inferer.infer(*newast);, std::runtime_error);//NOLINT
 }
+// delay can not be called through the scheduler, whose ffi assumes the fixed buffer size.
+TEST(typeinfer, timeddelay) {//NOLINT
+  PREP(timed_delay)
+  EXPECT_THROW(auto a = inferer.infer(*newast);, std::runtime_error);//NOLINT
+}
 
 }  // namespace mimium
\ No newline at end of file
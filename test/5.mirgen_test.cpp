@@ -16,7 +16,8 @@
   auto newast = renamer.rename(ast);                                            \
   TypeInferer inferer;                                                          \
   auto& env = inferer.infer(*newast);                                           \
-  MirGenerator mirgenerator(env);
+  mir::ValuePool pool;                                                          \
+  MirGenerator mirgenerator(env, pool);
 namespace mimium {
 
 TEST(mirgen, basic) {  // NOLINT
@@ -41,4 +42,39 @@ TEST(mirgen, basic) {  // NOLINT
 )";
   EXPECT_EQ(mir::toString(mir), target);
 }
+TEST(mirgen, valuepool) {  // NOLINT
+  mir::ValuePool pool;
+  auto* block = pool.makeBlock("root");
+  std::vector<mir::valueptr> values;
+  constexpr int num = 1000;  // more than a chunk
+  for (int i = 0; i < num; i++) {
+    values.emplace_back(pool.addInstToBlock(
+        mir::instruction::Number{{"k" + std::to_string(i), types::Float{}}, double(i)}, block));
+  }
+  EXPECT_EQ(pool.size(), num);
+  for (int i = 0; i < num; i++) {
+    // ids are given in the order of creation, and values do not move.
+    EXPECT_EQ(values[i].getId(), i);
+    EXPECT_EQ(mir::getInstRef<mir::instruction::Number>(values[i]).val, i);
+    EXPECT_EQ(mir::getParent(std::get<mir::Instructions>(*values[i])), block);
+    EXPECT_EQ(block->instructions[i], values[i]);
+  }
+  mir::ValueMap<int> map;
+  EXPECT_TRUE(map.emplace(values[10], 1));
+  EXPECT_FALSE(map.emplace(values[10], 2));
+  EXPECT_EQ(map.lookup(values[10]), 1);
+  EXPECT_EQ(map.lookup(values[num - 1]), 0);
+}
+TEST(mirgen, delaysize) {  // NOLINT
+  // power of two which can read time+1 for linear interpolation
+  EXPECT_EQ(types::getDelaySize(0), 2);
+  EXPECT_EQ(types::getDelaySize(2), 4);
+  EXPECT_EQ(types::getDelaySize(1000.5), 1024);
+  EXPECT_EQ(types::getDelaySize(1023), 2048);
+  EXPECT_EQ(types::getDelaySize(48000), 65536);
+  EXPECT_EQ(types::getDelaySize(types::fixed_delaysize - 2), types::fixed_delaysize);
+  auto delaytype = types::getDelayStruct(1024);
+  auto& buftype = rv::get<types::Tuple>(delaytype.target);
+  EXPECT_EQ(rv::get<types::Array>(buftype.arg_types.back()).size, 1024);
+}
 }  // namespace mimium
\ No newline at end of file
@@ -52,3 +52,104 @@ TEST(cli, optionstage) {  // NOLINT
   EXPECT_EQ(appoption.output_path, std::nullopt);
   EXPECT_FALSE(appoption.is_verbose);
 }
+
+TEST(cli, offlinerender) {  // NOLINT
+  std::vector<const char*> args = {"/usr/local/mimium", "test_tuple.mmm", "--backend", "offline",
+                                   "--duration",        "1.5",            "--samplerate", "44100",
+                                   "--framesize",       "64",             "-o",          "out.wav"};
+  auto [appoption, climode] = mmmcli::CliApp::OptionParser()(args.size(), args.data());
+  EXPECT_EQ(climode, mmmcli::CliAppMode::Run);
+  const auto& rtopt = appoption.runtime_option;
+  EXPECT_EQ(rtopt.backend, mimium::app::BackEnd::Offline);
+  EXPECT_DOUBLE_EQ(rtopt.duration.value(), 1.5);
+  EXPECT_EQ(rtopt.samplerate.value(), 44100);
+  EXPECT_EQ(rtopt.framesize.value(), 64);
+  EXPECT_EQ(appoption.output_path.value(), "out.wav");
+}
+
+TEST(cli, invalidnumber) {  // NOLINT
+  std::vector<const char*> args = {"/usr/local/mimium", "test_tuple.mmm", "--samplerate", "fast"};
+  EXPECT_THROW(mmmcli::CliApp::OptionParser()(args.size(), args.data()), mimium::CliAppError);//NOLINT
+}
+
+TEST(cli, emitsharedobject) {  // NOLINT
+  std::vector<const char*> args = {"/usr/local/mimium", "test_tuple.mmm", "--emit-so", "-o",
+                                   "test_tuple.so"};
+  auto [appoption, climode] = mmmcli::CliApp::OptionParser()(args.size(), args.data());
+  EXPECT_EQ(climode, mmmcli::CliAppMode::Run);
+  EXPECT_EQ(appoption.compile_option.stage, mimium::app::CompileStage::EmitSharedObject);
+  EXPECT_EQ(appoption.output_path.value(), "test_tuple.so");
+}
+
+TEST(cli, sharedobjectinput) {  // NOLINT
+  std::vector<const char*> args = {"/usr/local/mimium", "test_tuple.so"};
+  auto [appoption, climode] = mmmcli::CliApp::OptionParser()(args.size(), args.data());
+  EXPECT_EQ(appoption.compile_option.stage, mimium::app::CompileStage::Run);
+  EXPECT_EQ(appoption.input.value().filetype, mimium::FileType::SharedObject);
+}
+
+TEST(cli, jitcache) {  // NOLINT
+  std::vector<const char*> args = {"/usr/local/mimium", "test_tuple.mmm", "--jit-cache",
+                                   "/tmp/mimium_cache", "--jit-cache-size", "16"};
+  auto [appoption, climode] = mmmcli::CliApp::OptionParser()(args.size(), args.data());
+  const auto& rtopt = appoption.runtime_option;
+  EXPECT_EQ(rtopt.jit_cache_dir.value(), "/tmp/mimium_cache");
+  EXPECT_EQ(rtopt.jit_cache_size_limit, uint64_t{16} * 1024 * 1024);
+}
+
+TEST(cli, lazyjit) {  // NOLINT
+  std::vector<const char*> args = {"/usr/local/mimium", "--lazy-jit", "test_tuple.mmm",
+                                   "--jit-threads", "2"};
+  auto [appoption, climode] = mmmcli::CliApp::OptionParser()(args.size(), args.data());
+  EXPECT_TRUE(appoption.runtime_option.lazy_jit);
+  EXPECT_EQ(appoption.runtime_option.jit_threads, 2U);
+  EXPECT_EQ(appoption.input.value().filepath, "test_tuple.mmm");
+}
+
+TEST(cli, voices) {  // NOLINT
+  std::vector<const char*> args = {"/usr/local/mimium", "test_tuple.mmm", "--voices", "8",
+                                   "--threads", "4"};
+  auto [appoption, climode] = mmmcli::CliApp::OptionParser()(args.size(), args.data());
+  EXPECT_EQ(appoption.runtime_option.num_voices, 8);
+  EXPECT_EQ(appoption.runtime_option.num_threads, 4);
+  std::vector<const char*> args_invalid = {"/usr/local/mimium", "test_tuple.mmm", "--voices",
+                                           "0"};
+  EXPECT_THROW(mmmcli::CliApp::OptionParser()(args_invalid.size(), args_invalid.data()),  // NOLINT
+               mimium::CliAppError);
+}
+
+TEST(cli, precision) {  // NOLINT
+  std::vector<const char*> args = {"/usr/local/mimium", "test_tuple.mmm", "--precision", "32"};
+  auto [appoption, climode] = mmmcli::CliApp::OptionParser()(args.size(), args.data());
+  EXPECT_EQ(appoption.compile_option.float_precision, mimium::FloatPrecision::F32);
+  std::vector<const char*> args_invalid = {"/usr/local/mimium", "test_tuple.mmm", "--precision",
+                                           "16"};
+  EXPECT_THROW(mmmcli::CliApp::OptionParser()(args_invalid.size(), args_invalid.data()),  // NOLINT
+               mimium::CliAppError);
+}
+
+TEST(cli, stats) {  // NOLINT
+  std::vector<const char*> args = {"/usr/local/mimium", "--stats", "test_tuple.mmm"};
+  auto [appoption, climode] = mmmcli::CliApp::OptionParser()(args.size(), args.data());
+  EXPECT_TRUE(appoption.runtime_option.show_stats);
+  EXPECT_EQ(appoption.input.value().filepath, "test_tuple.mmm");
+}
+
+TEST(cli, timepasses) {  // NOLINT
+  std::vector<const char*> args = {"/usr/local/mimium", "--time-passes", "test_tuple.mmm",
+                                   "--time-passes-json", "passes.json"};
+  auto [appoption, climode] = mmmcli::CliApp::OptionParser()(args.size(), args.data());
+  EXPECT_TRUE(appoption.time_passes);
+  EXPECT_EQ(appoption.time_passes_json.value(), "passes.json");
+  EXPECT_EQ(appoption.input.value().filepath, "test_tuple.mmm");
+}
+
+TEST(cli, optimizelevel) {  // NOLINT
+  std::vector<const char*> args = {"/usr/local/mimium", "test_tuple.mmm", "--optimize", "3"};
+  auto [appoption, climode] = mmmcli::CliApp::OptionParser()(args.size(), args.data());
+  EXPECT_EQ(appoption.runtime_option.optimize_level, mimium::OptimizeLevel::O3);
+  std::vector<const char*> args_invalid = {"/usr/local/mimium", "test_tuple.mmm", "--optimize",
+                                           "fast"};
+  EXPECT_THROW(mmmcli::CliApp::OptionParser()(args_invalid.size(), args_invalid.data()),//NOLINT
+               mimium::CliAppError);
+}
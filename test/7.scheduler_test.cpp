@@ -0,0 +1,152 @@
+#include <thread>
+#include "basic/ringbuffer.hpp"
+#include "gtest/gtest.h"
+#include "gtest/internal/gtest-port.h"
+#include "runtime/scheduler.hpp"
+#include "runtime/task_queue.hpp"
+
+namespace mimium {
+namespace {
+std::vector<double> fired_args;  // NOLINT
+void recordArg(double arg) { fired_args.push_back(arg); }
+void recordArgF32(float arg) { fired_args.push_back(arg); }
+// reschedules itself at the current time while arg is positive.
+void rescheduleSelf(double arg, void* cls) {
+  auto* sch = static_cast<Scheduler*>(cls);
+  fired_args.push_back(sch->getTime());
+  auto* fn = reinterpret_cast<void*>(&rescheduleSelf);  // NOLINT
+  if (arg > 0) { sch->addTask(sch->getTime(), fn, arg - 1, cls); }
+}
+}  // namespace
+
+TEST(scheduler, priorityqueue) {  // NOLINT
+  BoundedPriorityQueue<int, std::greater<>> queue(8);
+  for (int v : {5, 3, 7, 1, 4, 6, 2, 0}) { EXPECT_TRUE(queue.push(v)); }
+  EXPECT_FALSE(queue.push(8));
+  for (int expect = 0; expect < 8; expect++) {
+    EXPECT_EQ(queue.top(), expect);
+    queue.pop();
+  }
+  EXPECT_TRUE(queue.empty());
+  for (int v : {5, 3, 7, 1, 4, 6, 2, 0}) { queue.push(v); }
+  EXPECT_EQ(queue.removeIf([](int v) { return v % 2 == 1; }), 4);
+  for (int expect : {0, 2, 4, 6}) {
+    EXPECT_EQ(queue.top(), expect);
+    queue.pop();
+  }
+  EXPECT_TRUE(queue.empty());
+}
+
+TEST(scheduler, ringbuffer) {  // NOLINT
+  MpscRingBuffer<int> ring(4);
+  EXPECT_EQ(ring.capacity(), 4);
+  for (int i = 0; i < 4; i++) { EXPECT_TRUE(ring.tryPush(i)); }
+  EXPECT_FALSE(ring.tryPush(4));
+  int v = 0;
+  for (int i = 0; i < 4; i++) {
+    EXPECT_TRUE(ring.tryPop(v));
+    EXPECT_EQ(v, i);
+  }
+  EXPECT_FALSE(ring.tryPop(v));
+}
+
+TEST(scheduler, ringbuffer_multiproducer) {  // NOLINT
+  constexpr int num_per_thread = 10000;
+  MpscRingBuffer<int> ring(num_per_thread * 2);
+  auto producer = [&]() {
+    for (int i = 0; i < num_per_thread; i++) { ring.tryPush(1); }
+  };
+  std::thread t1(producer);
+  std::thread t2(producer);
+  t1.join();
+  t2.join();
+  int sum = 0;
+  int v = 0;
+  while (ring.tryPop(v)) { sum += v; }
+  EXPECT_EQ(sum, num_per_thread * 2);
+}
+
+TEST(scheduler, taskorder) {  // NOLINT
+  fired_args.clear();
+  Scheduler sch(4, 4);
+  sch.start(true);
+  auto* fn = reinterpret_cast<void*>(&recordArg);  // NOLINT
+  sch.addTask(3, fn, 3, nullptr);
+  sch.addTask(0, fn, 0, nullptr);
+  sch.addTask(1, fn, 1, nullptr);
+  EXPECT_TRUE(sch.addTaskAsync(2, fn, 2, nullptr));
+  for (int i = 0; i < 4; i++) { sch.incrementTime(); }
+  EXPECT_EQ(fired_args, std::vector<double>({0, 1, 2, 3}));
+  sch.addTask(5, fn, 0, nullptr);
+  for (int i = 0; i < 4; i++) { sch.addTask(6, fn, 0, nullptr); }
+  EXPECT_EQ(sch.getDroppedTaskCount(), 1);
+}
+
+TEST(scheduler, sametimeburst) {  // NOLINT
+  constexpr int num_tasks = 100000;
+  fired_args.clear();
+  Scheduler sch(num_tasks, 4);
+  sch.start(true);
+  auto* fn = reinterpret_cast<void*>(&recordArg);  // NOLINT
+  for (int i = 0; i < num_tasks; i++) { sch.addTask(0, fn, 0, nullptr); }
+  sch.incrementTime();
+  EXPECT_EQ(fired_args.size(), num_tasks);
+  EXPECT_FALSE(sch.hasTask());
+}
+
+TEST(scheduler, span) {  // NOLINT
+  fired_args.clear();
+  Scheduler sch(4, 4);
+  sch.start(true);
+  auto* fn = reinterpret_cast<void*>(&rescheduleSelf);  // NOLINT
+  sch.addTask(3, fn, 2, &sch);
+  // span ends just before the tick firing the task.
+  EXPECT_EQ(sch.beginSpan(256), 3);
+  // the time stays at the first tick while the span is processed.
+  EXPECT_EQ(sch.getTime(), 1);
+  sch.endSpan(3);
+  EXPECT_EQ(sch.getTime(), 3);
+  EXPECT_TRUE(fired_args.empty());
+  // the task fires at the beginning of the span starting at its due tick.
+  // task added at the current time fires at the next tick.
+  for (int i = 0; i < 2; i++) {
+    EXPECT_EQ(sch.beginSpan(256), 1);
+    sch.endSpan(1);
+  }
+  EXPECT_EQ(sch.beginSpan(256), 256);
+  sch.endSpan(256);
+  EXPECT_EQ(fired_args, std::vector<double>({4, 5, 6}));
+  EXPECT_EQ(sch.getTime(), 261);
+  EXPECT_EQ(sch.beginSpan(10), 10);
+}
+
+TEST(scheduler, removetasks) {  // NOLINT
+  fired_args.clear();
+  Scheduler sch(8, 4);
+  sch.start(true);
+  auto* fn = reinterpret_cast<void*>(&recordArg);  // NOLINT
+  auto* loop = reinterpret_cast<void*>(&rescheduleSelf);  // NOLINT
+  sch.addTask(1, fn, 0, nullptr);
+  sch.addTask(2, fn, 1, nullptr, 1);
+  sch.addTask(3, fn, 2, nullptr, 2);
+  sch.addTask(0, loop, 100, &sch, 1);
+  EXPECT_TRUE(sch.addTaskAsync(4, fn, 3, nullptr, 1));
+  sch.removeTasksAsync(1);
+  EXPECT_FALSE(sch.isTasksRemoved(1));
+  // the tasks of the owner, including the async one and the loop, are removed before firing.
+  for (int i = 0; i < 8; i++) { sch.incrementTime(); }
+  EXPECT_TRUE(sch.isTasksRemoved(1));
+  EXPECT_EQ(fired_args, std::vector<double>({0, 2}));
+}
+
+TEST(scheduler, floatprecision) {  // NOLINT
+  fired_args.clear();
+  Scheduler sch(4, 4);
+  sch.setFloatPrecision(FloatPrecision::F32);
+  sch.start(true);
+  auto* fn = reinterpret_cast<void*>(&recordArgF32);  // NOLINT
+  sch.addTask(0, fn, 0.5, nullptr);
+  sch.incrementTime();
+  EXPECT_EQ(fired_args, std::vector<double>({0.5}));
+}
+}  // namespace mimium
@@ -0,0 +1,112 @@
+#include "gtest/gtest.h"
+#include "gtest/internal/gtest-port.h"
+#include "runtime/scheduler.hpp"
+#include "runtime/voice_pool.hpp"
+
+namespace mimium {
+namespace {
+// accumulates input into memory object, so shared memory objects break the result.
+template <typename T>
+void accumulate(T* out, const T* in, void* /*cls*/, void* memobj) {
+  auto* sum = static_cast<T*>(memobj);
+  *sum += *in;
+  *out = *sum;
+}
+template <typename T>
+void accumulateBlock(T* out, const T* in, int64_t nframes, void* cls, void* memobj) {
+  for (int64_t i = 0; i < nframes; i++) { accumulate(out + i, in + i, cls, memobj); }  // NOLINT
+}
+int fired_tasks = 0;  // NOLINT
+void countTask(double /*arg*/) { fired_tasks++; }
+// adds a task for each frame like Runtime::addTask.
+void addTaskBlock(double* out, const double* /*in*/, int64_t nframes, void* cls, void* /*memobj*/) {
+  auto* sch = static_cast<Scheduler*>(cls);
+  auto* fn = reinterpret_cast<void*>(&countTask);  // NOLINT
+  for (int64_t i = 0; i < nframes; i++) {
+    if (is_dsp_worker_thread) {
+      sch->addTaskAsync(0, fn, 0, nullptr);
+    } else {
+      sch->addTask(0, fn, 0, nullptr);
+    }
+    out[i] = 0;  // NOLINT
+  }
+}
+void voiceIndexBlock(double* out, const double* /*in*/, int64_t nframes, void* /*cls*/,
+                     void* /*memobj*/) {
+  for (int64_t i = 0; i < nframes; i++) { out[i] = current_voice_index; }  // NOLINT
+}
+}  // namespace
+
+TEST(voicepool, independentvoices) {  // NOLINT
+  constexpr int numvoices = 16;
+  constexpr int framesize = 8;
+  for (int numthreads : {1, 4}) {
+    double memobj = 0;
+    DspFnInfos infos{
+        &accumulate<double>, nullptr, &memobj, 1, 1, &accumulateBlock<double>, sizeof(double)};
+    VoicePool pool(infos, numvoices, numthreads, framesize);
+    EXPECT_EQ(pool.getNumThreads(), numthreads);
+    std::vector<double> input(framesize, 1.0);
+    std::vector<double> output(framesize, 0.0);
+    for (int block = 0; block < 100; block++) {
+      pool.process(output.data(), input.data(), framesize);
+    }
+    EXPECT_DOUBLE_EQ(output.back(), 100.0 * framesize * numvoices);
+    // the first voice uses the original memory object.
+    EXPECT_DOUBLE_EQ(memobj, 100.0 * framesize);
+  }
+}
+
+TEST(voicepool, floatprecision) {  // NOLINT
+  constexpr int numvoices = 4;
+  constexpr int framesize = 8;
+  float memobj = 0;
+  // function pointers are stored as double version like setDspParams does.
+  DspFnInfos infos;
+  infos.fn = reinterpret_cast<DspFnPtr>(&accumulate<float>);                 // NOLINT
+  infos.block_fn = reinterpret_cast<DspBlockFnPtr>(&accumulateBlock<float>);  // NOLINT
+  infos.memobj_address = &memobj;
+  infos.in_numchs = 1;
+  infos.out_numchs = 1;
+  infos.memobj_size = sizeof(float);
+  infos.precision = FloatPrecision::F32;
+  VoicePool pool(infos, numvoices, 2, framesize);
+  std::vector<float> input(framesize, 1.0F);
+  std::vector<float> output(framesize, 0.0F);
+  pool.process(output.data(), input.data(), framesize);
+  EXPECT_FLOAT_EQ(output.back(), static_cast<float>(framesize * numvoices));
+}
+
+TEST(voicepool, tasksfromworkers) {  // NOLINT
+  constexpr int numvoices = 16;
+  constexpr int framesize = 8;
+  fired_tasks = 0;
+  Scheduler sch;
+  sch.start(true);
+  DspFnInfos infos{nullptr, &sch, nullptr, 1, 1, &addTaskBlock, 0};
+  VoicePool pool(infos, numvoices, 4, framesize);
+  std::vector<double> input(framesize, 0.0);
+  std::vector<double> output(framesize, 0.0);
+  pool.process(output.data(), input.data(), framesize);
+  sch.incrementTime();
+  EXPECT_EQ(fired_tasks, numvoices * framesize);
+}
+
+TEST(voicepool, voiceindex) {  // NOLINT
+  constexpr int numvoices = 16;
+  constexpr int framesize = 8;
+  DspFnInfos infos{nullptr, nullptr, nullptr, 1, 1, &voiceIndexBlock, 0};
+  VoicePool pool(infos, numvoices, 4, framesize);
+  std::vector<double> input(framesize, 0.0);
+  std::vector<double> output(framesize, 0.0);
+  pool.process(output.data(), input.data(), framesize);
+  EXPECT_DOUBLE_EQ(output.back(), numvoices * (numvoices - 1) / 2);
+  EXPECT_EQ(current_voice_index, 0);
+}
+
+TEST(voicepool, unknownmemobjsize) {  // NOLINT
+  double memobj = 0;
+  DspFnInfos infos{&accumulate<double>, nullptr, &memobj, 1, 1, &accumulateBlock<double>, 0};
+  EXPECT_THROW(VoicePool(infos, 4, 2, 8), std::runtime_error);  // NOLINT
+}
+}  // namespace mimium
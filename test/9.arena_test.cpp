@@ -0,0 +1,32 @@
+#include <cstdint>
+#include "gtest/gtest.h"
+#include "gtest/internal/gtest-port.h"
+#include "runtime/arena.hpp"
+
+namespace mimium {
+
+TEST(arena, alignmentandstats) {  // NOLINT
+  for (bool use_hugepage : {false, true}) {
+    Arena arena(ArenaOption{4096, use_hugepage});
+    auto* p1 = static_cast<char*>(arena.allocate(1));
+    auto* p2 = static_cast<char*>(arena.allocate(100));
+    auto* large = static_cast<char*>(arena.allocate(10000));
+    auto* p3 = static_cast<char*>(arena.allocate(0));
+    for (auto* p : {p1, p2, large, p3}) {
+      EXPECT_EQ(reinterpret_cast<uintptr_t>(p) % Arena::alignment, 0);  // NOLINT
+    }
+    // small allocations are packed in a chunk even after a large allocation.
+    EXPECT_EQ(p2 - p1, 64);
+    EXPECT_EQ(p3 - p2, 128);
+    auto stats = arena.getStats();
+    EXPECT_EQ(stats.count, 4);
+    EXPECT_EQ(stats.allocated_bytes, 64 + 128 + 10048 + 64);
+    EXPECT_GE(stats.reserved_bytes, 4096 + 10048);
+    arena.reset();
+    stats = arena.getStats();
+    EXPECT_EQ(stats.allocated_bytes, 0);
+    EXPECT_EQ(stats.reserved_bytes, 0);
+    EXPECT_EQ(stats.peak_bytes, 64 + 128 + 10048 + 64);
+  }
+}
+}  // namespace mimium
@@ -0,0 +1,92 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+#pragma once
+#include <fstream>
+#include <sstream>
+#include "compiler/codegen/llvm_header.hpp"
+#include "libmimium.hpp"
+
+// helpers shared by the benchmarks which compile mimium sources.
+
+namespace mimium::bench {
+
+constexpr int samplerate = 48000;
+constexpr int framesize = 256;
+
+// audio driver processed only by the benchmark loop.
+class BenchAudioDriver : public AudioDriver {
+ public:
+  bool start() override {
+    AudioDriver::start();
+    sch.start(dspfninfos->fn != nullptr);
+    return true;
+  }
+  bool stop() override { return true; }
+  [[nodiscard]] std::unique_ptr<AudioDriverParams> getDefaultAudioParameter(
+      std::optional<int> sr, std::optional<int> frames) const override {
+    return std::make_unique<AudioDriverParams>(AudioDriverParams{
+        static_cast<double>(sr.value_or(samplerate)), frames.value_or(framesize) * getSampleSize(),
+        frames.value_or(framesize), dspfninfos->in_numchs, dspfninfos->out_numchs});
+  }
+};
+
+inline std::string readFile(fs::path const& path) {
+  std::ifstream fin(path);
+  if (!fin) { throw std::runtime_error("Failed to open " + path.string()); }
+  std::stringstream ss;
+  ss << fin.rdbuf();
+  return ss.str();
+}
+
+// sources of examples/*.mmm and mimium-core libraries measured by the benchmarks. libraries
+// without dsp function are followed by a dsp function which uses them.
+struct BenchSource {
+  std::string label;
+  fs::path path;
+  std::string dsp;
+};
+inline const std::vector<BenchSource>& getBenchSources() {
+  static const std::vector<BenchSource> sources = {
+      {"gain.mmm", fs::path(MIMIUM_EXAMPLES_DIR) / "gain.mmm", ""},
+      {"lpf.mmm", fs::path(MIMIUM_EXAMPLES_DIR) / "lpf.mmm", ""},
+      {"adsr.mmm", fs::path(MIMIUM_EXAMPLES_DIR) / "adsr.mmm", ""},
+      {"oneliner.mmm", fs::path(MIMIUM_EXAMPLES_DIR) / "oneliner.mmm", ""},
+      {"filter.mmm", fs::path(MIMIUM_CORE_DIR) / "filter.mmm",
+       R"(
+fn dsp(){
+    out = peakfilter(random(),1000,6,1,48000)
+    return (out,out)
+}
+)"},
+  };
+  return sources;
+}
+inline std::string loadBenchSource(BenchSource const& s) { return readFile(s.path) + s.dsp; }
+
+// frontend of the compiler until llvm ir generation.
+inline void generateLLVMIr(Compiler& compiler, std::string const& source,
+                           std::string const& path, FloatPrecision precision) {
+  compiler.setFilePath(path);
+  compiler.setFloatPrecision(precision);
+  auto ast = compiler.renameSymbols(compiler.loadSource(source));
+  compiler.typeInfer(ast);
+  auto mir = compiler.closureConvert(compiler.generateMir(ast));
+  auto funobjs = compiler.collectMemoryObjs(mir);
+  compiler.generateLLVMIr(mir, funobjs);
+}
+
+// runtime with jit engine, main function is not run yet.
+inline std::unique_ptr<Runtime> compileToRuntime(std::string const& source,
+                                                 std::string const& path, OptimizeLevel level,
+                                                 FloatPrecision precision,
+                                                 std::unique_ptr<AudioDriver> driver) {
+  Compiler compiler;
+  generateLLVMIr(compiler, source, path, precision);
+  auto engine = std::make_unique<LLVMJitExecutionEngine>(
+      compiler.moveLLVMCtx(), compiler.moveLLVMModule(), path, level);
+  return std::make_unique<Runtime>(std::move(driver), std::move(engine));
+}
+
+}  // namespace mimium::bench
@@ -0,0 +1,224 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+#include <benchmark/benchmark.h>
+#include "bench_utils.hpp"
+
+// Throughput of each compiler stage on generated sources, latency of jit compilation and the cost
+// of offline rendering through AudioDriverOffline.
+// usage: mimium_bench --benchmark_filter="Parse|Rename|TypeInfer|Mir|Codegen|JitCompile|OfflineRender"
+
+namespace {
+
+const std::vector<std::string> optlevel_names = {"O0", "O1", "O2", "O3", "Os"};
+
+// a chain of num_functions functions with branches, self and mem, called from dsp.
+std::string generateSource(int num_functions) {
+  std::string res = "fn f0(x){\n    return x + mem(x)\n}\n";
+  for (int i = 1; i < num_functions; i++) {
+    const auto n = std::to_string(i);
+    res += "fn f" + n + "(x){\n    y = if(x>" + n + ") x-1 else x*0.5+" + n + ".5\n" +
+           "    return f" + std::to_string(i - 1) + "(y) + self*0.5\n}\n";
+  }
+  res += "fn dsp(){\n    out = f" + std::to_string(num_functions - 1) +
+         "(random())\n    return (out,out)\n}\n";
+  return res;
+}
+
+// a chain of num_functions functions with untyped parameters, each of which defines a closure
+// capturing the parameter. stresses unification of type variables.
+std::string generateClosureSource(int num_functions) {
+  std::string res = "fn c0(a){\n    return a\n}\n";
+  for (int i = 1; i < num_functions; i++) {
+    const auto n = std::to_string(i);
+    res += "fn c" + n + "(a){\n    fn g(y){\n        return y*0.5+a\n    }\n" +
+           "    return c" + std::to_string(i - 1) + "(g(a))+g(" + n + ")\n}\n";
+  }
+  res += "fn dsp(){\n    out = c" + std::to_string(num_functions - 1) +
+         "(random())\n    return (out,out)\n}\n";
+  return res;
+}
+
+void setThroughput(benchmark::State& state, std::string const& source) {
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+  state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(source.size()));
+}
+
+void BM_Parse(benchmark::State& state) {
+  const auto source = generateSource(static_cast<int>(state.range(0)));
+  for (auto _ : state) {
+    state.PauseTiming();
+    auto compiler = std::make_unique<mimium::Compiler>();
+    state.ResumeTiming();
+    benchmark::DoNotOptimize(compiler->loadSource(source));
+    state.PauseTiming();
+    compiler.reset();
+    state.ResumeTiming();
+  }
+  setThroughput(state, source);
+}
+
+void BM_Rename(benchmark::State& state) {
+  const auto source = generateSource(static_cast<int>(state.range(0)));
+  for (auto _ : state) {
+    state.PauseTiming();
+    auto compiler = std::make_unique<mimium::Compiler>();
+    auto ast = compiler->loadSource(source);
+    state.ResumeTiming();
+    benchmark::DoNotOptimize(compiler->renameSymbols(ast));
+    state.PauseTiming();
+    compiler.reset();
+    state.ResumeTiming();
+  }
+  setThroughput(state, source);
+}
+
+void BM_TypeInfer(benchmark::State& state) {
+  const auto source = generateSource(static_cast<int>(state.range(0)));
+  for (auto _ : state) {
+    state.PauseTiming();
+    auto compiler = std::make_unique<mimium::Compiler>();
+    auto ast = compiler->renameSymbols(compiler->loadSource(source));
+    state.ResumeTiming();
+    compiler->typeInfer(ast);
+    state.PauseTiming();
+    compiler.reset();
+    state.ResumeTiming();
+  }
+  setThroughput(state, source);
+}
+
+void BM_TypeInferClosures(benchmark::State& state) {
+  const auto source = generateClosureSource(static_cast<int>(state.range(0)));
+  for (auto _ : state) {
+    state.PauseTiming();
+    auto compiler = std::make_unique<mimium::Compiler>();
+    auto ast = compiler->renameSymbols(compiler->loadSource(source));
+    state.ResumeTiming();
+    compiler->typeInfer(ast);
+    state.PauseTiming();
+    compiler.reset();
+    state.ResumeTiming();
+  }
+  setThroughput(state, source);
+}
+
+// mir generation, closure conversion and collection of memory objects, without llvm.
+void BM_Mir(benchmark::State& state) {
+  const auto source = generateSource(static_cast<int>(state.range(0)));
+  for (auto _ : state) {
+    state.PauseTiming();
+    auto compiler = std::make_unique<mimium::Compiler>();
+    auto ast = compiler->renameSymbols(compiler->loadSource(source));
+    compiler->typeInfer(ast);
+    state.ResumeTiming();
+    auto mir = compiler->closureConvert(compiler->generateMir(ast));
+    benchmark::DoNotOptimize(compiler->collectMemoryObjs(mir));
+    state.PauseTiming();
+    compiler.reset();
+    state.ResumeTiming();
+  }
+  setThroughput(state, source);
+}
+
+// mir generation, closure conversion and llvm ir generation.
+void BM_Codegen(benchmark::State& state) {
+  const auto source = generateSource(static_cast<int>(state.range(0)));
+  for (auto _ : state) {
+    state.PauseTiming();
+    auto compiler = std::make_unique<mimium::Compiler>();
+    auto ast = compiler->renameSymbols(compiler->loadSource(source));
+    compiler->typeInfer(ast);
+    state.ResumeTiming();
+    auto mir = compiler->closureConvert(compiler->generateMir(ast));
+    auto funobjs = compiler->collectMemoryObjs(mir);
+    benchmark::DoNotOptimize(&compiler->generateLLVMIr(mir, funobjs));
+    state.PauseTiming();
+    compiler.reset();
+    state.ResumeTiming();
+  }
+  setThroughput(state, source);
+}
+
+// from llvm ir to the running main function: optimization, code generation and linking.
+void BM_JitCompile(benchmark::State& state) {
+  const auto source = generateSource(static_cast<int>(state.range(0)));
+  auto level = static_cast<mimium::OptimizeLevel>(state.range(1));
+  state.SetLabel("-" + optlevel_names.at(state.range(1)));
+  for (auto _ : state) {
+    state.PauseTiming();
+    mimium::Compiler compiler;
+    mimium::bench::generateLLVMIr(compiler, source, "jit_bench.mmm",
+                                  mimium::FloatPrecision::F64);
+    auto ctx = compiler.moveLLVMCtx();
+    auto module = compiler.moveLLVMModule();
+    state.ResumeTiming();
+    auto engine = std::make_unique<mimium::LLVMJitExecutionEngine>(
+        std::move(ctx), std::move(module), "jit_bench.mmm", level);
+    auto runtime = std::make_unique<mimium::Runtime>(
+        std::make_unique<mimium::bench::BenchAudioDriver>(), std::move(engine));
+    runtime->runMainFun();
+    state.PauseTiming();
+    runtime.reset();
+    state.ResumeTiming();
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+// whole offline rendering of a second, including file writing.
+void BM_OfflineRender(benchmark::State& state) {
+  const auto& source = mimium::bench::getBenchSources().at(state.range(0));
+  state.SetLabel(source.label);
+  const auto text = mimium::bench::loadBenchSource(source);
+  const auto output = fs::temp_directory_path() / "mimium_bench_render.wav";
+  constexpr double duration = 1.0;
+  for (auto _ : state) {
+    state.PauseTiming();
+    auto runtime = mimium::bench::compileToRuntime(
+        text, source.path.string(), mimium::OptimizeLevel::O2, mimium::FloatPrecision::F64,
+        std::make_unique<mimium::AudioDriverOffline>(output, duration,
+                                                     mimium::bench::samplerate,
+                                                     mimium::bench::framesize));
+    runtime->runMainFun();
+    state.ResumeTiming();
+    runtime->start();
+    state.PauseTiming();
+    runtime.reset();
+    state.ResumeTiming();
+  }
+  fs::remove(output);
+  const auto frames =
+      static_cast<double>(state.iterations()) * duration * mimium::bench::samplerate;
+  state.counters["ns/sample"] = benchmark::Counter(
+      frames * 1e-9, benchmark::Counter::kIsRate | benchmark::Counter::kInvert);
+}
+
+// number of generated functions.
+void stageArgs(benchmark::internal::Benchmark* b) {
+  b->RangeMultiplier(4)->Range(16, 1024)->Unit(benchmark::kMillisecond);
+}
+
+// symbol renaming, type inference and mir passes are cheap enough to be measured on larger sources.
+void mirArgs(benchmark::internal::Benchmark* b) {
+  b->RangeMultiplier(4)->Range(16, 16384)->Unit(benchmark::kMillisecond);
+}
+
+void offlineArgs(benchmark::internal::Benchmark* b) {
+  const auto num_sources = static_cast<int>(mimium::bench::getBenchSources().size());
+  for (int i = 0; i < num_sources; i++) { b->Arg(i); }
+  b->Iterations(5)->Unit(benchmark::kMillisecond);
+}
+
+}  // namespace
+
+BENCHMARK(BM_Parse)->Apply(stageArgs);      // NOLINT
+BENCHMARK(BM_Rename)->Apply(mirArgs);       // NOLINT
+BENCHMARK(BM_TypeInfer)->Apply(stageArgs);  // NOLINT
+BENCHMARK(BM_TypeInferClosures)->Apply(mirArgs);  // NOLINT
+BENCHMARK(BM_Mir)->Apply(mirArgs);          // NOLINT
+BENCHMARK(BM_Codegen)->Apply(stageArgs);    // NOLINT
+BENCHMARK(BM_JitCompile)  // NOLINT
+    ->ArgsProduct({{16, 256}, {0, 1, 2, 3, 4}})
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_OfflineRender)->Apply(offlineArgs);  // NOLINT
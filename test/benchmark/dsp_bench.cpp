@@ -0,0 +1,64 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+#include <benchmark/benchmark.h>
+#include "bench_utils.hpp"
+
+// per-sample cost of the dsp function in examples and mimium-core libraries for each
+// optimization level and float precision.
+
+namespace {
+using mimium::bench::framesize;
+using mimium::bench::samplerate;
+
+const std::vector<std::string> optlevel_names = {"O0", "O1", "O2", "O3", "Os"};
+const std::vector<std::string> precision_names = {"f64", "f32"};
+
+template <typename T>
+void runDspProcess(benchmark::State& state, mimium::AudioDriver& driver) {
+  std::vector<T> input(framesize * 2, 0.0);
+  std::vector<T> output(framesize * 2, 0.0);
+  for (auto _ : state) {
+    driver.process(input.data(), output.data(), framesize);
+    benchmark::DoNotOptimize(output.data());
+  }
+}
+
+void BM_DspProcess(benchmark::State& state) {
+  const auto& source = mimium::bench::getBenchSources().at(state.range(0));
+  auto level = static_cast<mimium::OptimizeLevel>(state.range(1));
+  auto precision = static_cast<mimium::FloatPrecision>(state.range(2));
+  state.SetLabel(source.label + " -" + optlevel_names.at(state.range(1)) + " " +
+                 precision_names.at(state.range(2)));
+  auto runtime = mimium::bench::compileToRuntime(
+      mimium::bench::loadBenchSource(source), source.path.string(), level, precision,
+      std::make_unique<mimium::bench::BenchAudioDriver>());
+  runtime->runMainFun();
+  auto& driver = runtime->getAudioDriver();
+  driver.setup(driver.getDefaultAudioParameter(samplerate, framesize));
+  driver.start();
+  if (precision == mimium::FloatPrecision::F32) {
+    runDspProcess<float>(state, driver);
+  } else {
+    runDspProcess<double>(state, driver);
+  }
+  state.SetItemsProcessed(state.iterations() * framesize);
+  state.counters["ns/sample"] = benchmark::Counter(
+      static_cast<double>(state.iterations() * framesize) * 1e-9,
+      benchmark::Counter::kIsRate | benchmark::Counter::kInvert);
+}
+
+void dspArgs(benchmark::internal::Benchmark* b) {
+  const auto num_sources = static_cast<int>(mimium::bench::getBenchSources().size());
+  for (int ex = 0; ex < num_sources; ex++) {
+    for (int level = 0; level < static_cast<int>(optlevel_names.size()); level++) {
+      for (int precision = 0; precision < static_cast<int>(precision_names.size()); precision++) {
+        b->Args({ex, level, precision});
+      }
+    }
+  }
+}
+}  // namespace
+
+BENCHMARK(BM_DspProcess)->Apply(dspArgs);  // NOLINT
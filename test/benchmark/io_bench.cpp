@@ -0,0 +1,82 @@
+#include "benchmark/benchmark.h"
+#include "runtime/backend/audiodriver.hpp"
+
+// Cost of passing buffers between the driver and dsp, with a dsp which only copies the input.
+// Compares host buffer layouts and whether the number of channels matches the device.
+// usage: mimium_bench --benchmark_filter=DriverIO
+
+namespace {
+constexpr int framesize = 256;
+constexpr int dsp_chs = 2;
+
+void copyFrame(double* out, const double* in, void* /*cls*/, void* /*memobj*/) {
+  out[0] = in[0];  // NOLINT
+  out[1] = in[1];  // NOLINT
+}
+void copyBlock(double* out, const double* in, int64_t nframes, void* /*cls*/, void* /*memobj*/) {
+  std::copy_n(in, nframes * dsp_chs, out);
+}
+void copyPlanar(double* const* out, const double* const* in, int64_t nframes, void* /*cls*/,
+                void* /*memobj*/) {
+  for (int ch = 0; ch < dsp_chs; ch++) { std::copy_n(in[ch], nframes, out[ch]); }  // NOLINT
+}
+
+enum class Layout { Interleaved = 0, Planar, PlanarWithoutPlanarDsp };
+const std::vector<std::string> layout_names = {"interleaved", "planar", "planar(copy)"};
+
+class BenchAudioDriver : public mimium::AudioDriver {
+ public:
+  BenchAudioDriver(int device_chs, bool hasplanar) : device_chs(device_chs) {
+    auto infos = std::make_unique<mimium::DspFnInfos>(
+        mimium::DspFnInfos{&copyFrame, nullptr, nullptr, dsp_chs, dsp_chs, &copyBlock, 0});
+    if (hasplanar) { infos->planar_block_fn = &copyPlanar; }
+    setDspFnInfos(std::move(infos));
+    setup(getDefaultAudioParameter(48000, framesize));
+    AudioDriver::start();
+    sch.start(true);
+  }
+  bool stop() override { return true; }
+  [[nodiscard]] std::unique_ptr<mimium::AudioDriverParams> getDefaultAudioParameter(
+      std::optional<int> sr, std::optional<int> frames) const override {
+    return std::make_unique<mimium::AudioDriverParams>(mimium::AudioDriverParams{
+        static_cast<double>(sr.value()), frames.value() * getSampleSize(), frames.value(),
+        device_chs, device_chs});
+  }
+
+ private:
+  int device_chs;
+};
+
+void BM_DriverIO(benchmark::State& state) {
+  auto layout = static_cast<Layout>(state.range(0));
+  auto device_chs = static_cast<int>(state.range(1));
+  state.SetLabel(layout_names.at(state.range(0)) + " " + std::to_string(device_chs) + "chs");
+  BenchAudioDriver driver(device_chs, layout == Layout::Planar);
+  std::vector<double> input(framesize * device_chs, 0.5);
+  std::vector<double> output(framesize * device_chs);
+  std::vector<const double*> inptrs;
+  std::vector<double*> outptrs;
+  for (int ch = 0; ch < device_chs; ch++) {
+    inptrs.push_back(std::next(input.data(), ch * framesize));
+    outptrs.push_back(std::next(output.data(), ch * framesize));
+  }
+  for (auto _ : state) {
+    if (layout == Layout::Interleaved) {
+      driver.process(input.data(), output.data(), framesize);
+    } else {
+      driver.process(inptrs.data(), outptrs.data(), framesize);
+    }
+    benchmark::DoNotOptimize(output.data());
+  }
+  state.SetItemsProcessed(state.iterations() * framesize);
+}
+
+void ioArgs(benchmark::internal::Benchmark* b) {
+  for (int layout = 0; layout < static_cast<int>(layout_names.size()); layout++) {
+    // same number of channels as dsp, and a device with more channels.
+    for (int device_chs : {dsp_chs, 8}) { b->Args({layout, device_chs}); }
+  }
+}
+}  // namespace
+
+BENCHMARK(BM_DriverIO)->Apply(ioArgs);  // NOLINT
@@ -0,0 +1,80 @@
+#include <random>
+#include "benchmark/benchmark.h"
+#include "runtime/scheduler.hpp"
+
+// Measures the cost of inserting and dispatching tasks while 10k tasks are pending.
+// usage: mimium_bench --benchmark_filter=Task
+
+namespace {
+constexpr int64_t num_pending = 10000;
+constexpr int64_t batch = 1000;
+constexpr int64_t far_future = 1LL << 40;
+
+void nop(double /*arg*/) {}
+void* nopaddress() { return reinterpret_cast<void*>(&nop); }  // NOLINT
+
+// Scheduler which exposes its queue size to the benchmark.
+class BenchScheduler : public mimium::Scheduler {
+ public:
+  BenchScheduler() : Scheduler(num_pending + batch * 2, batch) {
+    start(true);
+    std::mt19937 rng(0);
+    std::uniform_int_distribution<int64_t> dist(far_future, far_future * 2);
+    for (int64_t i = 0; i < num_pending; i++) {
+      addTask(static_cast<double>(dist(rng)), nopaddress(), 0, nullptr);
+    }
+  }
+  size_t getQueueSize() const { return tasks.size(); }
+  void popFront(int64_t n) {
+    for (int64_t i = 0; i < n; i++) { tasks.pop(); }
+  }
+};
+
+void BM_TaskInsert(benchmark::State& state) {
+  BenchScheduler sch;
+  std::mt19937 rng(1);
+  std::uniform_int_distribution<int64_t> dist(0, far_future - 1);
+  for (auto _ : state) {
+    for (int64_t i = 0; i < batch; i++) {
+      sch.addTask(static_cast<double>(dist(rng)), nopaddress(), 0, nullptr);
+    }
+    state.PauseTiming();
+    sch.popFront(batch);
+    state.ResumeTiming();
+  }
+  state.SetItemsProcessed(state.iterations() * batch);
+  state.counters["pending"] = static_cast<double>(sch.getQueueSize());
+}
+BENCHMARK(BM_TaskInsert);
+
+void BM_TaskInsertAsync(benchmark::State& state) {
+  BenchScheduler sch;
+  for (auto _ : state) {
+    for (int64_t i = 0; i < batch; i++) {
+      sch.addTaskAsync(static_cast<double>(sch.getTime() + 1), nopaddress(), 0, nullptr);
+    }
+    // moves tasks from ring buffer and dispatch them.
+    sch.incrementTime();
+    sch.incrementTime();
+  }
+  state.SetItemsProcessed(state.iterations() * batch);
+  state.counters["pending"] = static_cast<double>(sch.getQueueSize());
+}
+BENCHMARK(BM_TaskInsertAsync);
+
+void BM_TaskDispatch(benchmark::State& state) {
+  BenchScheduler sch;
+  for (auto _ : state) {
+    state.PauseTiming();
+    for (int64_t i = 0; i < batch; i++) {
+      sch.addTask(static_cast<double>(sch.getTime()), nopaddress(), 0, nullptr);
+    }
+    state.ResumeTiming();
+    sch.incrementTime();
+  }
+  state.SetItemsProcessed(state.iterations() * batch);
+  state.counters["pending"] = static_cast<double>(sch.getQueueSize());
+}
+BENCHMARK(BM_TaskDispatch);
+
+}  // namespace
@@ -0,0 +1,54 @@
+#include <thread>
+#include "benchmark/benchmark.h"
+#include "runtime/voice_pool.hpp"
+
+// Scaling of polyphonic rendering over threads. Each voice runs a cascade of biquad filters
+// written in C++ so that the result does not depend on the compiler.
+// usage: mimium_bench --benchmark_filter=Voice
+
+namespace {
+constexpr int numvoices = 64;
+constexpr int framesize = 256;
+constexpr int numstages = 16;
+
+struct BiquadState {
+  double s1[numstages];
+  double s2[numstages];
+};
+
+void biquadCascade(double* out, const double* in, void* /*cls*/, void* memobj) {
+  auto& st = *static_cast<BiquadState*>(memobj);
+  double x = *in;
+  for (int i = 0; i < numstages; i++) {
+    double w = x + 0.5 * st.s1[i] - 0.3 * st.s2[i];
+    x = 0.2 * w + 0.4 * st.s1[i] + 0.2 * st.s2[i];
+    st.s2[i] = st.s1[i];
+    st.s1[i] = w;
+  }
+  *out = x;
+}
+void biquadCascadeBlock(double* out, const double* in, int64_t nframes, void* cls, void* memobj) {
+  for (int64_t i = 0; i < nframes; i++) { biquadCascade(out + i, in + i, cls, memobj); }  // NOLINT
+}
+
+void BM_VoicePool(benchmark::State& state) {
+  auto numthreads = static_cast<int>(state.range(0));
+  BiquadState memobj{};
+  mimium::DspFnInfos infos{&biquadCascade, nullptr,       &memobj, 1, 1,
+                           &biquadCascadeBlock, sizeof(BiquadState)};
+  mimium::VoicePool pool(infos, numvoices, numthreads, framesize);
+  std::vector<double> input(framesize);
+  for (int i = 0; i < framesize; i++) { input[i] = (i % 17) / 17.0; }
+  std::vector<double> output(framesize);
+  for (auto _ : state) {
+    pool.process(output.data(), input.data(), framesize);
+    benchmark::DoNotOptimize(output.data());
+  }
+  state.SetItemsProcessed(state.iterations() * framesize * numvoices);
+}
+}  // namespace
+
+BENCHMARK(BM_VoicePool)  // NOLINT
+    ->RangeMultiplier(2)
+    ->Range(1, static_cast<int64_t>(std::max(1U, std::thread::hardware_concurrency())))
+    ->UseRealTime();
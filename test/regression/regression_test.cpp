@@ -1,4 +1,12 @@
-#include <cstdlib>
+#include <atomic>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include "basic/rt_logger.hpp"
+#include "compiler/codegen/llvm_header.hpp"
+#include "frontend/live_reload.hpp"
+#include "libmimium.hpp"
 #include "utils/include_filesystem.hpp"
 
 #include "gtest/gtest.h"
@@ -7,22 +15,151 @@
 // regression test. test files should be put on test/mmm folder.
 // test files must put some answer to stdout through print() function in mimium code.
 // file name of test must be "test_xxxxxx.mmm" and then test name should be xxxxxx.
+// all the files are compiled and run in this process in parallel with a shared jit, at the first
+// time one of the results is checked. each file is tested with the eager jit and the lazy jit.
 
 #ifndef TEST_BIN_DIR
 #define TEST_BIN_DIR ""
 #endif
+
+namespace {
+
+// audio driver without device, which processes as fast as possible until the scheduler stops.
+class HeadlessDriver : public mimium::AudioDriver {
+ public:
+  bool start() override {
+    AudioDriver::start();
+    sch.start(dspfninfos->fn != nullptr);
+    if (getFloatPrecision() == mimium::FloatPrecision::F32) {
+      render<float>();
+    } else {
+      render<double>();
+    }
+    sch.stop();  // notify to exit runtime
+    return true;
+  }
+  bool stop() override { return true; }
+  [[nodiscard]] std::unique_ptr<mimium::AudioDriverParams> getDefaultAudioParameter(
+      std::optional<int> sr, std::optional<int> frames) const override {
+    return std::make_unique<mimium::AudioDriverParams>(mimium::AudioDriverParams{
+        static_cast<double>(sr.value_or(samplerate)), frames.value_or(framesize) * getSampleSize(),
+        frames.value_or(framesize), dspfninfos->in_numchs, dspfninfos->out_numchs});
+  }
+
+ private:
+  static constexpr int samplerate = 48000;
+  static constexpr int framesize = 256;
+  static constexpr int64_t max_frames = samplerate * 10;
+  template <typename T>
+  void render() {
+    std::vector<T> inbuf(static_cast<size_t>(framesize) * params->in_numchs, 0.0);
+    std::vector<T> outbuf(static_cast<size_t>(framesize) * params->out_numchs, 0.0);
+    for (int64_t count = 0; count < max_frames; count += framesize) {
+      if (!process(inbuf.data(), outbuf.data(), framesize)) { return; }
+    }
+  }
+};
+
+// audio driver processed block by block by the test.
+class ManualDriver : public HeadlessDriver {
+ public:
+  bool start() override {
+    AudioDriver::start();
+    sch.start(true);
+    return true;
+  }
+};
+
+// compiles a file as the cli does.
+std::unique_ptr<mimium::ExecutionEngine> compileFile(
+    fs::path const& filepath, std::shared_ptr<llvm::orc::MimiumJIT> const& jit) {
+  mimium::Compiler compiler;
+  compiler.setFilePath(fs::absolute(filepath).string());
+  mimium::Preprocessor preprocessor(fs::current_path());
+  auto ast = compiler.renameSymbols(compiler.loadSource(preprocessor.process(filepath).source));
+  compiler.typeInfer(ast);
+  auto mir = compiler.closureConvert(compiler.generateMir(ast));
+  auto funobjs = compiler.collectMemoryObjs(mir);
+  compiler.generateLLVMIr(mir, funobjs);
+  return std::make_unique<mimium::LLVMJitExecutionEngine>(jit, compiler.moveLLVMCtx(),
+                                                          compiler.moveLLVMModule());
+}
+
+// compiles and runs a file, and returns what is printed by the source.
+std::string runFile(fs::path const& filepath,
+                    std::shared_ptr<llvm::orc::MimiumJIT> const& jit) {
+  std::stringstream output;
+  mimium::RtLogger logger(output);
+  mimium::RtLogger::setThreadStdout(&logger);
+  try {
+    mimium::Runtime runtime(std::make_unique<HeadlessDriver>(), compileFile(filepath, jit));
+    runtime.runMainFun();
+    runtime.start();
+  } catch (std::exception& e) { logger.write(std::string("error: ") + e.what()); }
+  mimium::RtLogger::setThreadStdout(nullptr);
+  logger.flush();
+  return output.str();
+}
+
+class RegressionRunner {
+ public:
+  static RegressionRunner& get() {
+    static RegressionRunner instance;
+    return instance;
+  }
+  bool add(std::string filename) {
+    files.push_back(std::move(filename));
+    return true;
+  }
+  std::string const& getOutput(std::string const& filename, bool lazy) {
+    auto& result = lazy ? lazy_result : eager_result;
+    // lazy jit also compiles on background threads.
+    const mimium::JitCompileOption option{lazy, lazy ? 2U : 0U};
+    std::call_once(result.once, [&]() { runAll(result, option); });
+    return result.outputs.at(filename);
+  }
+
+ private:
+  struct Result {
+    std::unordered_map<std::string, std::string> outputs;
+    std::once_flag once;
+  };
+  std::vector<std::string> files;
+  Result eager_result;
+  Result lazy_result;
+  void runAll(Result& result, mimium::JitCompileOption option) {
+    fs::path testbinpath(TEST_BIN_DIR);
+    fs::current_path(testbinpath);
+    auto jit = mimium::LLVMJitExecutionEngine::createSharedJit(mimium::OptimizeLevel::O2, option);
+    std::vector<std::string> results(files.size());
+    std::atomic<size_t> next = 0;
+    auto worker = [&]() {
+      for (size_t i = next++; i < files.size(); i = next++) {
+        results[i] = runFile(testbinpath / files[i], jit);
+      }
+    };
+    const auto numthreads = std::max(1U, std::thread::hardware_concurrency());
+    std::vector<std::thread> threads;
+    for (unsigned int i = 0; i < numthreads; i++) { threads.emplace_back(worker); }
+    for (auto& t : threads) { t.join(); }
+    for (size_t i = 0; i < files.size(); i++) {
+      result.outputs.emplace(files[i], std::move(results[i]));
+    }
+  }
+};
+
+}  // namespace
+
 // NOLINTNEXTLINE
 #define REGRESSION(filename, expect)                                                          \
+  [[maybe_unused]] const bool registered_##filename =                                         \
+      RegressionRunner::get().add("test_" #filename ".mmm"); /*NOLINT*/                       \
   TEST(regression, filename) { /*NOLINT*/                                                     \
-    testing::internal::CaptureStdout();                                                       \
-    fs::path testbinpath(TEST_BIN_DIR);                                                       \
-    fs::current_path(testbinpath);                                                            \
-    fs::path bin = testbinpath.parent_path() / fs::path("src/mimium");                        \
-    fs::path filepath = testbinpath / fs::path("test_" #filename ".mmm");                     \
-    std::string command =                                                                     \
-        "ASAN_OPTIONS=detect_container_overflow=0 " + bin.string() + " " + filepath.string(); \
-    std::system(command.c_str());                                                             \
-    std::string output = testing::internal::GetCapturedStdout();                              \
+    auto& output = RegressionRunner::get().getOutput("test_" #filename ".mmm", false);        \
+    EXPECT_STREQ(output.c_str(), expect);                                                     \
+  }                                                                                           \
+  TEST(regression_lazy, filename) { /*NOLINT*/                                                \
+    auto& output = RegressionRunner::get().getOutput("test_" #filename ".mmm", true);         \
     EXPECT_STREQ(output.c_str(), expect);                                                     \
   }
 
@@ -79,4 +216,49 @@ REGRESSION(arrayreturn, "100\n200\n300\n400\n500\n")
 REGRESSION(arraylvar, "600\n700\n800\n")
 
 REGRESSION(structtype, "999\n")
-REGRESSION(typealias, "100\n200\n100\n")
\ No newline at end of file
+REGRESSION(typealias, "100\n200\n100\n")
+REGRESSION(now_dsp, "1\n2\n1003\n3\n4\n")
+
+// the task and the dsp of the reloaded source refer the time of the running driver.
+TEST(regression, live_reload) {  // NOLINT
+  const auto path = fs::temp_directory_path() / "mimium_test_live_reload.mmm";
+  auto write = [&](const char* src) { std::ofstream(path) << src; };
+  write(R"(fn dsp(time:float)->(float,float){
+    return (0,0)
+}
+)");
+  auto jit = mimium::LLVMJitExecutionEngine::createSharedJit();
+  mimium::Runtime runtime(std::make_unique<ManualDriver>(), compileFile(path, jit));
+  runtime.runMainFun();
+  auto& driver = runtime.getAudioDriver();
+  constexpr int frames = 256;
+  driver.setup(driver.getDefaultAudioParameter(std::nullopt, frames));
+  driver.start();
+  std::vector<double> inbuf(frames, 0.0);
+  std::vector<double> outbuf(static_cast<size_t>(frames) * 2, 0.0);
+  {
+    mimium::app::LiveReloader reloader(driver, jit, path, mimium::FloatPrecision::F64, nullptr,
+                                       0.0, std::chrono::milliseconds(10));
+    // the task is due long after the source is reloaded, while the driver keeps running.
+    write(R"(start = now
+fired = 0
+fn mark(x){
+    fired = now-start+x
+}
+mark(0)@(start+48000)
+fn dsp(time:float)->(float,float){
+    return (now,fired)
+}
+)");
+    fs::last_write_time(path, fs::last_write_time(path) + std::chrono::seconds(1));
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(30);
+    while (outbuf.back() == 0.0 && std::chrono::steady_clock::now() < deadline) {
+      ASSERT_TRUE(driver.process(inbuf.data(), outbuf.data(), frames));
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+  }
+  fs::remove(path);
+  EXPECT_EQ(outbuf.back(), 48001.0);
+  const auto last = driver.getScheduler().getTime();
+  for (int i = 0; i < frames; i++) { EXPECT_EQ(outbuf[i * 2], static_cast<double>(last - frames + 1 + i)); }
+}